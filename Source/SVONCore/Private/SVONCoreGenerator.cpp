@@ -0,0 +1,262 @@
+#include "SVONCoreGenerator.h"
+
+#include <algorithm>
+
+namespace SVONCore
+{
+	namespace
+	{
+		/* State for one Generate call, the same passes ASVONVolumeActor::Generate makes */
+		class FGenerationPass
+		{
+		public:
+			FGenerationPass(const FSVONGenerationSettings& Settings, const ISVONOccupancy& Occupancy, const FSVONOctree& Octree)
+				: Settings(Settings),
+				Occupancy(Occupancy),
+				Octree(Octree),
+				NumLayers(Octree.GetVoxelPower() + 1) {}
+
+			void Run(FSVONData& OutData)
+			{
+				Data.Reset();
+
+				// Level 0 is Clearance, then any larger radii in ascending order
+				Data.ClearanceRadii.push_back(Settings.Clearance);
+				auto SortedClearances = Settings.AdditionalClearances;
+				std::sort(SortedClearances.begin(), SortedClearances.end());
+				for (const auto Radius : SortedClearances)
+				{
+					if (Radius > Data.ClearanceRadii.back())
+						Data.ClearanceRadii.push_back(Radius);
+				}
+
+				Data.ClearanceLeafNodes.resize(Data.ClearanceRadii.size() - 1);
+				MaxClearance = Data.ClearanceRadii.back();
+
+				FirstPassRasterize();
+
+				Data.Layers.resize(NumLayers);
+				for (auto i = 0; i < NumLayers; i++)
+					RasterizeLayer(static_cast<FLayerIndex>(i));
+
+				for (auto i = 0; i < NumLayers - 1; i++)
+					BuildNeighborLinks(static_cast<FLayerIndex>(i));
+
+				OutData = std::move(Data);
+			}
+
+		private:
+			const FSVONGenerationSettings& Settings;
+			const ISVONOccupancy& Occupancy;
+			const FSVONOctree& Octree;
+			const int32_t NumLayers;
+
+			float MaxClearance = 0.0f;
+			FSVONData Data;
+
+			// Sorted codes of the nodes on each layer that contain blocking, from layer 1 up
+			std::vector<std::vector<FMortonCode>> BlockedCodes;
+
+			void FirstPassRasterize()
+			{
+				BlockedCodes.assign(NumLayers, std::vector<FMortonCode>());
+				if (NumLayers < 2)
+					return;
+
+				const auto& Geometry = Octree.GetLayerGeometry(1);
+				for (auto i = 0; i < Geometry.NodeCount; i++)
+				{
+					FSVONVector Location;
+					Octree.GetNodeLocation(1, i, Location);
+					if (Occupancy.IsBlocked(Location, Geometry.HalfExtent + MaxClearance))
+						BlockedCodes[1].push_back(i);
+				}
+
+				// Every ancestor of a blocked node is blocked too. Codes stay sorted, as parents of sorted codes are
+				for (auto LayerIndex = 2; LayerIndex < NumLayers; LayerIndex++)
+				{
+					for (const auto Code : BlockedCodes[LayerIndex - 1])
+					{
+						if (BlockedCodes[LayerIndex].empty() || BlockedCodes[LayerIndex].back() != Code >> 3)
+							BlockedCodes[LayerIndex].push_back(Code >> 3);
+					}
+				}
+			}
+
+			bool IsBlocked(FLayerIndex LayerIndex, FMortonCode Code) const
+			{
+				const auto& Codes = BlockedCodes[LayerIndex];
+				return std::binary_search(Codes.begin(), Codes.end(), Code);
+			}
+
+			/* Codes of a layer's nodes in ascending order. Blocked nodes are split into all 8 children, the root always exists */
+			void GetLayerCodes(FLayerIndex LayerIndex, std::vector<FMortonCode>& OutCodes) const
+			{
+				OutCodes.clear();
+				if (LayerIndex == NumLayers - 1)
+				{
+					OutCodes.push_back(0);
+					return;
+				}
+
+				for (const auto ParentCode : BlockedCodes[LayerIndex + 1])
+				{
+					for (FMortonCode i = 0; i < 8; i++)
+						OutCodes.push_back((ParentCode << 3) + i);
+				}
+			}
+
+			FNodeIndex FindNodeIndex(FLayerIndex LayerIndex, FMortonCode Code) const
+			{
+				const auto& Layer = Data.Layers[LayerIndex];
+				auto It = std::lower_bound(Layer.begin(), Layer.end(), Code, [](const FSVONNode& Node, FMortonCode Value) { return Node.Code < Value; });
+				if (It == Layer.end() || It->Code != Code)
+					return -1;
+
+				return static_cast<FNodeIndex>(It - Layer.begin());
+			}
+
+			void RasterizeLayer(FLayerIndex LayerIndex)
+			{
+				std::vector<FMortonCode> Codes;
+				GetLayerCodes(LayerIndex, Codes);
+
+				auto& Layer = Data.Layers[LayerIndex];
+				Layer.resize(Codes.size());
+
+				// One bitboard per clearance level, reused for every node
+				std::vector<FSVONLeafNode> Leaves(Data.ClearanceRadii.size());
+
+				for (size_t i = 0; i < Codes.size(); i++)
+				{
+					auto& Node = Layer[i];
+					Node.Code = Codes[i];
+
+					if (LayerIndex > 0)
+					{
+						// Blocked nodes were split, so their first child is the one with the lowest code
+						const auto ChildIndex = FindNodeIndex(LayerIndex - 1, Node.Code << 3);
+						if (ChildIndex < 0)
+							continue;
+
+						Node.FirstChild = FSVONLink(LayerIndex - 1, ChildIndex, 0);
+						for (auto j = 0; j < 8; j++)
+							Data.Layers[LayerIndex - 1][ChildIndex + j].Parent = FSVONLink(LayerIndex, static_cast<uint32_t>(i), 0);
+
+						continue;
+					}
+
+					for (auto& Leaf : Leaves)
+						Leaf.VoxelGrid = 0;
+
+					FSVONVector Location;
+					Octree.GetNodeLocation(0, Node.Code, Location);
+
+					const auto HalfExtent = Octree.GetLayerGeometry(0).HalfExtent;
+					const auto bHasLeaf = Occupancy.IsBlocked(Location, HalfExtent + MaxClearance);
+					if (bHasLeaf)
+						RasterizeLeafNode(Location - FSVONVector(HalfExtent), Leaves);
+
+					if (Settings.bElideUniformLeaves && Leaves[0].IsCompletelyBlocked())
+					{
+						Node.FirstChild = FSVONLink(0, 0, FSVONNode::BlockedLeafFlag);
+					}
+					else if (Settings.bElideUniformLeaves && Leaves.back().IsEmpty())
+					{
+						Node.FirstChild.SetInvalid();
+					}
+					else
+					{
+						const auto LeafIndex = static_cast<uint32_t>(Data.LeafNodes.size());
+						Data.LeafNodes.push_back(Leaves[0]);
+						for (size_t Level = 1; Level < Leaves.size(); Level++)
+							Data.ClearanceLeafNodes[Level - 1].push_back(Leaves[Level]);
+
+						if (bHasLeaf)
+							Node.FirstChild = FSVONLink(0, LeafIndex, 0);
+						else
+							Node.FirstChild.SetInvalid();
+					}
+				}
+			}
+
+			void RasterizeLeafNode(const FSVONVector& Origin, std::vector<FSVONLeafNode>& OutLeaves) const
+			{
+				const auto LeafVoxelSize = Octree.GetVoxelSize(0) * 0.25f;
+
+				for (auto i = 0; i < 64; i++)
+				{
+					uint_fast32_t X, Y, Z;
+					morton3D_64_decode(i, X, Y, Z);
+					const auto Location = Origin + FSVONVector(X * LeafVoxelSize, Y * LeafVoxelSize, Z * LeafVoxelSize) + FSVONVector(LeafVoxelSize * 0.5f);
+
+					// Blocked at one radius means blocked at every larger one, so test from the largest down and stop at the first clear level
+					auto bIsBlocked = true;
+					for (auto Level = static_cast<int32_t>(OutLeaves.size()) - 1; Level > 0 && bIsBlocked; Level--)
+					{
+						bIsBlocked = Occupancy.IsBlocked(Location, LeafVoxelSize * 0.5f + Data.ClearanceRadii[Level]);
+						if (bIsBlocked)
+							OutLeaves[Level].SetNode(static_cast<uint8_t>(i));
+					}
+
+					if (bIsBlocked && Occupancy.IsBlocked(Location, LeafVoxelSize * 0.5f + Settings.Clearance))
+						OutLeaves[0].SetNode(static_cast<uint8_t>(i));
+				}
+			}
+
+			void BuildNeighborLinks(FLayerIndex LayerIndex)
+			{
+				auto& Layer = Data.Layers[LayerIndex];
+				for (auto& Node : Layer)
+				{
+					for (auto Direction = 0; Direction < 6; Direction++)
+						Node.Neighbors[Direction] = FindNeighbor(LayerIndex, Node.Code, Direction);
+				}
+			}
+
+			/* The smallest node beside this one in a direction. Where there's none on our layer, the space is covered by a childless node higher up */
+			FSVONLink FindNeighbor(FLayerIndex LayerIndex, FMortonCode Code, int32_t Direction) const
+			{
+				uint_fast32_t X, Y, Z;
+				morton3D_64_decode(Code, X, Y, Z);
+
+				const auto& Step = FSVONStatics::Directions[Direction];
+				const auto SX = static_cast<int32_t>(X) + Step.X;
+				const auto SY = static_cast<int32_t>(Y) + Step.Y;
+				const auto SZ = static_cast<int32_t>(Z) + Step.Z;
+
+				const auto MaxCoord = Octree.GetLayerGeometry(LayerIndex).NodesPerSide;
+				if (SX < 0 || SX >= MaxCoord || SY < 0 || SY >= MaxCoord || SZ < 0 || SZ >= MaxCoord)
+					return FSVONLink::GetInvalidLink();
+
+				auto NeighborCode = morton3D_64_encode(SX, SY, SZ);
+				for (auto SearchLayer = LayerIndex; SearchLayer < NumLayers; SearchLayer++, NeighborCode >>= 3)
+				{
+					const auto Index = FindNodeIndex(SearchLayer, NeighborCode);
+					if (Index < 0)
+						continue;
+
+					// No point linking to a leaf nothing can enter
+					const auto& Neighbor = Data.Layers[SearchLayer][Index];
+					if (SearchLayer == 0 && Neighbor.HasChildren()
+						&& (Neighbor.IsLeafCompletelyBlocked() || Data.LeafNodes[Neighbor.FirstChild.NodeIndex].IsCompletelyBlocked()))
+						return FSVONLink::GetInvalidLink();
+
+					return FSVONLink(SearchLayer, Index, 0);
+				}
+
+				return FSVONLink::GetInvalidLink();
+			}
+		};
+	}
+
+	void FSVONGenerator::Generate(const FSVONGenerationSettings& Settings, const ISVONOccupancy& Occupancy, FSVONOctree& OutOctree)
+	{
+		OutOctree.Setup(Settings.Origin, Settings.Extent, Settings.VoxelPower);
+
+		FSVONData Data;
+		FGenerationPass(Settings, Occupancy, OutOctree).Run(Data);
+
+		OutOctree.SetData(std::move(Data));
+	}
+}
@@ -0,0 +1,306 @@
+#include "SVONCoreIncrementalPathFinder.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace SVONCore
+{
+	namespace
+	{
+		/* Min-heap on the key */
+		struct FOpenGreater
+		{
+			template <typename TEntry>
+			bool operator()(const TEntry& A, const TEntry& B) const { return B < A; }
+		};
+
+		float GetDistance(const FSVONIntVector& A, const FSVONIntVector& B)
+		{
+			const auto Delta = A - B;
+			return FSVONVector(static_cast<float>(Delta.X), static_cast<float>(Delta.Y), static_cast<float>(Delta.Z)).Size();
+		}
+	}
+
+	FSVONIncrementalPathFinder::FLinkState::FLinkState()
+		: G(FLT_MAX),
+		Rhs(FLT_MAX),
+		Key1(FLT_MAX),
+		Key2(FLT_MAX),
+		bOpen(false) {}
+
+	bool FSVONIncrementalPathFinder::FindPath(const FSVONLink& Start, const FSVONLink& InGoal, FSVONPathResult& OutResult)
+	{
+		OutResult.Links.clear();
+		OutResult.Cost = 0.0f;
+		OutResult.NumExpanded = 0;
+
+		if (!Start.IsValid() || !InGoal.IsValid() || Octree.GetNumLayers() == 0)
+			return false;
+
+		// The agent has usually moved along the last path since, anywhere on it the search from the root still holds
+		bWasRepaired = bHasSearch && (Start == Root || std::find(PathLinks.begin(), PathLinks.end(), Start) != PathLinks.end());
+		if (bWasRepaired)
+		{
+			MoveGoal(InGoal);
+			CompactOpenHeap();
+		}
+		else
+		{
+			StartSearch(Start, InGoal);
+		}
+
+		auto NumSettled = ComputeShortestPath();
+		auto bFound = ExtractPath();
+
+		// The best path from the root may no longer go past the agent, then the search has to start again from where it is
+		auto StartIt = std::find(PathLinks.begin(), PathLinks.end(), Start);
+		if (bFound && StartIt == PathLinks.end())
+		{
+			StartSearch(Start, InGoal);
+			NumSettled += ComputeShortestPath();
+			bFound = ExtractPath();
+			StartIt = PathLinks.begin();
+		}
+
+		OutResult.NumExpanded = NumSettled;
+		if (!bFound)
+			return false;
+
+		OutResult.Links.assign(StartIt, PathLinks.end());
+		OutResult.Cost = States[Goal].G - States[Start].G;
+
+		return true;
+	}
+
+	void FSVONIncrementalPathFinder::Reset()
+	{
+		States.clear();
+		OpenHeap.clear();
+		PathLinks.clear();
+		NumOpen = 0;
+		bHasSearch = false;
+	}
+
+	void FSVONIncrementalPathFinder::StartSearch(const FSVONLink& InStart, const FSVONLink& InGoal)
+	{
+		States.clear();
+		OpenHeap.clear();
+		PathLinks.clear();
+		NumOpen = 0;
+
+		Root = InStart;
+		Goal = InGoal;
+		bHasSearch = true;
+		KeyOffset = 0.0f;
+
+		Octree.GetLinkGridPosition(Goal, GoalPosition);
+		GridUnitSize = Octree.GetVoxelSize(0) * 0.125f;
+
+		const auto NumLayers = std::max(Octree.GetNumLayers(), 1);
+		for (auto i = 0; i < MaxLayers; i++)
+			LayerCostScale[i] = 1.0f - (static_cast<float>(i) / static_cast<float>(NumLayers)) * Settings.NodeSizeCompensation;
+
+		// Steps onto the highest layer are the cheapest per unit of distance with node size compensation
+		HeuristicScale = 0.0f;
+		if (!Settings.bUseUnitCost)
+		{
+			HeuristicScale = LayerCostScale[0];
+			for (auto i = 1; i < std::min(NumLayers, MaxLayers); i++)
+				HeuristicScale = std::min(HeuristicScale, LayerCostScale[i]);
+
+			HeuristicScale = std::max(HeuristicScale, 0.0f);
+		}
+
+		auto& RootState = States[Root];
+		RootState.Rhs = 0.0f;
+		RootState.Parent = Root;
+		UpdateOpen(Root, RootState);
+	}
+
+	void FSVONIncrementalPathFinder::MoveGoal(const FSVONLink& InGoal)
+	{
+		if (InGoal == Goal)
+			return;
+
+		FSVONIntVector NewPosition;
+		Octree.GetLinkGridPosition(InGoal, NewPosition);
+
+		// Heuristics to the new goal are at most this much lower than to the old one, so raising every new key by it keeps the order
+		KeyOffset += GetDistance(NewPosition, GoalPosition) * GridUnitSize * HeuristicScale;
+		Goal = InGoal;
+		GoalPosition = NewPosition;
+	}
+
+	int32_t FSVONIncrementalPathFinder::ComputeShortestPath()
+	{
+		auto NumSettled = 0;
+
+		while (!OpenHeap.empty())
+		{
+			const auto Top = OpenHeap.front();
+			const auto& TopState = States[Top.Link];
+			if (!TopState.bOpen || TopState.Key1 != Top.Key1 || TopState.Key2 != Top.Key2)
+			{
+				std::pop_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+				OpenHeap.pop_back();
+				continue;
+			}
+
+			// Done once nothing open could lead to a cheaper goal
+			const auto GoalIt = States.find(Goal);
+			if (GoalIt != States.end() && GoalIt->second.G < FLT_MAX && GoalIt->second.G == GoalIt->second.Rhs)
+			{
+				FOpenEntry GoalEntry;
+				CalculateKey(Goal, GoalIt->second, GoalEntry.Key1, GoalEntry.Key2);
+				if (!(Top < GoalEntry))
+					break;
+			}
+
+			std::pop_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+			OpenHeap.pop_back();
+
+			// Queued before the goal last moved, its key has gone up since
+			auto& State = States[Top.Link];
+			FOpenEntry Current;
+			CalculateKey(Top.Link, State, Current.Key1, Current.Key2);
+			if (Top < Current)
+			{
+				UpdateOpen(Top.Link, State);
+				continue;
+			}
+
+			// Costs only ever come down, so an open link is always settled at its best cost rather than raised
+			State.G = State.Rhs;
+			UpdateOpen(Top.Link, State);
+			NumSettled++;
+
+			const auto G = State.G;
+			const auto& Link = Top.Link;
+
+			FSVONIntVector Position;
+			Octree.GetLinkGridPosition(Link, Position);
+
+			Neighbors.clear();
+			if (Link.LayerIndex == 0 && Octree.GetNode(Link).HasChildren())
+				Octree.GetLeafNeighbors(Link, Neighbors, Settings.ClearanceLevel);
+			else
+				Octree.GetNeighbors(Link, Neighbors, Settings.ClearanceLevel);
+
+			for (const auto& Neighbor : Neighbors)
+			{
+				if (!Neighbor.IsValid() || Neighbor == Root)
+					continue;
+
+				const auto Cost = GetStepCost(Position, Neighbor);
+				auto& NeighborState = States[Neighbor];
+				if (G + Cost >= NeighborState.Rhs)
+					continue;
+
+				NeighborState.Rhs = G + Cost;
+				NeighborState.Parent = Link;
+				UpdateOpen(Neighbor, NeighborState);
+			}
+		}
+
+		return NumSettled;
+	}
+
+	float FSVONIncrementalPathFinder::GetStepCost(const FSVONIntVector& From, const FSVONLink& To) const
+	{
+		if (Settings.bUseUnitCost)
+			return Settings.UnitCost * LayerCostScale[To.LayerIndex];
+
+		FSVONIntVector ToPosition;
+		Octree.GetLinkGridPosition(To, ToPosition);
+
+		return GetDistance(ToPosition, From) * GridUnitSize * LayerCostScale[To.LayerIndex];
+	}
+
+	float FSVONIncrementalPathFinder::GetHeuristic(const FSVONLink& Link) const
+	{
+		if (HeuristicScale <= 0.0f)
+			return 0.0f;
+
+		FSVONIntVector Position;
+		Octree.GetLinkGridPosition(Link, Position);
+
+		return GetDistance(Position, GoalPosition) * GridUnitSize * HeuristicScale;
+	}
+
+	void FSVONIncrementalPathFinder::CalculateKey(const FSVONLink& Link, const FLinkState& State, float& OutKey1, float& OutKey2) const
+	{
+		const auto Cost = std::min(State.G, State.Rhs);
+		if (Cost == FLT_MAX)
+		{
+			OutKey1 = FLT_MAX;
+			OutKey2 = FLT_MAX;
+			return;
+		}
+
+		OutKey1 = Cost + GetHeuristic(Link) + KeyOffset;
+		OutKey2 = Cost;
+	}
+
+	void FSVONIncrementalPathFinder::UpdateOpen(const FSVONLink& Link, FLinkState& State)
+	{
+		if (State.G == State.Rhs)
+		{
+			if (State.bOpen)
+				NumOpen--;
+
+			State.bOpen = false;
+			return;
+		}
+
+		if (!State.bOpen)
+			NumOpen++;
+
+		State.bOpen = true;
+		CalculateKey(Link, State, State.Key1, State.Key2);
+		OpenHeap.push_back(FOpenEntry{ State.Key1, State.Key2, Link });
+		std::push_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+	}
+
+	void FSVONIncrementalPathFinder::CompactOpenHeap()
+	{
+		// Every requeue leaves its old entry behind, and a long chase requeues a lot
+		if (OpenHeap.size() <= static_cast<size_t>(NumOpen) * 2 + 1024)
+			return;
+
+		OpenHeap.clear();
+		for (const auto& Pair : States)
+		{
+			if (Pair.second.bOpen)
+				OpenHeap.push_back(FOpenEntry{ Pair.second.Key1, Pair.second.Key2, Pair.first });
+		}
+
+		std::make_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+	}
+
+	bool FSVONIncrementalPathFinder::ExtractPath()
+	{
+		PathLinks.clear();
+
+		const auto GoalIt = States.find(Goal);
+		if (GoalIt == States.end() || GoalIt->second.G == FLT_MAX)
+			return false;
+
+		auto Link = Goal;
+		PathLinks.push_back(Link);
+		while (!(Link == Root))
+		{
+			Link = States[Link].Parent;
+			PathLinks.push_back(Link);
+
+			// Parents are always settled links closer to the root, this only guards against zero cost steps
+			if (PathLinks.size() > States.size())
+			{
+				PathLinks.clear();
+				return false;
+			}
+		}
+
+		std::reverse(PathLinks.begin(), PathLinks.end());
+		return true;
+	}
+}
@@ -0,0 +1,272 @@
+#include "SVONCoreOctree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SVONCore
+{
+	void FSVONOctree::Setup(const FSVONVector& InOrigin, float InExtent, int32_t InVoxelPower)
+	{
+		Origin = InOrigin;
+		Extent = InExtent;
+		VoxelPower = std::min(std::max(InVoxelPower, 0), MaxLayers - 1);
+
+		// Layer 0 nodes are 2 * Extent / 2^VoxelPower across, every layer above doubles that
+		const auto BaseVoxelSize = (Extent * 2.0f) / static_cast<float>(1 << VoxelPower);
+
+		for (auto i = 0; i < MaxLayers; i++)
+		{
+			auto& Geometry = LayerGeometry[i];
+			Geometry.VoxelSize = BaseVoxelSize * static_cast<float>(1 << i);
+			Geometry.HalfExtent = Geometry.VoxelSize * 0.5f;
+
+			// Layers above the root have no whole nodes
+			const auto SideShift = VoxelPower - i;
+			Geometry.NodesPerSide = SideShift >= 0 ? 1 << SideShift : 0;
+			Geometry.NodeCount = SideShift >= 0 ? static_cast<int32_t>(std::min<int64_t>(1LL << (SideShift * 3), INT32_MAX)) : 0;
+		}
+	}
+
+	void FSVONOctree::SetData(FSVONData&& InData)
+	{
+		Data = std::move(InData);
+	}
+
+	int32_t FSVONOctree::GetClearanceLevel(float AgentRadius) const
+	{
+		if (Data.ClearanceRadii.empty())
+			return 0;
+
+		for (size_t i = 0; i < Data.ClearanceRadii.size(); i++)
+		{
+			if (AgentRadius <= Data.ClearanceRadii[i])
+				return static_cast<int32_t>(i);
+		}
+
+		return -1;
+	}
+
+	const FSVONNode& FSVONOctree::GetNode(const FSVONLink& Link) const
+	{
+		if (Link.LayerIndex < GetNumLayers())
+			return Data.Layers[Link.LayerIndex][Link.NodeIndex];
+		else
+			return Data.Layers[GetNumLayers() - 1][0];
+	}
+
+	const FSVONLeafNode& FSVONOctree::GetLeafNode(const FSVONNode& Node, uint8_t ClearanceLevel) const
+	{
+		if (Node.IsLeafCompletelyBlocked())
+			return FSVONLeafNode::Blocked;
+
+		if (ClearanceLevel == 0 || ClearanceLevel > Data.ClearanceLeafNodes.size())
+			return Data.LeafNodes[Node.FirstChild.NodeIndex];
+
+		return Data.ClearanceLeafNodes[ClearanceLevel - 1][Node.FirstChild.NodeIndex];
+	}
+
+	void FSVONOctree::GetNodeLocation(FLayerIndex Layer, FMortonCode Code, FSVONVector& OutLocation) const
+	{
+		const auto VoxelSize = GetVoxelSize(Layer);
+		uint_fast32_t X, Y, Z;
+		morton3D_64_decode(Code, X, Y, Z);
+
+		OutLocation = Origin - FSVONVector(Extent) + FSVONVector(X * VoxelSize, Y * VoxelSize, Z * VoxelSize) + FSVONVector(VoxelSize * 0.5f);
+	}
+
+	bool FSVONOctree::GetLinkLocation(const FSVONLink& Link, FSVONVector& OutLocation) const
+	{
+		const auto& Node = GetNode(Link);
+		GetNodeLocation(Link.LayerIndex, Node.Code, OutLocation);
+
+		if (Link.LayerIndex == 0 && Node.HasChildren())
+		{
+			const auto VoxelSize = GetVoxelSize(0);
+			uint_fast32_t X, Y, Z;
+			morton3D_64_decode(Link.SubNodeIndex, X, Y, Z);
+
+			OutLocation = OutLocation + FSVONVector(X * VoxelSize * 0.25f, Y * VoxelSize * 0.25f, Z * VoxelSize * 0.25f) - FSVONVector(VoxelSize * 0.375f);
+			return !GetLeafNode(Node).GetNode(Link.SubNodeIndex);
+		}
+
+		return true;
+	}
+
+	void FSVONOctree::GetLinkGridPosition(const FSVONLink& Link, FSVONIntVector& OutPosition) const
+	{
+		const auto& Node = GetNode(Link);
+
+		uint_fast32_t X, Y, Z;
+		morton3D_64_decode(Node.Code, X, Y, Z);
+
+		// Leaf voxels are one grid unit across, so their centre is the odd half unit
+		if (Link.LayerIndex == 0 && Node.HasChildren())
+		{
+			uint_fast32_t SX, SY, SZ;
+			morton3D_64_decode(Link.SubNodeIndex, SX, SY, SZ);
+
+			OutPosition.X = static_cast<int32_t>((((X << 2) + SX) << 1) + 1);
+			OutPosition.Y = static_cast<int32_t>((((Y << 2) + SY) << 1) + 1);
+			OutPosition.Z = static_cast<int32_t>((((Z << 2) + SZ) << 1) + 1);
+			return;
+		}
+
+		// A node on layer N is 4 << N leaf voxels across, so its centre is (2X + 1) << (N + 2) half units
+		const auto Shift = Link.LayerIndex + 2;
+		OutPosition.X = static_cast<int32_t>(((X << 1) + 1) << Shift);
+		OutPosition.Y = static_cast<int32_t>(((Y << 1) + 1) << Shift);
+		OutPosition.Z = static_cast<int32_t>(((Z << 1) + 1) << Shift);
+	}
+
+	bool FSVONOctree::GetLink(const FSVONVector& Location, FSVONLink& OutLink, uint8_t ClearanceLevel) const
+	{
+		if (GetNumLayers() == 0 || !GetBounds().IsInsideOrOn(Location))
+			return false;
+
+		const auto Local = Location - (Origin - FSVONVector(Extent));
+		auto GetCoord = [](float Value, float VoxelSize, int32_t NodesPerSide)
+		{
+			return static_cast<uint_fast32_t>(std::min(std::max(static_cast<int32_t>(std::floor(Value / VoxelSize)), 0), NodesPerSide - 1));
+		};
+
+		// Children of a node are 8 siblings in morton order, so each step down is an offset from the first child
+		FLayerIndex LayerIndex = static_cast<FLayerIndex>(GetNumLayers() - 1);
+		FNodeIndex NodeIndex = 0;
+		while (true)
+		{
+			const auto& Geometry = GetLayerGeometry(LayerIndex);
+			const auto& Node = Data.Layers[LayerIndex][NodeIndex];
+
+			if (!Node.HasChildren())
+			{
+				OutLink = FSVONLink(LayerIndex, NodeIndex, 0);
+				return true;
+			}
+
+			if (LayerIndex == 0)
+			{
+				const auto LeafVoxelSize = Geometry.VoxelSize * 0.25f;
+				const auto X = GetCoord(Local.X, LeafVoxelSize, Geometry.NodesPerSide * 4) & 3;
+				const auto Y = GetCoord(Local.Y, LeafVoxelSize, Geometry.NodesPerSide * 4) & 3;
+				const auto Z = GetCoord(Local.Z, LeafVoxelSize, Geometry.NodesPerSide * 4) & 3;
+				const auto SubNodeIndex = morton3D_64_encode(X, Y, Z);
+
+				if (GetLeafNode(Node, ClearanceLevel).GetNode(SubNodeIndex))
+					return false;
+
+				OutLink = FSVONLink(0, NodeIndex, static_cast<uint8_t>(SubNodeIndex));
+				return true;
+			}
+
+			const auto& ChildGeometry = GetLayerGeometry(LayerIndex - 1);
+			const auto Code = morton3D_64_encode(
+				GetCoord(Local.X, ChildGeometry.VoxelSize, ChildGeometry.NodesPerSide),
+				GetCoord(Local.Y, ChildGeometry.VoxelSize, ChildGeometry.NodesPerSide),
+				GetCoord(Local.Z, ChildGeometry.VoxelSize, ChildGeometry.NodesPerSide));
+
+			LayerIndex = Node.FirstChild.LayerIndex;
+			NodeIndex = Node.FirstChild.NodeIndex + static_cast<FNodeIndex>(Code & 7);
+		}
+	}
+
+	void FSVONOctree::GetLeafNeighbors(const FSVONLink& Link, std::vector<FSVONLink>& OutNeighbors, uint8_t ClearanceLevel) const
+	{
+		const auto& Node = GetNode(Link);
+		const auto& Leaf = GetLeafNode(Node, ClearanceLevel);
+
+		uint_fast32_t X = 0, Y = 0, Z = 0;
+		morton3D_64_decode(Link.SubNodeIndex, X, Y, Z);
+
+		for (auto i = 0; i < 6; i++)
+		{
+			// Signed, so stepping off the low side of the leaf goes negative rather than wrapping
+			auto SX = static_cast<int32_t>(X) + FSVONStatics::Directions[i].X;
+			auto SY = static_cast<int32_t>(Y) + FSVONStatics::Directions[i].Y;
+			auto SZ = static_cast<int32_t>(Z) + FSVONStatics::Directions[i].Z;
+
+			if (SX >= 0 && SX < 4 && SY >= 0 && SY < 4 && SZ >= 0 && SZ < 4)
+			{
+				const auto Index = morton3D_64_encode(SX, SY, SZ);
+				if (!Leaf.GetNode(Index))
+					OutNeighbors.emplace_back(0, Link.NodeIndex, static_cast<uint8_t>(Index));
+
+				continue;
+			}
+
+			// Nothing on this side, we're at the edge of the volume or next to a fully blocked leaf
+			const auto& NeighborLink = Node.Neighbors[i];
+			if (!NeighborLink.IsValid())
+				continue;
+
+			const auto& NeighborNode = GetNode(NeighborLink);
+			if (!NeighborNode.HasChildren())
+			{
+				OutNeighbors.push_back(NeighborLink);
+				continue;
+			}
+
+			const auto& NeighborLeaf = GetLeafNode(NeighborNode, ClearanceLevel);
+			if (NeighborLeaf.IsCompletelyBlocked())
+				continue;
+
+			// Wrap onto the opposite face of the neighboring leaf
+			const auto SubNodeCode = morton3D_64_encode((SX + 4) & 3, (SY + 4) & 3, (SZ + 4) & 3);
+			if (!NeighborLeaf.GetNode(SubNodeCode))
+				OutNeighbors.emplace_back(0, NeighborLink.NodeIndex, static_cast<uint8_t>(SubNodeCode));
+		}
+	}
+
+	void FSVONOctree::GetNeighbors(const FSVONLink& Link, std::vector<FSVONLink>& OutNeighbors, uint8_t ClearanceLevel) const
+	{
+		const auto& Node = GetNode(Link);
+		std::vector<FSVONLink> WorkingSet;
+
+		for (auto i = 0; i < 6; i++)
+		{
+			const auto& NeighborLink = Node.Neighbors[i];
+			if (!NeighborLink.IsValid())
+				continue;
+
+			// A childless neighbor is empty, we just use it
+			if (!GetNode(NeighborLink).HasChildren())
+			{
+				OutNeighbors.push_back(NeighborLink);
+				continue;
+			}
+
+			// Otherwise walk down to the children on the face touching us
+			WorkingSet.clear();
+			WorkingSet.push_back(NeighborLink);
+
+			while (!WorkingSet.empty())
+			{
+				const auto CurrentLink = WorkingSet.back();
+				WorkingSet.pop_back();
+				const auto& CurrentNode = GetNode(CurrentLink);
+
+				if (CurrentLink.LayerIndex > 0)
+				{
+					for (const auto ChildOffset : FSVONStatics::DirectionalChildOffsets[i])
+					{
+						auto ChildLink = CurrentNode.FirstChild;
+						ChildLink.NodeIndex += ChildOffset;
+
+						if (GetNode(ChildLink).HasChildren())
+							WorkingSet.push_back(ChildLink);
+						else
+							OutNeighbors.push_back(ChildLink);
+					}
+				}
+				else
+				{
+					const auto& Leaf = GetLeafNode(CurrentNode, ClearanceLevel);
+					for (const auto LeafOffset : FSVONStatics::DirectionalLeafChildOffsets[i])
+					{
+						if (!Leaf.GetNode(LeafOffset))
+							OutNeighbors.emplace_back(0, CurrentLink.NodeIndex, static_cast<uint8_t>(LeafOffset));
+					}
+				}
+			}
+		}
+	}
+}
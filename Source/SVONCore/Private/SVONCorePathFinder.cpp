@@ -0,0 +1,135 @@
+#include "SVONCorePathFinder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+
+namespace SVONCore
+{
+	namespace
+	{
+		/* Min-heap on F, ties to the link opened first. A link keeps its order when it's reached more cheaply later */
+		struct FOpenGreater
+		{
+			template <typename TEntry>
+			bool operator()(const TEntry& A, const TEntry& B) const
+			{
+				return A.FScore > B.FScore || (A.FScore == B.FScore && A.OpenOrder > B.OpenOrder);
+			}
+		};
+	}
+
+	void FSVONPathFinder::SetupSearch(const FSVONLink& Goal)
+	{
+		Octree.GetLinkGridPosition(Goal, GoalPosition);
+		GridUnitSize = Octree.GetVoxelSize(0) * 0.125f;
+
+		const auto NumLayers = std::max(static_cast<float>(Octree.GetNumLayers()), 1.0f);
+		for (auto i = 0; i < MaxLayers; i++)
+			LayerCostScale[i] = 1.0f - (static_cast<float>(i) / NumLayers) * Settings.NodeSizeCompensation;
+
+		GoalLayerScale = LayerCostScale[Goal.LayerIndex];
+	}
+
+	float FSVONPathFinder::GetCost(const FSVONIntVector& From, const FSVONIntVector& To, const FSVONLink& Target) const
+	{
+		if (Settings.bUseUnitCost)
+			return Settings.UnitCost * LayerCostScale[Target.LayerIndex];
+
+		const auto Delta = To - From;
+		const auto Distance = FSVONVector(static_cast<float>(Delta.X), static_cast<float>(Delta.Y), static_cast<float>(Delta.Z)).Size();
+		return Distance * GridUnitSize * LayerCostScale[Target.LayerIndex];
+	}
+
+	float FSVONPathFinder::GetHeuristic(const FSVONIntVector& Position) const
+	{
+		const auto Delta = Position - GoalPosition;
+
+		// Compensation is always for the goal's layer
+		if (Settings.Heuristic == ESVONHeuristic::Manhattan)
+			return static_cast<float>(std::abs(Delta.X) + std::abs(Delta.Y) + std::abs(Delta.Z)) * GridUnitSize * GoalLayerScale;
+
+		const auto Distance = FSVONVector(static_cast<float>(Delta.X), static_cast<float>(Delta.Y), static_cast<float>(Delta.Z)).Size();
+		return Distance * GridUnitSize * GoalLayerScale;
+	}
+
+	bool FSVONPathFinder::FindPath(const FSVONLink& Start, const FSVONLink& Goal, FSVONPathResult& OutResult)
+	{
+		OutResult.Links.clear();
+		OutResult.Cost = 0.0f;
+		OutResult.NumExpanded = 0;
+
+		if (!Start.IsValid() || !Goal.IsValid() || Octree.GetNumLayers() == 0)
+			return false;
+
+		SetupSearch(Goal);
+
+		OpenHeap.clear();
+		Records.clear();
+
+		FSVONIntVector Position;
+		Octree.GetLinkGridPosition(Start, Position);
+		Records[Start] = FLinkRecord{ 0.0f, Start, 0, false };
+		OpenHeap.push_back(FOpenEntry{ Settings.WeightEstimate * GetHeuristic(Position), 0, Start });
+
+		uint32_t NumOpened = 1;
+		while (!OpenHeap.empty())
+		{
+			std::pop_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+			const auto Current = OpenHeap.back().Link;
+			OpenHeap.pop_back();
+
+			// Stale entry for a link that was reached more cheaply since
+			auto& CurrentRecord = Records[Current];
+			if (CurrentRecord.bIsClosed)
+				continue;
+
+			CurrentRecord.bIsClosed = true;
+			const auto CurrentScore = CurrentRecord.GScore;
+
+			if (Current == Goal)
+			{
+				OutResult.Cost = CurrentScore;
+				for (auto Link = Goal; ; Link = Records[Link].CameFrom)
+				{
+					OutResult.Links.push_back(Link);
+					if (Link == Start)
+						break;
+				}
+
+				std::reverse(OutResult.Links.begin(), OutResult.Links.end());
+				return true;
+			}
+
+			OutResult.NumExpanded++;
+
+			const auto& CurrentNode = Octree.GetNode(Current);
+			Octree.GetLinkGridPosition(Current, Position);
+
+			Neighbors.clear();
+			if (Current.LayerIndex == 0 && CurrentNode.HasChildren())
+				Octree.GetLeafNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+			else
+				Octree.GetNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+
+			for (const auto& Neighbor : Neighbors)
+			{
+				FSVONIntVector NeighborPosition;
+				Octree.GetLinkGridPosition(Neighbor, NeighborPosition);
+
+				const auto GScore = CurrentScore + GetCost(Position, NeighborPosition, Neighbor);
+
+				auto It = Records.find(Neighbor);
+				if (It != Records.end() && (It->second.bIsClosed || GScore >= It->second.GScore))
+					continue;
+
+				const auto OpenOrder = It != Records.end() ? It->second.OpenOrder : NumOpened++;
+				Records[Neighbor] = FLinkRecord{ GScore, Current, OpenOrder, false };
+				OpenHeap.push_back(FOpenEntry{ GScore + Settings.WeightEstimate * GetHeuristic(NeighborPosition), OpenOrder, Neighbor });
+				std::push_heap(OpenHeap.begin(), OpenHeap.end(), FOpenGreater());
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,189 @@
+#include "SVONCoreSerialization.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SVONCore
+{
+	namespace
+	{
+		// Laid out like FSVONDataBlob's header and section table
+		struct FBlobHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t ByteOrder;
+			uint16_t NodeSize;
+			uint16_t LeafSize;
+			uint32_t NumLayers;
+			uint32_t NumClearanceLevels;
+			uint32_t NumComponents;
+			uint32_t Reserved;
+			uint64_t Size;
+		};
+
+		struct FBlobSection
+		{
+			uint64_t Offset;
+			uint64_t Count;
+		};
+
+		static_assert(sizeof(FBlobHeader) == 40, "The header is laid out like FSVONDataBlob's");
+		static_assert(sizeof(FSVONNode) == 40 && sizeof(FSVONLeafNode) == 8, "Nodes and leaves are laid out like the module's");
+
+		const uint32_t BlobMagic = 0x42564F53;
+		const uint32_t BlobVersion = 2;
+		const uint32_t NativeByteOrder = 0x01020304;
+		const uint64_t Alignment = 16;
+
+		// Sections are radii, area flags, layers, the leaves of each clearance level, then the derived data
+		const size_t RadiiSection = 0;
+		const size_t AreaFlagsSection = 1;
+		const size_t FirstLayerSection = 2;
+		const size_t NumDerivedSections = 4;
+
+		uint64_t Align(uint64_t Value)
+		{
+			return (Value + Alignment - 1) & ~(Alignment - 1);
+		}
+
+		template <typename T>
+		void CopyIn(std::vector<uint8_t>& Bytes, const FBlobSection& Section, const std::vector<T>& Source)
+		{
+			const auto Count = std::min(static_cast<size_t>(Section.Count), Source.size());
+			if (Count > 0)
+				std::memcpy(Bytes.data() + Section.Offset, Source.data(), Count * sizeof(T));
+		}
+
+		template <typename T>
+		void CopyOut(const std::vector<uint8_t>& Bytes, const FBlobSection& Section, std::vector<T>& OutValues)
+		{
+			OutValues.resize(static_cast<size_t>(Section.Count));
+			if (!OutValues.empty())
+				std::memcpy(OutValues.data(), Bytes.data() + Section.Offset, OutValues.size() * sizeof(T));
+		}
+	}
+
+	void FSVONDataWriter::Write(const FSVONData& Data, std::vector<uint8_t>& OutBytes)
+	{
+		const auto NumLayers = Data.Layers.size();
+		const auto NumClearanceLevels = Data.ClearanceLeafNodes.size() + 1;
+		const auto FirstDerivedSection = FirstLayerSection + NumLayers + NumClearanceLevels;
+
+		std::vector<FBlobSection> Sections(FirstDerivedSection + NumDerivedSections);
+
+		auto Offset = Align(sizeof(FBlobHeader) + sizeof(FBlobSection) * Sections.size());
+		auto AddSection = [&](size_t Index, size_t Count, size_t ElementSize)
+		{
+			Sections[Index].Offset = Offset;
+			Sections[Index].Count = Count;
+			Offset = Align(Offset + Count * ElementSize);
+		};
+
+		const auto NumAreaFlags = Data.Layers.empty() ? 0 : Data.Layers[0].size();
+
+		AddSection(RadiiSection, Data.ClearanceRadii.size(), sizeof(float));
+		AddSection(AreaFlagsSection, NumAreaFlags, sizeof(uint8_t));
+
+		for (size_t i = 0; i < NumLayers; i++)
+			AddSection(FirstLayerSection + i, Data.Layers[i].size(), sizeof(FSVONNode));
+
+		for (size_t i = 0; i < NumClearanceLevels; i++)
+			AddSection(FirstLayerSection + NumLayers + i, Data.LeafNodes.size(), sizeof(FSVONLeafNode));
+
+		for (size_t i = 0; i < NumDerivedSections; i++)
+			AddSection(FirstDerivedSection + i, 0, 1);
+
+		// Zeroed like the blob, so padding and area flags come out the same every time
+		OutBytes.assign(static_cast<size_t>(Offset), 0);
+
+		FBlobHeader Header;
+		Header.Magic = BlobMagic;
+		Header.Version = BlobVersion;
+		Header.ByteOrder = NativeByteOrder;
+		Header.NodeSize = sizeof(FSVONNode);
+		Header.LeafSize = sizeof(FSVONLeafNode);
+		Header.NumLayers = static_cast<uint32_t>(NumLayers);
+		Header.NumClearanceLevels = static_cast<uint32_t>(NumClearanceLevels);
+		Header.NumComponents = 0;
+		Header.Reserved = 0;
+		Header.Size = Offset;
+
+		std::memcpy(OutBytes.data(), &Header, sizeof(Header));
+		std::memcpy(OutBytes.data() + sizeof(Header), Sections.data(), sizeof(FBlobSection) * Sections.size());
+
+		CopyIn(OutBytes, Sections[RadiiSection], Data.ClearanceRadii);
+
+		for (size_t i = 0; i < NumLayers; i++)
+			CopyIn(OutBytes, Sections[FirstLayerSection + i], Data.Layers[i]);
+
+		CopyIn(OutBytes, Sections[FirstLayerSection + NumLayers], Data.LeafNodes);
+		for (size_t i = 1; i < NumClearanceLevels; i++)
+			CopyIn(OutBytes, Sections[FirstLayerSection + NumLayers + i], Data.ClearanceLeafNodes[i - 1]);
+	}
+
+	uint64_t FSVONDataWriter::Hash(const std::vector<uint8_t>& Bytes)
+	{
+		auto Result = 0xCBF29CE484222325ULL;
+		for (const auto Byte : Bytes)
+		{
+			Result ^= Byte;
+			Result *= 0x100000001B3ULL;
+		}
+
+		return Result;
+	}
+
+	bool FSVONDataReader::Read(const std::vector<uint8_t>& Bytes, FSVONData& OutData)
+	{
+		OutData.Reset();
+
+		FBlobHeader Header;
+		if (Bytes.size() < sizeof(Header))
+			return false;
+
+		std::memcpy(&Header, Bytes.data(), sizeof(Header));
+		if (Header.Magic != BlobMagic || Header.Version != BlobVersion || Header.ByteOrder != NativeByteOrder
+			|| Header.NodeSize != sizeof(FSVONNode) || Header.LeafSize != sizeof(FSVONLeafNode)
+			|| Header.NumLayers > static_cast<uint32_t>(MaxLayers) || Header.NumClearanceLevels < 1 || Header.NumClearanceLevels > 255
+			|| Header.Size != Bytes.size())
+			return false;
+
+		const auto FirstDerivedSection = FirstLayerSection + Header.NumLayers + Header.NumClearanceLevels;
+		std::vector<FBlobSection> Sections(FirstDerivedSection + NumDerivedSections);
+		if (sizeof(Header) + sizeof(FBlobSection) * Sections.size() > Header.Size)
+			return false;
+
+		std::memcpy(Sections.data(), Bytes.data() + sizeof(Header), sizeof(FBlobSection) * Sections.size());
+
+		// Derived sections are bounds checked as bytes, their element sizes don't matter when they're skipped
+		for (size_t i = 0; i < Sections.size(); i++)
+		{
+			size_t ElementSize = sizeof(FSVONLeafNode);
+			if (i == RadiiSection)
+				ElementSize = sizeof(float);
+			else if (i == AreaFlagsSection || i >= FirstDerivedSection)
+				ElementSize = sizeof(uint8_t);
+			else if (i < FirstLayerSection + Header.NumLayers)
+				ElementSize = sizeof(FSVONNode);
+
+			const auto& Section = Sections[i];
+			if (Section.Offset % Alignment != 0 || Section.Count > Header.Size || Section.Offset + Section.Count * ElementSize > Header.Size)
+				return false;
+		}
+
+		CopyOut(Bytes, Sections[RadiiSection], OutData.ClearanceRadii);
+
+		OutData.Layers.resize(Header.NumLayers);
+		for (size_t i = 0; i < Header.NumLayers; i++)
+			CopyOut(Bytes, Sections[FirstLayerSection + i], OutData.Layers[i]);
+
+		CopyOut(Bytes, Sections[FirstLayerSection + Header.NumLayers], OutData.LeafNodes);
+
+		OutData.ClearanceLeafNodes.resize(Header.NumClearanceLevels - 1);
+		for (size_t i = 1; i < Header.NumClearanceLevels; i++)
+			CopyOut(Bytes, Sections[FirstLayerSection + Header.NumLayers + i], OutData.ClearanceLeafNodes[i - 1]);
+
+		return true;
+	}
+}
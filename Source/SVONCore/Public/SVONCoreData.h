@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include "SVONCoreNode.h"
+
+namespace SVONCore
+{
+	/* The module's FSVONData without area flags, which come from modifier volumes in a world */
+	struct FSVONData
+	{
+		std::vector<std::vector<FSVONNode>> Layers;
+		std::vector<FSVONLeafNode> LeafNodes;
+
+		// Agent radius each clearance level was baked for, smallest first. Level 0 is LeafNodes
+		std::vector<float> ClearanceRadii;
+
+		// Leaf bitboards for levels 1 and up, each parallel to LeafNodes
+		std::vector<std::vector<FSVONLeafNode>> ClearanceLeafNodes;
+
+		void Reset()
+		{
+			Layers.clear();
+			LeafNodes.clear();
+			ClearanceRadii.clear();
+			ClearanceLeafNodes.clear();
+		}
+
+		size_t GetSize() const
+		{
+			size_t Result = LeafNodes.size() * sizeof(FSVONLeafNode);
+			for (const auto& Leaves : ClearanceLeafNodes)
+				Result += Leaves.size() * sizeof(FSVONLeafNode);
+			for (const auto& Layer : Layers)
+				Result += Layer.size() * sizeof(FSVONNode);
+			return Result;
+		}
+	};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "SVONCoreOctree.h"
+
+namespace SVONCore
+{
+	/* What generation asks the world. The module answers with overlap tests against a collision channel */
+	class ISVONOccupancy
+	{
+	public:
+		virtual ~ISVONOccupancy() {}
+
+		/* True if anything blocking overlaps the axis aligned cube */
+		virtual bool IsBlocked(const FSVONVector& Center, float HalfExtent) const = 0;
+	};
+
+	struct FSVONGenerationSettings
+	{
+		FSVONVector Origin;
+		float Extent = 1000.0f;
+		int32_t VoxelPower = 3;
+
+		float Clearance = 0.0f;
+		std::vector<float> AdditionalClearances;
+
+		// Only store leaves that are partly blocked, see ASVONVolumeActor::bElideUniformLeaves
+		bool bElideUniformLeaves = true;
+	};
+
+	class FSVONGenerator
+	{
+	public:
+		/* Rasterizes the occupancy into a new octree, replacing whatever the octree held */
+		static void Generate(const FSVONGenerationSettings& Settings, const ISVONOccupancy& Occupancy, FSVONOctree& OutOctree);
+	};
+}
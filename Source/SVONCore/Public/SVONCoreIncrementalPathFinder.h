@@ -0,0 +1,112 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "SVONCorePathFinder.h"
+
+namespace SVONCore
+{
+	/*
+	 * The module's FSVONIncrementalPathFinder without area filters: Lifelong Planning A* rooted at the start link, with
+	 * D* Lite's key offset so a goal move doesn't mean re-sorting the open list. The octree never changes under it, so
+	 * costs from the root never go up and a repair only settles the links the new goal needs that the old one didn't.
+	 *
+	 * Paths are optimal for the settings' costs, the weight estimate doesn't apply. The search starts over when the start
+	 * is neither the root nor on the last path.
+	 */
+	class FSVONIncrementalPathFinder
+	{
+	public:
+		FSVONIncrementalPathFinder(const FSVONOctree& Octree, const FSVONPathFinderSettings& Settings)
+			: Octree(Octree),
+			Settings(Settings) {}
+
+		/* Links and cost are from the start, NumExpanded is the number of links settled. Reuses the last search when it can */
+		bool FindPath(const FSVONLink& Start, const FSVONLink& Goal, FSVONPathResult& OutResult);
+
+		/* Drops the search, the next query starts from scratch */
+		void Reset();
+
+		/* Whether the last FindPath repaired the search before it rather than starting over */
+		bool WasRepaired() const { return bWasRepaired; }
+
+	private:
+		struct FLinkState
+		{
+			/* Settled cost from the root, and the best cost found so far. The link is open while they differ */
+			float G;
+			float Rhs;
+
+			/* The key the link was last queued with, heap entries that don't match it are stale */
+			float Key1;
+			float Key2;
+			bool bOpen;
+
+			/* Where the best cost came from */
+			FSVONLink Parent;
+
+			FLinkState();
+		};
+
+		struct FOpenEntry
+		{
+			float Key1;
+			float Key2;
+			FSVONLink Link;
+
+			/* Lower key first, ties to the lower cost */
+			bool operator<(const FOpenEntry& Other) const { return Key1 < Other.Key1 || (Key1 == Other.Key1 && Key2 < Other.Key2); }
+		};
+
+		const FSVONOctree& Octree;
+		FSVONPathFinderSettings Settings;
+
+		std::unordered_map<FSVONLink, FLinkState, FSVONLinkHash> States;
+		std::vector<FOpenEntry> OpenHeap;
+		int32_t NumOpen = 0;
+
+		FSVONLink Root;
+		FSVONLink Goal;
+		bool bHasSearch = false;
+		bool bWasRepaired = false;
+
+		FSVONIntVector GoalPosition;
+		float GridUnitSize = 1.0f;
+		float LayerCostScale[MaxLayers];
+
+		/* D* Lite's km, the heuristic distance the goal has moved in total. Keeps older keys lower bounds of new ones */
+		float KeyOffset = 0.0f;
+
+		/* Scales the heuristic so no step costs less than it estimates, whatever layer it's onto */
+		float HeuristicScale = 0.0f;
+
+		/* The last path found, root first */
+		std::vector<FSVONLink> PathLinks;
+
+		std::vector<FSVONLink> Neighbors;
+
+		/* Roots the search at the start, with nothing settled */
+		void StartSearch(const FSVONLink& InStart, const FSVONLink& InGoal);
+
+		/* Moves the goal, adding how far it went to the key offset */
+		void MoveGoal(const FSVONLink& InGoal);
+
+		/* Settles links in key order until the goal's cost is known, or nothing's left open. Returns the number settled */
+		int32_t ComputeShortestPath();
+
+		float GetStepCost(const FSVONIntVector& From, const FSVONLink& To) const;
+		float GetHeuristic(const FSVONLink& Link) const;
+
+		void CalculateKey(const FSVONLink& Link, const FLinkState& State, float& OutKey1, float& OutKey2) const;
+
+		/* Queues the link with its current key if it's inconsistent, otherwise takes it off the open list */
+		void UpdateOpen(const FSVONLink& Link, FLinkState& State);
+
+		/* Drops stale entries once they outnumber the live ones */
+		void CompactOpenHeap();
+
+		/* Follows parents back from the goal into PathLinks. False if the goal isn't settled */
+		bool ExtractPath();
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "SVONCoreTypes.h"
+
+namespace SVONCore
+{
+	/* Declared like the module's FSVONLink, packed the same way */
+	struct FSVONLink
+	{
+	private:
+		typedef uint8_t FLinkLayerIndex;
+		typedef uint32_t FLinkNodeIndex;
+		typedef uint8_t FLinkSubNodeIndex;
+
+		static const FLinkLayerIndex InvalidLayerIndex = 15;
+
+	public:
+		FLinkLayerIndex LayerIndex:4;
+		FLinkNodeIndex NodeIndex:22;
+		FLinkSubNodeIndex SubNodeIndex:6;
+
+		FSVONLink()
+			: LayerIndex(InvalidLayerIndex),
+			NodeIndex(0),
+			SubNodeIndex(0) {}
+
+		FSVONLink(FLinkLayerIndex Layer, FLinkNodeIndex NodeIndex, FLinkSubNodeIndex SubNodeIndex)
+			: LayerIndex(Layer),
+			NodeIndex(NodeIndex),
+			SubNodeIndex(SubNodeIndex) {}
+
+		bool IsValid() const { return LayerIndex != InvalidLayerIndex; }
+		void SetInvalid() { LayerIndex = InvalidLayerIndex; }
+
+		/* All three fields in one word, for hashing and ordering */
+		uint32_t GetPacked() const { return LayerIndex | (static_cast<uint32_t>(NodeIndex) << 4) | (static_cast<uint32_t>(SubNodeIndex) << 26); }
+
+		bool operator==(const FSVONLink& Other) const { return GetPacked() == Other.GetPacked(); }
+		bool operator!=(const FSVONLink& Other) const { return GetPacked() != Other.GetPacked(); }
+
+		static FSVONLink GetInvalidLink() { return FSVONLink(InvalidLayerIndex, 0, 0); }
+	};
+
+	struct FSVONLinkHash
+	{
+		size_t operator()(const FSVONLink& Link) const { return Link.GetPacked(); }
+	};
+
+	struct FSVONNode
+	{
+		FMortonCode Code = 0;
+
+		FSVONLink Parent;
+		FSVONLink FirstChild;
+
+		FSVONLink Neighbors[6];
+
+		/* Set in FirstChild's sub node bits when every voxel of the leaf is blocked. No leaf is stored for it */
+		static const uint8_t BlockedLeafFlag = 1;
+
+		bool HasChildren() const { return FirstChild.IsValid(); }
+		bool IsLeafCompletelyBlocked() const { return FirstChild.IsValid() && (FirstChild.SubNodeIndex & BlockedLeafFlag) != 0; }
+	};
+
+	/* 4x4x4 voxels of a layer 0 node, one bit each in morton order */
+	struct FSVONLeafNode
+	{
+		uint_fast64_t VoxelGrid = 0;
+
+		/* Stands in for every leaf whose node is flagged as completely blocked */
+		static const FSVONLeafNode Blocked;
+
+		void SetNode(uint8_t Index) { VoxelGrid |= 1ULL << Index; }
+		bool GetNode(FMortonCode Index) const { return (VoxelGrid & (1ULL << Index)) != 0; }
+
+		bool IsCompletelyBlocked() const { return VoxelGrid == ~0ULL; }
+		bool IsEmpty() const { return VoxelGrid == 0; }
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "SVONCoreData.h"
+
+namespace SVONCore
+{
+	/* A generated octree and the cube it covers. The read side of ASVONVolumeActor */
+	class FSVONOctree
+	{
+	public:
+		/* Origin is the centre of the cube, Extent half its edge length */
+		void Setup(const FSVONVector& InOrigin, float InExtent, int32_t InVoxelPower);
+
+		void SetData(FSVONData&& InData);
+		const FSVONData& GetData() const { return Data; }
+
+		const FSVONVector& GetOrigin() const { return Origin; }
+		float GetExtent() const { return Extent; }
+		int32_t GetVoxelPower() const { return VoxelPower; }
+		FSVONBox GetBounds() const { return FSVONBox(Origin - FSVONVector(Extent), Origin + FSVONVector(Extent)); }
+
+		int32_t GetNumLayers() const { return static_cast<int32_t>(Data.Layers.size()); }
+		const std::vector<FSVONNode>& GetLayer(FLayerIndex Layer) const { return Data.Layers[Layer]; }
+		const FSVONLayerGeometry& GetLayerGeometry(FLayerIndex Layer) const { return LayerGeometry[Layer]; }
+		float GetVoxelSize(FLayerIndex Layer) const { return LayerGeometry[Layer].VoxelSize; }
+
+		int32_t GetNumClearanceLevels() const { return Data.ClearanceRadii.empty() ? 1 : static_cast<int32_t>(Data.ClearanceRadii.size()); }
+
+		/* Smallest level baked for at least this radius, -1 if the agent is bigger than all of them. Data without radii has
+		   the one level, which every agent gets */
+		int32_t GetClearanceLevel(float AgentRadius) const;
+
+		const FSVONNode& GetNode(const FSVONLink& Link) const;
+
+		/* The leaf of a layer 0 node with children */
+		const FSVONLeafNode& GetLeafNode(const FSVONNode& Node, uint8_t ClearanceLevel = 0) const;
+
+		void GetNodeLocation(FLayerIndex Layer, FMortonCode Code, FSVONVector& OutLocation) const;
+
+		/* Centre of a link. False if it's a blocked leaf voxel */
+		bool GetLinkLocation(const FSVONLink& Link, FSVONVector& OutLocation) const;
+
+		/* Centre of a link in half leaf voxel units from the morton origin */
+		void GetLinkGridPosition(const FSVONLink& Link, FSVONIntVector& OutPosition) const;
+
+		/* The free node or leaf voxel containing the location, false if it's blocked or outside */
+		bool GetLink(const FSVONVector& Location, FSVONLink& OutLink, uint8_t ClearanceLevel = 0) const;
+
+		void GetLeafNeighbors(const FSVONLink& Link, std::vector<FSVONLink>& OutNeighbors, uint8_t ClearanceLevel = 0) const;
+		void GetNeighbors(const FSVONLink& Link, std::vector<FSVONLink>& OutNeighbors, uint8_t ClearanceLevel = 0) const;
+
+	private:
+		FSVONData Data;
+
+		FSVONVector Origin;
+		float Extent = 0.0f;
+		int32_t VoxelPower = 0;
+
+		FSVONLayerGeometry LayerGeometry[MaxLayers];
+	};
+}
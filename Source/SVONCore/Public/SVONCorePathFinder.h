@@ -0,0 +1,82 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "SVONCoreOctree.h"
+
+namespace SVONCore
+{
+	enum class ESVONHeuristic : uint8_t
+	{
+		Euclidean,
+		Manhattan
+	};
+
+	struct FSVONPathFinderSettings
+	{
+		float WeightEstimate = 1.0f;
+		float NodeSizeCompensation = 1.0f;
+		bool bUseUnitCost = false;
+		float UnitCost = 1.0f;
+		ESVONHeuristic Heuristic = ESVONHeuristic::Euclidean;
+		uint8_t ClearanceLevel = 0;
+	};
+
+	struct FSVONPathResult
+	{
+		/* Start first, goal last */
+		std::vector<FSVONLink> Links;
+		float Cost = 0.0f;
+		int32_t NumExpanded = 0;
+	};
+
+	/*
+	 * A* over the octree with the module's costs, the distance or unit cost scaled by node size compensation. Lowest F is
+	 * expanded first, ties to the link that was opened first, the order FSVONPathFinder::PopLowestScore's scan picks in
+	 */
+	class FSVONPathFinder
+	{
+	public:
+		FSVONPathFinder(const FSVONOctree& Octree, const FSVONPathFinderSettings& Settings)
+			: Octree(Octree),
+			Settings(Settings) {}
+
+		/* False if the goal can't be reached, OutResult still reports how much was expanded */
+		bool FindPath(const FSVONLink& Start, const FSVONLink& Goal, FSVONPathResult& OutResult);
+
+	private:
+		struct FOpenEntry
+		{
+			float FScore;
+			uint32_t OpenOrder;
+			FSVONLink Link;
+		};
+
+		struct FLinkRecord
+		{
+			float GScore;
+			FSVONLink CameFrom;
+			uint32_t OpenOrder;
+			bool bIsClosed;
+		};
+
+		const FSVONOctree& Octree;
+		FSVONPathFinderSettings Settings;
+
+		FSVONIntVector GoalPosition;
+		float GridUnitSize = 1.0f;
+		float LayerCostScale[MaxLayers];
+		float GoalLayerScale = 1.0f;
+
+		/* Scratch kept between searches to avoid reallocating */
+		std::vector<FOpenEntry> OpenHeap;
+		std::unordered_map<FSVONLink, FLinkRecord, FSVONLinkHash> Records;
+		std::vector<FSVONLink> Neighbors;
+
+		void SetupSearch(const FSVONLink& Goal);
+
+		float GetCost(const FSVONIntVector& From, const FSVONIntVector& To, const FSVONLink& Target) const;
+		float GetHeuristic(const FSVONIntVector& Position) const;
+	};
+}
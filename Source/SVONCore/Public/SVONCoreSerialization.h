@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include "SVONCoreData.h"
+
+namespace SVONCore
+{
+	/*
+	 * Writes octree data laid out like the module's FSVONDataBlob: a header and section table, then every array at an
+	 * aligned offset with zeroed padding. Nodes and leaves are in memory layout and host byte order. Area flags are zeros,
+	 * one per layer 0 node, and the derived data sections are empty. The layout is copied by hand, nothing checks it
+	 * against the module's, so the bytes are only known to be the core's.
+	 */
+	class FSVONDataWriter
+	{
+	public:
+		static void Write(const FSVONData& Data, std::vector<uint8_t>& OutBytes);
+
+		/* FNV-1a, for comparing builds without keeping their bytes around */
+		static uint64_t Hash(const std::vector<uint8_t>& Bytes);
+	};
+
+	/* Reads what FSVONDataWriter writes. Area flags and derived data are skipped, the core has neither */
+	class FSVONDataReader
+	{
+	public:
+		/* False, and OutData reset, if the bytes aren't a whole blob of this version and layout */
+		static bool Read(const std::vector<uint8_t>& Bytes, FSVONData& OutData);
+	};
+}
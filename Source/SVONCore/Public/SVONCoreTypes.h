@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "libmorton/morton.h"
+
+/*
+ * Engine independent model of the SVON octree, on plain C++ and the standard library, so generation and searches can run
+ * headless in tools and benchmarks. It follows the UESVON module's layout and algorithms, but the module doesn't use it,
+ * so changes to either have to be carried over to the other by hand.
+ */
+namespace SVONCore
+{
+	typedef uint8_t FLayerIndex;
+	typedef int32_t FNodeIndex;
+	typedef uint8_t FSubNodeIndex;
+	typedef uint_fast64_t FMortonCode;
+
+	static const int32_t MaxLayers = 16;
+
+	struct FSVONVector
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+		float Z = 0.0f;
+
+		FSVONVector() {}
+
+		explicit FSVONVector(float Value)
+			: X(Value),
+			Y(Value),
+			Z(Value) {}
+
+		FSVONVector(float X, float Y, float Z)
+			: X(X),
+			Y(Y),
+			Z(Z) {}
+
+		FSVONVector operator+(const FSVONVector& Other) const { return FSVONVector(X + Other.X, Y + Other.Y, Z + Other.Z); }
+		FSVONVector operator-(const FSVONVector& Other) const { return FSVONVector(X - Other.X, Y - Other.Y, Z - Other.Z); }
+		FSVONVector operator*(float Scale) const { return FSVONVector(X * Scale, Y * Scale, Z * Scale); }
+
+		float SizeSquared() const { return X * X + Y * Y + Z * Z; }
+		float Size() const { return std::sqrt(SizeSquared()); }
+	};
+
+	struct FSVONIntVector
+	{
+		int32_t X = 0;
+		int32_t Y = 0;
+		int32_t Z = 0;
+
+		FSVONIntVector() {}
+
+		FSVONIntVector(int32_t X, int32_t Y, int32_t Z)
+			: X(X),
+			Y(Y),
+			Z(Z) {}
+
+		FSVONIntVector operator-(const FSVONIntVector& Other) const { return FSVONIntVector(X - Other.X, Y - Other.Y, Z - Other.Z); }
+		bool operator==(const FSVONIntVector& Other) const { return X == Other.X && Y == Other.Y && Z == Other.Z; }
+	};
+
+	struct FSVONBox
+	{
+		FSVONVector Min;
+		FSVONVector Max;
+
+		FSVONBox() {}
+
+		FSVONBox(const FSVONVector& Min, const FSVONVector& Max)
+			: Min(Min),
+			Max(Max) {}
+
+		bool IsInsideOrOn(const FSVONVector& Location) const
+		{
+			return Location.X >= Min.X && Location.X <= Max.X
+				&& Location.Y >= Min.Y && Location.Y <= Max.Y
+				&& Location.Z >= Min.Z && Location.Z <= Max.Z;
+		}
+	};
+
+	/* Sizes and counts for one layer, so hot paths don't need to recompute powers of two */
+	struct FSVONLayerGeometry
+	{
+		float VoxelSize = 0.0f;
+		float HalfExtent = 0.0f;
+		int32_t NodesPerSide = 0;
+		int32_t NodeCount = 0;
+	};
+
+	struct FSVONStatics
+	{
+		static const FSVONIntVector Directions[6];
+		static const FNodeIndex DirectionalChildOffsets[6][4];
+		static const FNodeIndex DirectionalLeafChildOffsets[6][16];
+	};
+}
@@ -0,0 +1,382 @@
+// Unit tests for the core, one per ctest entry.
+//
+//	SVONCoreTests <test name>
+//
+// Each builds a small seeded world and checks one property across every link, or a few hundred queries, in it.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "SVONCoreGenerator.h"
+#include "SVONCoreIncrementalPathFinder.h"
+#include "SVONCorePathFinder.h"
+#include "SVONCoreSerialization.h"
+
+using namespace SVONCore;
+
+namespace
+{
+	const float WorldExtent = 1000.0f;
+
+	/* Seeded spheres, enough to give a mix of open, partly blocked and fully blocked nodes on every layer */
+	class FTestOccupancy : public ISVONOccupancy
+	{
+	public:
+		explicit FTestOccupancy(uint32_t Seed)
+		{
+			uint64_t State = Seed;
+			auto Next = [&State]()
+			{
+				State = State * 6364136223846793005ULL + 1442695040888963407ULL;
+				return static_cast<float>(State >> 40) / static_cast<float>(1ULL << 24);
+			};
+
+			for (auto i = 0; i < 24; i++)
+			{
+				FSphere Sphere;
+				Sphere.Center = FSVONVector(Next() * 2.0f - 1.0f, Next() * 2.0f - 1.0f, Next() * 2.0f - 1.0f) * WorldExtent;
+				Sphere.Radius = WorldExtent * (0.03f + Next() * 0.15f);
+				Spheres.push_back(Sphere);
+			}
+		}
+
+		virtual bool IsBlocked(const FSVONVector& Center, float HalfExtent) const override
+		{
+			for (const auto& Sphere : Spheres)
+			{
+				// Closest point of the cube to the sphere centre
+				auto Clamp = [HalfExtent](float Value, float BoxCenter) { return std::min(std::max(Value, BoxCenter - HalfExtent), BoxCenter + HalfExtent); };
+				const FSVONVector Closest(Clamp(Sphere.Center.X, Center.X), Clamp(Sphere.Center.Y, Center.Y), Clamp(Sphere.Center.Z, Center.Z));
+				if ((Closest - Sphere.Center).SizeSquared() <= Sphere.Radius * Sphere.Radius)
+					return true;
+			}
+
+			return false;
+		}
+
+	private:
+		struct FSphere
+		{
+			FSVONVector Center;
+			float Radius;
+		};
+
+		std::vector<FSphere> Spheres;
+	};
+
+	void Generate(bool bElideUniformLeaves, FSVONOctree& OutOctree)
+	{
+		FSVONGenerationSettings Settings;
+		Settings.Extent = WorldExtent;
+		Settings.VoxelPower = 4;
+		Settings.bElideUniformLeaves = bElideUniformLeaves;
+		Settings.AdditionalClearances.push_back(WorldExtent * 0.02f);
+
+		FSVONGenerator::Generate(Settings, FTestOccupancy(7), OutOctree);
+	}
+
+	/* Every link a search can stand on: childless nodes on any layer, and the free voxels of layer 0 leaves */
+	void GetFreeLinks(const FSVONOctree& Octree, std::vector<FSVONLink>& OutLinks)
+	{
+		for (auto LayerIndex = 0; LayerIndex < Octree.GetNumLayers(); LayerIndex++)
+		{
+			const auto& Layer = Octree.GetLayer(static_cast<FLayerIndex>(LayerIndex));
+			for (size_t i = 0; i < Layer.size(); i++)
+			{
+				const auto& Node = Layer[i];
+				if (!Node.HasChildren())
+				{
+					OutLinks.emplace_back(LayerIndex, static_cast<uint32_t>(i), 0);
+					continue;
+				}
+
+				if (LayerIndex > 0)
+					continue;
+
+				const auto& Leaf = Octree.GetLeafNode(Node);
+				for (uint8_t Voxel = 0; Voxel < 64; Voxel++)
+				{
+					if (!Leaf.GetNode(Voxel))
+						OutLinks.emplace_back(0, static_cast<uint32_t>(i), Voxel);
+				}
+			}
+		}
+	}
+
+	void GetNeighbors(const FSVONOctree& Octree, const FSVONLink& Link, std::vector<FSVONLink>& OutNeighbors)
+	{
+		OutNeighbors.clear();
+		if (Link.LayerIndex == 0 && Octree.GetNode(Link).HasChildren())
+			Octree.GetLeafNeighbors(Link, OutNeighbors);
+		else
+			Octree.GetNeighbors(Link, OutNeighbors);
+	}
+
+	bool TestNeighborSymmetry(bool bElideUniformLeaves)
+	{
+		FSVONOctree Octree;
+		Generate(bElideUniformLeaves, Octree);
+
+		std::vector<FSVONLink> Links;
+		GetFreeLinks(Octree, Links);
+
+		std::vector<FSVONLink> Neighbors, Back;
+		auto NumErrors = 0;
+		for (const auto& Link : Links)
+		{
+			GetNeighbors(Octree, Link, Neighbors);
+			for (const auto& Neighbor : Neighbors)
+			{
+				GetNeighbors(Octree, Neighbor, Back);
+				if (std::find(Back.begin(), Back.end(), Link) != Back.end())
+					continue;
+
+				if (NumErrors++ < 10)
+					std::printf("%08x is a neighbor of %08x, but not the other way\n", Neighbor.GetPacked(), Link.GetPacked());
+			}
+		}
+
+		std::printf("%d links, %d one way neighbors\n", static_cast<int32_t>(Links.size()), NumErrors);
+		return !Links.empty() && NumErrors == 0;
+	}
+
+	/* Without node size compensation the Euclidean heuristic never overestimates, so A* has to find the cheapest path */
+	bool TestAStarMatchesDijkstra()
+	{
+		FSVONOctree Octree;
+		Generate(true, Octree);
+
+		std::vector<FSVONLink> Links;
+		GetFreeLinks(Octree, Links);
+		if (Links.empty())
+			return false;
+
+		FSVONPathFinderSettings AStarSettings;
+		AStarSettings.NodeSizeCompensation = 0.0f;
+
+		auto DijkstraSettings = AStarSettings;
+		DijkstraSettings.WeightEstimate = 0.0f;
+
+		FSVONPathFinder AStar(Octree, AStarSettings);
+		FSVONPathFinder Dijkstra(Octree, DijkstraSettings);
+
+		auto NumFound = 0;
+		auto NumErrors = 0;
+		for (size_t i = 0; i < 200; i++)
+		{
+			const auto& Start = Links[(i * 7919) % Links.size()];
+			const auto& Goal = Links[(i * 104729 + 17) % Links.size()];
+
+			FSVONPathResult AStarPath, DijkstraPath;
+			const auto bAStarFound = AStar.FindPath(Start, Goal, AStarPath);
+			const auto bDijkstraFound = Dijkstra.FindPath(Start, Goal, DijkstraPath);
+			NumFound += bAStarFound ? 1 : 0;
+
+			// Summed in a different order, so only close
+			if (bAStarFound == bDijkstraFound && std::abs(AStarPath.Cost - DijkstraPath.Cost) <= 1e-4f * std::max(1.0f, DijkstraPath.Cost))
+				continue;
+
+			NumErrors++;
+			std::printf("%08x to %08x: A* %s %g, Dijkstra %s %g\n", Start.GetPacked(), Goal.GetPacked(),
+				bAStarFound ? "found" : "failed", AStarPath.Cost, bDijkstraFound ? "found" : "failed", DijkstraPath.Cost);
+		}
+
+		std::printf("%d paths found, %d differ\n", NumFound, NumErrors);
+		return NumFound > 0 && NumErrors == 0;
+	}
+
+	/*
+	 * Chases a goal that wanders off one neighbor at a time or jumps, with the start now and then moving one link along the last
+	 * path, the way a move task with goal tracking repaths. Every repaired path has to cost what a fresh Dijkstra finds
+	 */
+	bool TestIncrementalMatchesDijkstra(float NodeSizeCompensation)
+	{
+		FSVONOctree Octree;
+		Generate(true, Octree);
+
+		std::vector<FSVONLink> Links;
+		GetFreeLinks(Octree, Links);
+		if (Links.empty())
+			return false;
+
+		FSVONPathFinderSettings Settings;
+		Settings.NodeSizeCompensation = NodeSizeCompensation;
+
+		auto DijkstraSettings = Settings;
+		DijkstraSettings.WeightEstimate = 0.0f;
+
+		FSVONIncrementalPathFinder Incremental(Octree, Settings);
+		FSVONPathFinder Dijkstra(Octree, DijkstraSettings);
+
+		std::vector<FSVONLink> Neighbors;
+		auto NumQueries = 0;
+		auto NumRepairs = 0;
+		auto NumErrors = 0;
+		int64_t NumSettled = 0;
+		int64_t NumExpanded = 0;
+		for (size_t Chase = 0; Chase < 24; Chase++)
+		{
+			auto Start = Links[(Chase * 7919) % Links.size()];
+			auto Goal = Links[(Chase * 104729 + 17) % Links.size()];
+			Incremental.Reset();
+
+			for (size_t Step = 0; Step < 20; Step++)
+			{
+				FSVONPathResult IncrementalPath, DijkstraPath;
+				const auto bIncrementalFound = Incremental.FindPath(Start, Goal, IncrementalPath);
+				const auto bDijkstraFound = Dijkstra.FindPath(Start, Goal, DijkstraPath);
+
+				NumQueries++;
+				NumRepairs += Incremental.WasRepaired() ? 1 : 0;
+				NumSettled += IncrementalPath.NumExpanded;
+				NumExpanded += DijkstraPath.NumExpanded;
+
+				// Costs from the root are subtracted for a start further along the path, so only close
+				const auto bEndsMatch = !bIncrementalFound || (IncrementalPath.Links.front() == Start && IncrementalPath.Links.back() == Goal);
+				if (bIncrementalFound != bDijkstraFound || !bEndsMatch || std::abs(IncrementalPath.Cost - DijkstraPath.Cost) > 1e-4f * std::max(1.0f, DijkstraPath.Cost))
+				{
+					if (NumErrors++ < 10)
+					{
+						std::printf("%08x to %08x: incremental %s %g, Dijkstra %s %g\n", Start.GetPacked(), Goal.GetPacked(),
+							bIncrementalFound ? "found" : "failed", IncrementalPath.Cost, bDijkstraFound ? "found" : "failed", DijkstraPath.Cost);
+					}
+				}
+
+				if (Step % 3 == 2 && IncrementalPath.Links.size() > 1)
+					Start = IncrementalPath.Links[1];
+
+				// Now and then the goal jumps well away, which is what the key offset is for
+				GetNeighbors(Octree, Goal, Neighbors);
+				if (Step % 4 == 3)
+					Goal = Links[(Chase * 31 + Step * 6151) % Links.size()];
+				else if (!Neighbors.empty())
+					Goal = Neighbors[(Chase + Step * 31) % Neighbors.size()];
+			}
+		}
+
+		std::printf("%d queries, %d repaired, %d differ, %lld links settled against %lld expanded by Dijkstra\n", NumQueries, NumRepairs, NumErrors,
+			static_cast<long long>(NumSettled), static_cast<long long>(NumExpanded));
+		return NumRepairs > 0 && NumErrors == 0;
+	}
+
+	bool AreEqual(const FSVONNode& A, const FSVONNode& B)
+	{
+		if (A.Code != B.Code || A.Parent != B.Parent || A.FirstChild != B.FirstChild)
+			return false;
+
+		for (auto i = 0; i < 6; i++)
+		{
+			if (A.Neighbors[i] != B.Neighbors[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	bool AreEqual(const std::vector<FSVONLeafNode>& A, const std::vector<FSVONLeafNode>& B)
+	{
+		return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin(), [](const FSVONLeafNode& X, const FSVONLeafNode& Y) { return X.VoxelGrid == Y.VoxelGrid; });
+	}
+
+	bool TestSerializationRoundTrip(bool bElideUniformLeaves)
+	{
+		FSVONOctree Octree;
+		Generate(bElideUniformLeaves, Octree);
+		const auto& Data = Octree.GetData();
+
+		std::vector<uint8_t> Bytes;
+		FSVONDataWriter::Write(Data, Bytes);
+
+		FSVONData ReadBack;
+		if (!FSVONDataReader::Read(Bytes, ReadBack))
+		{
+			std::printf("Couldn't read back %d bytes\n", static_cast<int32_t>(Bytes.size()));
+			return false;
+		}
+
+		auto bIsEqual = Data.Layers.size() == ReadBack.Layers.size()
+			&& AreEqual(Data.LeafNodes, ReadBack.LeafNodes)
+			&& Data.ClearanceRadii == ReadBack.ClearanceRadii
+			&& Data.ClearanceLeafNodes.size() == ReadBack.ClearanceLeafNodes.size();
+
+		for (size_t i = 0; bIsEqual && i < Data.Layers.size(); i++)
+		{
+			bIsEqual = Data.Layers[i].size() == ReadBack.Layers[i].size()
+				&& std::equal(Data.Layers[i].begin(), Data.Layers[i].end(), ReadBack.Layers[i].begin(), [](const FSVONNode& A, const FSVONNode& B) { return AreEqual(A, B); });
+		}
+
+		for (size_t i = 0; bIsEqual && i < Data.ClearanceLeafNodes.size(); i++)
+			bIsEqual = AreEqual(Data.ClearanceLeafNodes[i], ReadBack.ClearanceLeafNodes[i]);
+
+		if (!bIsEqual)
+		{
+			std::printf("Data read back differs from what was written\n");
+			return false;
+		}
+
+		// And written again, byte for byte the same
+		std::vector<uint8_t> Rewritten;
+		FSVONDataWriter::Write(ReadBack, Rewritten);
+		if (Rewritten != Bytes)
+		{
+			std::printf("Rewritten data differs, %d bytes, first written %d\n", static_cast<int32_t>(Rewritten.size()), static_cast<int32_t>(Bytes.size()));
+			return false;
+		}
+
+		// Anything cut short has to fail rather than read garbage
+		Bytes.pop_back();
+		if (FSVONDataReader::Read(Bytes, ReadBack))
+		{
+			std::printf("Truncated data was read\n");
+			return false;
+		}
+
+		std::printf("%d bytes round tripped\n", static_cast<int32_t>(Rewritten.size()));
+		return true;
+	}
+
+	struct FTest
+	{
+		const char* Name;
+		bool (*Run)();
+	};
+
+	const FTest Tests[] = {
+		{ "NeighborSymmetryElided", []() { return TestNeighborSymmetry(true); } },
+		{ "NeighborSymmetryAllLeaves", []() { return TestNeighborSymmetry(false); } },
+		{ "AStarMatchesDijkstra", TestAStarMatchesDijkstra },
+		{ "IncrementalMatchesDijkstra", []() { return TestIncrementalMatchesDijkstra(1.0f); } },
+		{ "IncrementalMatchesDijkstraUncompensated", []() { return TestIncrementalMatchesDijkstra(0.0f); } },
+		{ "SerializationRoundTripElided", []() { return TestSerializationRoundTrip(true); } },
+		{ "SerializationRoundTripAllLeaves", []() { return TestSerializationRoundTrip(false); } }
+	};
+}
+
+int main(int Argc, char** Argv)
+{
+	auto NumRun = 0;
+	auto NumFailures = 0;
+	for (const auto& Test : Tests)
+	{
+		if (Argc > 1 && std::strcmp(Argv[1], Test.Name) != 0)
+			continue;
+
+		std::printf("%s\n", Test.Name);
+		const auto bPassed = Test.Run();
+		std::printf("%s %s\n", bPassed ? "PASS" : "FAIL", Test.Name);
+
+		NumRun++;
+		NumFailures += bPassed ? 0 : 1;
+	}
+
+	if (NumRun == 0)
+	{
+		std::fprintf(stderr, "No test named '%s'\n", Argv[1]);
+		return 1;
+	}
+
+	return NumFailures == 0 ? 0 : 1;
+}
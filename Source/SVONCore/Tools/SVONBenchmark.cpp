@@ -0,0 +1,300 @@
+// Headless generation and path finding benchmark over synthetic worlds. Writes one JSON document, so runs can be diffed
+// and tracked for regressions.
+//
+//	SVONBenchmark [--worlds spheres,city,caves,maze] [--powers 4,5,6] [--queries 100] [--seed 1] [--extent 10000]
+//	              [--clearance 0] [--elide 0|1] [--per-query] [--output results.json]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SVONCoreGenerator.h"
+#include "SVONCorePathFinder.h"
+#include "SVONSyntheticWorld.h"
+
+using namespace SVONCore;
+
+namespace
+{
+	typedef std::chrono::steady_clock FClock;
+
+	struct FBenchmarkOptions
+	{
+		std::vector<ESVONSyntheticWorld> Worlds = { ESVONSyntheticWorld::Spheres, ESVONSyntheticWorld::City, ESVONSyntheticWorld::Caves, ESVONSyntheticWorld::Maze };
+		std::vector<int32_t> VoxelPowers = { 4, 5, 6 };
+		int32_t NumQueries = 100;
+		uint32_t Seed = 1;
+		float Extent = 10000.0f;
+		float Clearance = 0.0f;
+		bool bElideUniformLeaves = true;
+		bool bPerQuery = false;
+		std::string OutputPath;
+	};
+
+	struct FQueryResult
+	{
+		bool bSucceeded = false;
+		double LatencyMicroseconds = 0.0;
+		int32_t NumExpanded = 0;
+		int32_t NumLinks = 0;
+		float Cost = 0.0f;
+		float Length = 0.0f;
+	};
+
+	std::vector<std::string> Split(const std::string& Value)
+	{
+		std::vector<std::string> Result;
+		std::stringstream Stream(Value);
+		std::string Item;
+		while (std::getline(Stream, Item, ','))
+		{
+			if (!Item.empty())
+				Result.push_back(Item);
+		}
+
+		return Result;
+	}
+
+	bool ParseOptions(int Argc, char** Argv, FBenchmarkOptions& Options)
+	{
+		for (auto i = 1; i < Argc; i++)
+		{
+			const std::string Arg = Argv[i];
+			const auto bHasValue = i + 1 < Argc;
+
+			if (Arg == "--worlds" && bHasValue)
+			{
+				Options.Worlds.clear();
+				for (const auto& Name : Split(Argv[++i]))
+				{
+					ESVONSyntheticWorld Type;
+					if (!FSVONSyntheticWorld::ParseName(Name, Type))
+					{
+						std::fprintf(stderr, "Unknown world '%s'\n", Name.c_str());
+						return false;
+					}
+
+					Options.Worlds.push_back(Type);
+				}
+			}
+			else if (Arg == "--powers" && bHasValue)
+			{
+				Options.VoxelPowers.clear();
+				for (const auto& Power : Split(Argv[++i]))
+					Options.VoxelPowers.push_back(std::atoi(Power.c_str()));
+			}
+			else if (Arg == "--queries" && bHasValue)
+				Options.NumQueries = std::atoi(Argv[++i]);
+			else if (Arg == "--seed" && bHasValue)
+				Options.Seed = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+			else if (Arg == "--extent" && bHasValue)
+				Options.Extent = static_cast<float>(std::atof(Argv[++i]));
+			else if (Arg == "--clearance" && bHasValue)
+				Options.Clearance = static_cast<float>(std::atof(Argv[++i]));
+			else if (Arg == "--elide" && bHasValue)
+				Options.bElideUniformLeaves = std::atoi(Argv[++i]) != 0;
+			else if (Arg == "--per-query")
+				Options.bPerQuery = true;
+			else if (Arg == "--output" && bHasValue)
+				Options.OutputPath = Argv[++i];
+			else
+			{
+				std::fprintf(stderr, "Unknown argument '%s'\n", Arg.c_str());
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	double GetPercentile(std::vector<double> Values, double Percentile)
+	{
+		if (Values.empty())
+			return 0.0;
+
+		// Nearest rank
+		std::sort(Values.begin(), Values.end());
+		const auto Rank = static_cast<size_t>(std::ceil(Percentile / 100.0 * Values.size()));
+		return Values[std::min(std::max(Rank, static_cast<size_t>(1)), Values.size()) - 1];
+	}
+
+	double GetMean(const std::vector<double>& Values)
+	{
+		double Sum = 0.0;
+		for (const auto Value : Values)
+			Sum += Value;
+
+		return Values.empty() ? 0.0 : Sum / Values.size();
+	}
+
+	float GetPathLength(const FSVONOctree& Octree, const std::vector<FSVONLink>& Links)
+	{
+		auto Length = 0.0f;
+		for (size_t i = 1; i < Links.size(); i++)
+		{
+			FSVONVector From, To;
+			Octree.GetLinkLocation(Links[i - 1], From);
+			Octree.GetLinkLocation(Links[i], To);
+			Length += (To - From).Size();
+		}
+
+		return Length;
+	}
+
+	void WriteStats(std::ostream& Out, const char* Name, const std::vector<double>& Values, bool bIsLast = false)
+	{
+		Out << "\t\t\t\t\"" << Name << "\": { \"mean\": " << GetMean(Values)
+			<< ", \"p50\": " << GetPercentile(Values, 50.0)
+			<< ", \"p99\": " << GetPercentile(Values, 99.0)
+			<< ", \"max\": " << GetPercentile(Values, 100.0) << " }" << (bIsLast ? "\n" : ",\n");
+	}
+
+	void RunBenchmark(const FBenchmarkOptions& Options, ESVONSyntheticWorld WorldType, int32_t VoxelPower, std::ostream& Out)
+	{
+		const FSVONSyntheticWorld World(WorldType, Options.Seed, Options.Extent);
+
+		FSVONGenerationSettings Settings;
+		Settings.Extent = Options.Extent;
+		Settings.VoxelPower = VoxelPower;
+		Settings.Clearance = Options.Clearance;
+		Settings.bElideUniformLeaves = Options.bElideUniformLeaves;
+
+		FSVONOctree Octree;
+		const auto BuildStart = FClock::now();
+		FSVONGenerator::Generate(Settings, World, Octree);
+		const auto BuildMilliseconds = std::chrono::duration<double, std::milli>(FClock::now() - BuildStart).count();
+
+		size_t NumNodes = 0;
+		for (auto i = 0; i < Octree.GetNumLayers(); i++)
+			NumNodes += Octree.GetLayer(static_cast<FLayerIndex>(i)).size();
+
+		// Queries are seeded per world and power, so adding a world doesn't change another's queries
+		FSVONRandomStream Random((static_cast<uint64_t>(Options.Seed) << 32) ^ (static_cast<uint64_t>(WorldType) << 8) ^ static_cast<uint64_t>(VoxelPower));
+		FSVONPathFinder PathFinder(Octree, FSVONPathFinderSettings());
+
+		std::vector<FQueryResult> Results;
+		for (auto i = 0; i < Options.NumQueries; i++)
+		{
+			FSVONLink Start, Goal;
+			if (!GetRandomFreeLink(Octree, Random, Start) || !GetRandomFreeLink(Octree, Random, Goal))
+				break;
+
+			FSVONPathResult Path;
+			const auto QueryStart = FClock::now();
+			const auto bSucceeded = PathFinder.FindPath(Start, Goal, Path);
+			const auto Latency = std::chrono::duration<double, std::micro>(FClock::now() - QueryStart).count();
+
+			FQueryResult Result;
+			Result.bSucceeded = bSucceeded;
+			Result.LatencyMicroseconds = Latency;
+			Result.NumExpanded = Path.NumExpanded;
+			Result.NumLinks = static_cast<int32_t>(Path.Links.size());
+			Result.Cost = Path.Cost;
+			Result.Length = bSucceeded ? GetPathLength(Octree, Path.Links) : 0.0f;
+			Results.push_back(Result);
+		}
+
+		std::vector<double> Latencies, Expanded, Lengths;
+		auto NumSucceeded = 0;
+		for (const auto& Result : Results)
+		{
+			Latencies.push_back(Result.LatencyMicroseconds);
+			Expanded.push_back(Result.NumExpanded);
+			if (Result.bSucceeded)
+			{
+				Lengths.push_back(Result.Length);
+				NumSucceeded++;
+			}
+		}
+
+		Out << "\t\t{\n";
+		Out << "\t\t\t\"world\": \"" << FSVONSyntheticWorld::GetName(WorldType) << "\",\n";
+		Out << "\t\t\t\"voxel_power\": " << VoxelPower << ",\n";
+		Out << "\t\t\t\"build_ms\": " << BuildMilliseconds << ",\n";
+		Out << "\t\t\t\"memory_bytes\": " << Octree.GetData().GetSize() << ",\n";
+		Out << "\t\t\t\"num_layers\": " << Octree.GetNumLayers() << ",\n";
+		Out << "\t\t\t\"num_nodes\": " << NumNodes << ",\n";
+		Out << "\t\t\t\"num_leaves\": " << Octree.GetData().LeafNodes.size() << ",\n";
+		Out << "\t\t\t\"queries\": {\n";
+		Out << "\t\t\t\t\"count\": " << Results.size() << ",\n";
+		Out << "\t\t\t\t\"succeeded\": " << NumSucceeded << ",\n";
+		WriteStats(Out, "latency_us", Latencies);
+		WriteStats(Out, "nodes_expanded", Expanded);
+		WriteStats(Out, "path_length", Lengths, !Options.bPerQuery);
+
+		if (Options.bPerQuery)
+		{
+			Out << "\t\t\t\t\"results\": [\n";
+			for (size_t i = 0; i < Results.size(); i++)
+			{
+				const auto& Result = Results[i];
+				Out << "\t\t\t\t\t{ \"succeeded\": " << (Result.bSucceeded ? "true" : "false")
+					<< ", \"latency_us\": " << Result.LatencyMicroseconds
+					<< ", \"nodes_expanded\": " << Result.NumExpanded
+					<< ", \"num_links\": " << Result.NumLinks
+					<< ", \"cost\": " << Result.Cost
+					<< ", \"path_length\": " << Result.Length << " }" << (i + 1 < Results.size() ? ",\n" : "\n");
+			}
+			Out << "\t\t\t\t]\n";
+		}
+
+		Out << "\t\t\t}\n";
+		Out << "\t\t}";
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	FBenchmarkOptions Options;
+	if (!ParseOptions(Argc, Argv, Options))
+		return 1;
+
+	std::ostringstream Out;
+	Out.precision(6);
+
+	Out << "{\n";
+	Out << "\t\"schema\": 1,\n";
+	Out << "\t\"seed\": " << Options.Seed << ",\n";
+	Out << "\t\"extent\": " << Options.Extent << ",\n";
+	Out << "\t\"clearance\": " << Options.Clearance << ",\n";
+	Out << "\t\"elide_uniform_leaves\": " << (Options.bElideUniformLeaves ? "true" : "false") << ",\n";
+	Out << "\t\"runs\": [\n";
+
+	auto bIsFirst = true;
+	for (const auto World : Options.Worlds)
+	{
+		for (const auto VoxelPower : Options.VoxelPowers)
+		{
+			if (!bIsFirst)
+				Out << ",\n";
+
+			bIsFirst = false;
+			std::fprintf(stderr, "%s, voxel power %d\n", FSVONSyntheticWorld::GetName(World), VoxelPower);
+			RunBenchmark(Options, World, VoxelPower, Out);
+		}
+	}
+
+	Out << "\n\t]\n}\n";
+
+	if (Options.OutputPath.empty())
+	{
+		std::fputs(Out.str().c_str(), stdout);
+		return 0;
+	}
+
+	auto* File = std::fopen(Options.OutputPath.c_str(), "w");
+	if (!File)
+	{
+		std::fprintf(stderr, "Couldn't write %s\n", Options.OutputPath.c_str());
+		return 1;
+	}
+
+	std::fputs(Out.str().c_str(), File);
+	std::fclose(File);
+	return 0;
+}
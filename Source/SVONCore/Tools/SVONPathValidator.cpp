@@ -0,0 +1,484 @@
+// Path regression corpus. Records, or checks against, golden results for the volumes and queries listed in a corpus
+// manifest, so changes to generation or the path finder can be shown not to change their output.
+//
+//	SVONPathValidator --corpus <dir> [--record]
+//
+// Every manifest line is "<world> <voxel power> <seed> <queries>". Recording writes <world>_<power>_<seed>.golden next
+// to it. Validation rebuilds each volume and re-runs each query in every variant below, and fails on any difference.
+// The goldens are of the core only. Data is hashed as FSVONDataWriter writes it and waypoints are counted as the module
+// counts them, but nothing here runs the module, so they say nothing for certain about what it bakes or finds.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SVONCoreGenerator.h"
+#include "SVONCorePathFinder.h"
+#include "SVONCoreSerialization.h"
+#include "SVONSyntheticWorld.h"
+
+using namespace SVONCore;
+
+namespace
+{
+	const int32_t GoldenVersion = 2;
+	const float CorpusExtent = 10000.0f;
+
+	// Costs are summed floats, so allow for a different but equally valid summation order
+	const float CostTolerance = 1e-5f;
+
+	struct FCorpusEntry
+	{
+		ESVONSyntheticWorld World;
+		int32_t VoxelPower;
+		uint32_t Seed;
+		int32_t NumQueries;
+
+		std::string GetGoldenName() const
+		{
+			std::ostringstream Name;
+			Name << FSVONSyntheticWorld::GetName(World) << "_" << VoxelPower << "_" << Seed << ".golden";
+			return Name.str();
+		}
+	};
+
+	struct FQueryRecord
+	{
+		uint32_t Start = 0;
+		uint32_t Goal = 0;
+		bool bSucceeded = false;
+		float Cost = 0.0f;
+		int32_t NumWaypoints = 0;
+	};
+
+	struct FGolden
+	{
+		uint64_t DataSize = 0;
+		uint64_t DataHash = 0;
+		std::vector<FQueryRecord> Queries;
+	};
+
+	enum class ESearch : uint8_t
+	{
+		Core,		// SVONCore::FSVONPathFinder, the heap
+		LinearScan	// An unsorted open list, see FindLinearScanPath
+	};
+
+	/*
+	 * A way of building and searching that must give the recorded paths. The first is what the goldens are recorded
+	 * with, and is the only one whose data has to be byte identical. Faster modes are added here before they're trusted.
+	 * Storing every leaf doesn't belong here: with elision an empty leaf becomes an open node, which is a different graph.
+	 */
+	struct FVariant
+	{
+		const char* Name;
+		bool bElideUniformLeaves;
+		bool bCheckData;
+		ESearch Search;
+	};
+
+	const FVariant Variants[] = {
+		{ "baseline", true, true, ESearch::Core },
+		{ "linear-scan", true, false, ESearch::LinearScan }
+	};
+
+	bool ReadManifest(const std::string& Path, std::vector<FCorpusEntry>& OutEntries)
+	{
+		std::ifstream File(Path);
+		if (!File)
+		{
+			std::fprintf(stderr, "Couldn't read %s\n", Path.c_str());
+			return false;
+		}
+
+		std::string Line;
+		while (std::getline(File, Line))
+		{
+			if (Line.empty() || Line[0] == '#')
+				continue;
+
+			std::istringstream Stream(Line);
+			std::string WorldName;
+			FCorpusEntry Entry;
+			if (!(Stream >> WorldName >> Entry.VoxelPower >> Entry.Seed >> Entry.NumQueries) || !FSVONSyntheticWorld::ParseName(WorldName, Entry.World))
+			{
+				std::fprintf(stderr, "Bad manifest line '%s'\n", Line.c_str());
+				return false;
+			}
+
+			OutEntries.push_back(Entry);
+		}
+
+		return true;
+	}
+
+	/* Points in a path for a search that found this many links, counted as FSVONPathFinder::BuildPath and FinishPath
+	   count them: the goal is left out for the target location to stand in for, and the start and target are a minimum */
+	int32_t GetNumPathPoints(size_t NumLinks)
+	{
+		return std::max(static_cast<int32_t>(NumLinks) - 1, 2);
+	}
+
+	/*
+	 * A* with an unsorted open list, scanned for the lowest F with the first of equal scores winning. This is the order the
+	 * heap's ties are meant to give, so the heap has to agree with it. Modelled on FSVONPathFinder::SearchPath, but a hand
+	 * written copy, so agreeing with it doesn't show the module finds the same paths
+	 */
+	bool FindLinearScanPath(const FSVONOctree& Octree, const FSVONPathFinderSettings& Settings, const FSVONLink& Start, const FSVONLink& Goal, float& OutCost, int32_t& OutNumPoints)
+	{
+		struct FRecord
+		{
+			FSVONLink CameFrom;
+			float GScore;
+			float FScore;
+			bool bIsOpen;
+			bool bIsClosed;
+		};
+
+		// Records don't move once added, so the open list can point at them
+		std::unordered_map<FSVONLink, FRecord, FSVONLinkHash> Records;
+		std::vector<std::pair<FSVONLink, FRecord*>> OpenSet;
+
+		// SetupSearch
+		FSVONIntVector GoalPosition;
+		Octree.GetLinkGridPosition(Goal, GoalPosition);
+		const auto GridUnitSize = Octree.GetVoxelSize(0) * 0.125f;
+
+		float LayerCostScale[MaxLayers];
+		const auto NumLayers = std::max(static_cast<float>(Octree.GetNumLayers()), 1.0f);
+		for (auto i = 0; i < MaxLayers; i++)
+			LayerCostScale[i] = 1.0f - (static_cast<float>(i) / NumLayers) * Settings.NodeSizeCompensation;
+
+		auto GetHeuristic = [&](const FSVONIntVector& Position)
+		{
+			const auto Delta = Position - GoalPosition;
+			if (Settings.Heuristic == ESVONHeuristic::Manhattan)
+				return static_cast<float>(std::abs(Delta.X) + std::abs(Delta.Y) + std::abs(Delta.Z)) * GridUnitSize * LayerCostScale[Goal.LayerIndex];
+
+			const auto DX = static_cast<float>(Delta.X);
+			const auto DY = static_cast<float>(Delta.Y);
+			const auto DZ = static_cast<float>(Delta.Z);
+			return std::sqrt(DX * DX + DY * DY + DZ * DZ) * GridUnitSize * LayerCostScale[Goal.LayerIndex];
+		};
+
+		auto GetCost = [&](const FSVONIntVector& From, const FSVONIntVector& To, const FSVONLink& Target)
+		{
+			if (Settings.bUseUnitCost)
+				return Settings.UnitCost * LayerCostScale[Target.LayerIndex];
+
+			const auto Delta = To - From;
+			return FSVONVector(static_cast<float>(Delta.X), static_cast<float>(Delta.Y), static_cast<float>(Delta.Z)).Size() * GridUnitSize * LayerCostScale[Target.LayerIndex];
+		};
+
+		// ResetSearch
+		FSVONIntVector Position;
+		Octree.GetLinkGridPosition(Start, Position);
+		auto& StartRecord = Records[Start];
+		StartRecord = FRecord{ Start, 0.0f, GetHeuristic(Position), true, false };
+		OpenSet.emplace_back(Start, &StartRecord);
+
+		std::vector<FSVONLink> Neighbors;
+		while (!OpenSet.empty())
+		{
+			// PopLowestScore, the first of equal scores wins
+			auto LowestScore = std::numeric_limits<float>::max();
+			size_t LowestIndex = 0;
+			for (size_t i = 0; i < OpenSet.size(); i++)
+			{
+				if (OpenSet[i].second->FScore < LowestScore)
+				{
+					LowestScore = OpenSet[i].second->FScore;
+					LowestIndex = i;
+				}
+			}
+
+			const auto Current = OpenSet[LowestIndex].first;
+			auto& CurrentRecord = *OpenSet[LowestIndex].second;
+			OpenSet.erase(OpenSet.begin() + LowestIndex);
+			CurrentRecord.bIsOpen = false;
+			CurrentRecord.bIsClosed = true;
+
+			if (Current == Goal)
+			{
+				OutCost = CurrentRecord.GScore;
+
+				// BuildPath
+				size_t NumLinks = 1;
+				for (auto Link = Goal; Records[Link].CameFrom != Link; Link = Records[Link].CameFrom)
+					NumLinks++;
+
+				OutNumPoints = GetNumPathPoints(NumLinks);
+				return true;
+			}
+
+			// ExpandCurrent
+			Octree.GetLinkGridPosition(Current, Position);
+			const auto CurrentScore = CurrentRecord.GScore;
+
+			Neighbors.clear();
+			if (Current.LayerIndex == 0 && Octree.GetNode(Current).HasChildren())
+				Octree.GetLeafNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+			else
+				Octree.GetNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+
+			for (const auto& Neighbor : Neighbors)
+			{
+				auto It = Records.find(Neighbor);
+				if (!Neighbor.IsValid() || (It != Records.end() && It->second.bIsClosed))
+					continue;
+
+				FSVONIntVector NeighborPosition;
+				Octree.GetLinkGridPosition(Neighbor, NeighborPosition);
+
+				// ProcessLink
+				if (It == Records.end())
+					It = Records.emplace(Neighbor, FRecord{ FSVONLink(), std::numeric_limits<float>::max(), 0.0f, false, false }).first;
+
+				auto& Record = It->second;
+				if (!Record.bIsOpen)
+				{
+					Record.bIsOpen = true;
+					OpenSet.emplace_back(Neighbor, &Record);
+				}
+
+				const auto Score = CurrentScore + GetCost(Position, NeighborPosition, Neighbor);
+				if (Score >= Record.GScore)
+					continue;
+
+				Record.CameFrom = Current;
+				Record.GScore = Score;
+				Record.FScore = Score + Settings.WeightEstimate * GetHeuristic(NeighborPosition);
+			}
+		}
+
+		return false;
+	}
+
+	/* Builds the entry's volume and runs its queries, the same way recording and every variant do */
+	void Run(const FCorpusEntry& Entry, const FVariant& Variant, FGolden& OutResult)
+	{
+		const FSVONSyntheticWorld World(Entry.World, Entry.Seed, CorpusExtent);
+
+		FSVONGenerationSettings Settings;
+		Settings.Extent = CorpusExtent;
+		Settings.VoxelPower = Entry.VoxelPower;
+		Settings.bElideUniformLeaves = Variant.bElideUniformLeaves;
+
+		FSVONOctree Octree;
+		FSVONGenerator::Generate(Settings, World, Octree);
+
+		std::vector<uint8_t> Bytes;
+		FSVONDataWriter::Write(Octree.GetData(), Bytes);
+		OutResult.DataSize = Bytes.size();
+		OutResult.DataHash = FSVONDataWriter::Hash(Bytes);
+
+		FSVONRandomStream Random(Entry.Seed);
+		const FSVONPathFinderSettings PathSettings;
+		FSVONPathFinder PathFinder(Octree, PathSettings);
+
+		OutResult.Queries.clear();
+		for (auto i = 0; i < Entry.NumQueries; i++)
+		{
+			FSVONLink Start, Goal;
+			if (!GetRandomFreeLink(Octree, Random, Start) || !GetRandomFreeLink(Octree, Random, Goal))
+				break;
+
+			FQueryRecord Record;
+			Record.Start = Start.GetPacked();
+			Record.Goal = Goal.GetPacked();
+
+			if (Variant.Search == ESearch::LinearScan)
+			{
+				Record.bSucceeded = FindLinearScanPath(Octree, PathSettings, Start, Goal, Record.Cost, Record.NumWaypoints);
+			}
+			else
+			{
+				FSVONPathResult Path;
+				Record.bSucceeded = PathFinder.FindPath(Start, Goal, Path);
+				Record.Cost = Path.Cost;
+				Record.NumWaypoints = Record.bSucceeded ? GetNumPathPoints(Path.Links.size()) : 0;
+			}
+
+			OutResult.Queries.push_back(Record);
+		}
+	}
+
+	bool WriteGolden(const std::string& Path, const FCorpusEntry& Entry, const FGolden& Golden)
+	{
+		std::ofstream File(Path);
+		if (!File)
+			return false;
+
+		File << "svon-golden " << GoldenVersion << "\n";
+		File << "world " << FSVONSyntheticWorld::GetName(Entry.World) << " " << Entry.VoxelPower << " " << Entry.Seed << "\n";
+		File << "data " << Golden.DataSize << " " << std::hex << Golden.DataHash << std::dec << "\n";
+
+		char Cost[32];
+		for (const auto& Query : Golden.Queries)
+		{
+			std::snprintf(Cost, sizeof(Cost), "%.9g", Query.Cost);
+			File << "query " << Query.Start << " " << Query.Goal << " " << (Query.bSucceeded ? 1 : 0) << " " << Cost << " " << Query.NumWaypoints << "\n";
+		}
+
+		return static_cast<bool>(File);
+	}
+
+	bool ReadGolden(const std::string& Path, FGolden& OutGolden)
+	{
+		std::ifstream File(Path);
+		std::string Tag;
+		int32_t Version = 0;
+		if (!(File >> Tag >> Version) || Tag != "svon-golden" || Version != GoldenVersion)
+			return false;
+
+		std::string Line;
+		while (std::getline(File, Line))
+		{
+			std::istringstream Stream(Line);
+			if (!(Stream >> Tag))
+				continue;
+
+			if (Tag == "data")
+			{
+				Stream >> OutGolden.DataSize >> std::hex >> OutGolden.DataHash;
+			}
+			else if (Tag == "query")
+			{
+				FQueryRecord Record;
+				int32_t bSucceeded = 0;
+				Stream >> Record.Start >> Record.Goal >> bSucceeded >> Record.Cost >> Record.NumWaypoints;
+				Record.bSucceeded = bSucceeded != 0;
+				OutGolden.Queries.push_back(Record);
+			}
+
+			if (!Stream && !Stream.eof())
+				return false;
+		}
+
+		return true;
+	}
+
+	/* Prints every difference, returns how many there were */
+	int32_t Compare(const FGolden& Golden, const FGolden& Result, const FVariant& Variant)
+	{
+		auto NumErrors = 0;
+
+		if (Variant.bCheckData && (Golden.DataSize != Result.DataSize || Golden.DataHash != Result.DataHash))
+		{
+			std::printf("\tdata differs, %llu bytes hash %016llx, golden %llu bytes hash %016llx\n",
+				static_cast<unsigned long long>(Result.DataSize), static_cast<unsigned long long>(Result.DataHash),
+				static_cast<unsigned long long>(Golden.DataSize), static_cast<unsigned long long>(Golden.DataHash));
+			NumErrors++;
+		}
+
+		if (Golden.Queries.size() != Result.Queries.size())
+		{
+			std::printf("\t%d queries, golden has %d\n", static_cast<int32_t>(Result.Queries.size()), static_cast<int32_t>(Golden.Queries.size()));
+			return NumErrors + 1;
+		}
+
+		for (size_t i = 0; i < Golden.Queries.size(); i++)
+		{
+			const auto& Expected = Golden.Queries[i];
+			const auto& Actual = Result.Queries[i];
+			const auto Index = static_cast<int32_t>(i);
+
+			if (Expected.Start != Actual.Start || Expected.Goal != Actual.Goal)
+				std::printf("\tquery %d is between different links\n", Index);
+			else if (Expected.bSucceeded != Actual.bSucceeded)
+				std::printf("\tquery %d %s, golden %s\n", Index, Actual.bSucceeded ? "succeeded" : "failed", Expected.bSucceeded ? "succeeded" : "failed");
+			else if (std::abs(Expected.Cost - Actual.Cost) > CostTolerance * std::max(1.0f, std::abs(Expected.Cost)))
+				std::printf("\tquery %d costs %.9g, golden %.9g\n", Index, Actual.Cost, Expected.Cost);
+			else if (Expected.NumWaypoints != Actual.NumWaypoints)
+				std::printf("\tquery %d has %d waypoints, golden %d\n", Index, Actual.NumWaypoints, Expected.NumWaypoints);
+			else
+				continue;
+
+			NumErrors++;
+		}
+
+		return NumErrors;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	std::string CorpusDirectory;
+	auto bRecord = false;
+
+	for (auto i = 1; i < Argc; i++)
+	{
+		const std::string Arg = Argv[i];
+		if (Arg == "--corpus" && i + 1 < Argc)
+			CorpusDirectory = Argv[++i];
+		else if (Arg == "--record")
+			bRecord = true;
+		else
+		{
+			std::fprintf(stderr, "Unknown argument '%s'\n", Arg.c_str());
+			return 1;
+		}
+	}
+
+	if (CorpusDirectory.empty())
+	{
+		std::fprintf(stderr, "Usage: SVONPathValidator --corpus <dir> [--record]\n");
+		return 1;
+	}
+
+	std::vector<FCorpusEntry> Entries;
+	if (!ReadManifest(CorpusDirectory + "/Corpus.txt", Entries))
+		return 1;
+
+	auto NumFailures = 0;
+	for (const auto& Entry : Entries)
+	{
+		const auto GoldenPath = CorpusDirectory + "/" + Entry.GetGoldenName();
+
+		if (bRecord)
+		{
+			FGolden Golden;
+			Run(Entry, Variants[0], Golden);
+			if (!WriteGolden(GoldenPath, Entry, Golden))
+			{
+				std::fprintf(stderr, "Couldn't write %s\n", GoldenPath.c_str());
+				return 1;
+			}
+
+			std::printf("Recorded %s, %d queries\n", Entry.GetGoldenName().c_str(), static_cast<int32_t>(Golden.Queries.size()));
+			continue;
+		}
+
+		FGolden Golden;
+		if (!ReadGolden(GoldenPath, Golden))
+		{
+			std::printf("FAIL %s: missing or unreadable golden\n", Entry.GetGoldenName().c_str());
+			NumFailures++;
+			continue;
+		}
+
+		for (const auto& Variant : Variants)
+		{
+			FGolden Result;
+			Run(Entry, Variant, Result);
+
+			const auto NumErrors = Compare(Golden, Result, Variant);
+			std::printf("%s %s (%s)\n", NumErrors == 0 ? "PASS" : "FAIL", Entry.GetGoldenName().c_str(), Variant.Name);
+			if (NumErrors > 0)
+				NumFailures++;
+		}
+	}
+
+	if (!bRecord)
+		std::printf("%d failure(s)\n", NumFailures);
+
+	return NumFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+#include "SVONSyntheticWorld.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SVONCore
+{
+	namespace
+	{
+		const char* const WorldNames[] = { "spheres", "city", "caves", "maze" };
+
+		float GetDistanceSquaredToBox(const FSVONVector& Point, const FSVONBox& Box)
+		{
+			auto Axis = [](float Value, float Min, float Max)
+			{
+				const auto Clamped = std::min(std::max(Value, Min), Max);
+				return (Clamped - Value) * (Clamped - Value);
+			};
+
+			return Axis(Point.X, Box.Min.X, Box.Max.X) + Axis(Point.Y, Box.Min.Y, Box.Max.Y) + Axis(Point.Z, Box.Min.Z, Box.Max.Z);
+		}
+	}
+
+	FSVONSyntheticWorld::FSVONSyntheticWorld(ESVONSyntheticWorld Type, uint32_t Seed, float Extent)
+		: Extent(Extent)
+	{
+		switch (Type)
+		{
+		case ESVONSyntheticWorld::Spheres:
+			BuildSpheres(Seed);
+			break;
+		case ESVONSyntheticWorld::City:
+			BuildCity(Seed);
+			break;
+		case ESVONSyntheticWorld::Caves:
+			BuildCaves(Seed);
+			break;
+		case ESVONSyntheticWorld::Maze:
+			BuildMaze(Seed);
+			break;
+		}
+
+		BuildCells();
+	}
+
+	const char* FSVONSyntheticWorld::GetName(ESVONSyntheticWorld Type)
+	{
+		return WorldNames[static_cast<uint8_t>(Type)];
+	}
+
+	bool FSVONSyntheticWorld::ParseName(const std::string& Name, ESVONSyntheticWorld& OutType)
+	{
+		for (uint8_t i = 0; i < sizeof(WorldNames) / sizeof(WorldNames[0]); i++)
+		{
+			if (Name == WorldNames[i])
+			{
+				OutType = static_cast<ESVONSyntheticWorld>(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void FSVONSyntheticWorld::BuildSpheres(uint32_t Seed)
+	{
+		FSVONRandomStream Random(Seed);
+		for (auto i = 0; i < 48; i++)
+		{
+			const FSVONVector Center(Random.GetRange(-Extent, Extent), Random.GetRange(-Extent, Extent), Random.GetRange(-Extent, Extent));
+			Spheres.push_back(FSphere{ Center, Random.GetRange(0.03f, 0.12f) * Extent });
+		}
+	}
+
+	void FSVONSyntheticWorld::BuildCity(uint32_t Seed)
+	{
+		FSVONRandomStream Random(Seed);
+
+		// Ground
+		const auto GroundHeight = -0.9f * Extent;
+		Boxes.emplace_back(FSVONVector(-Extent), FSVONVector(Extent, Extent, GroundHeight));
+
+		// Blocks of one tower each, streets are the 30% between them
+		const auto NumBlocks = 8;
+		const auto BlockSize = 2.0f * Extent / NumBlocks;
+		const auto TowerHalfSize = BlockSize * 0.35f;
+		for (auto X = 0; X < NumBlocks; X++)
+		{
+			for (auto Y = 0; Y < NumBlocks; Y++)
+			{
+				// Some lots are left empty as plazas
+				if (Random.GetFraction() < 0.15f)
+					continue;
+
+				const auto CenterX = -Extent + (X + 0.5f) * BlockSize;
+				const auto CenterY = -Extent + (Y + 0.5f) * BlockSize;
+				const auto Height = GroundHeight + Random.GetRange(0.1f, 1.5f) * Extent;
+				Boxes.emplace_back(FSVONVector(CenterX - TowerHalfSize, CenterY - TowerHalfSize, GroundHeight), FSVONVector(CenterX + TowerHalfSize, CenterY + TowerHalfSize, Height));
+			}
+		}
+	}
+
+	void FSVONSyntheticWorld::BuildCaves(uint32_t Seed)
+	{
+		FSVONRandomStream Random(Seed);
+		bIsCarved = true;
+
+		// A few chambers, joined by tunnels that wander from one to the next
+		std::vector<FSVONVector> Chambers;
+		for (auto i = 0; i < 6; i++)
+		{
+			const FSVONVector Center(Random.GetRange(-0.7f, 0.7f) * Extent, Random.GetRange(-0.7f, 0.7f) * Extent, Random.GetRange(-0.7f, 0.7f) * Extent);
+			Chambers.push_back(Center);
+			Spheres.push_back(FSphere{ Center, Random.GetRange(0.15f, 0.25f) * Extent });
+		}
+
+		for (size_t i = 1; i < Chambers.size(); i++)
+		{
+			auto Location = Chambers[i - 1];
+			const auto Radius = Random.GetRange(0.05f, 0.09f) * Extent;
+			const auto Step = Radius;
+
+			for (auto j = 0; j < 256; j++)
+			{
+				const auto ToTarget = Chambers[i] - Location;
+				const auto Distance = ToTarget.Size();
+				if (Distance < Step)
+					break;
+
+				// Mostly towards the next chamber, with some wander
+				const auto Wander = FSVONVector(Random.GetRange(-1.0f, 1.0f), Random.GetRange(-1.0f, 1.0f), Random.GetRange(-1.0f, 1.0f)) * 0.6f;
+				auto Direction = ToTarget * (1.0f / Distance) + Wander;
+				Direction = Direction * (1.0f / Direction.Size());
+
+				Location = Location + Direction * Step;
+				Spheres.push_back(FSphere{ Location, Radius });
+			}
+		}
+	}
+
+	void FSVONSyntheticWorld::BuildMaze(uint32_t Seed)
+	{
+		FSVONRandomStream Random(Seed);
+
+		const auto NumCells = 6;
+		const auto CellSize = 2.0f * Extent / NumCells;
+		const auto HalfThickness = CellSize * 0.05f;
+
+		auto GetIndex = [NumCells](int32_t X, int32_t Y, int32_t Z) { return (Z * NumCells + Y) * NumCells + X; };
+		auto SetAxis = [](FSVONVector& Vector, int32_t Axis, float Value) { (Axis == 0 ? Vector.X : (Axis == 1 ? Vector.Y : Vector.Z)) = Value; };
+
+		// Openings[Cell * 3 + Axis] is whether the wall on the positive side of the cell along that axis was removed
+		std::vector<bool> Openings(NumCells * NumCells * NumCells * 3, false);
+		std::vector<bool> Visited(NumCells * NumCells * NumCells, false);
+
+		// Depth first carve from the corner cell, a spanning tree so every cell is reachable
+		std::vector<FSVONIntVector> Stack;
+		Stack.emplace_back(0, 0, 0);
+		Visited[0] = true;
+		while (!Stack.empty())
+		{
+			const auto Cell = Stack.back();
+
+			FSVONIntVector Candidates[6];
+			auto NumCandidates = 0;
+			for (const auto& Direction : FSVONStatics::Directions)
+			{
+				const FSVONIntVector Next(Cell.X + Direction.X, Cell.Y + Direction.Y, Cell.Z + Direction.Z);
+				if (Next.X >= 0 && Next.X < NumCells && Next.Y >= 0 && Next.Y < NumCells && Next.Z >= 0 && Next.Z < NumCells
+					&& !Visited[GetIndex(Next.X, Next.Y, Next.Z)])
+					Candidates[NumCandidates++] = Next;
+			}
+
+			if (NumCandidates == 0)
+			{
+				Stack.pop_back();
+				continue;
+			}
+
+			const auto Next = Candidates[Random.GetIndex(NumCandidates)];
+			Visited[GetIndex(Next.X, Next.Y, Next.Z)] = true;
+
+			// The wall between them belongs to whichever cell is on its negative side
+			const auto Axis = Next.X != Cell.X ? 0 : (Next.Y != Cell.Y ? 1 : 2);
+			const auto& Lower = (Next.X + Next.Y + Next.Z) < (Cell.X + Cell.Y + Cell.Z) ? Next : Cell;
+			Openings[GetIndex(Lower.X, Lower.Y, Lower.Z) * 3 + Axis] = true;
+
+			Stack.push_back(Next);
+		}
+
+		for (auto Z = 0; Z < NumCells; Z++)
+		{
+			for (auto Y = 0; Y < NumCells; Y++)
+			{
+				for (auto X = 0; X < NumCells; X++)
+				{
+					const FSVONVector Min(-Extent + X * CellSize, -Extent + Y * CellSize, -Extent + Z * CellSize);
+					const auto Max = Min + FSVONVector(CellSize);
+					const int32_t Coords[3] = { X, Y, Z };
+
+					for (auto Axis = 0; Axis < 3; Axis++)
+					{
+						// Walls only go between cells, the volume's own edge closes the maze
+						if (Coords[Axis] == NumCells - 1 || Openings[GetIndex(X, Y, Z) * 3 + Axis])
+							continue;
+
+						// A slab straddling the cell's positive face on this axis
+						auto Wall = FSVONBox(Min, Max);
+						const float Face[3] = { Max.X, Max.Y, Max.Z };
+						SetAxis(Wall.Min, Axis, Face[Axis] - HalfThickness);
+						SetAxis(Wall.Max, Axis, Face[Axis] + HalfThickness);
+						Boxes.push_back(Wall);
+					}
+				}
+			}
+		}
+	}
+
+	void FSVONSyntheticWorld::BuildCells()
+	{
+		Cells.assign(GridSize * GridSize * GridSize, std::vector<uint32_t>());
+
+		auto AddToCells = [this](uint32_t Primitive, const FSVONVector& Min, const FSVONVector& Max)
+		{
+			int32_t CellMin[3], CellMax[3];
+			GetCellRange(Min, Max, CellMin, CellMax);
+			for (auto Z = CellMin[2]; Z <= CellMax[2]; Z++)
+			{
+				for (auto Y = CellMin[1]; Y <= CellMax[1]; Y++)
+				{
+					for (auto X = CellMin[0]; X <= CellMax[0]; X++)
+						Cells[(Z * GridSize + Y) * GridSize + X].push_back(Primitive);
+				}
+			}
+		};
+
+		for (uint32_t i = 0; i < Spheres.size(); i++)
+			AddToCells(i, Spheres[i].Center - FSVONVector(Spheres[i].Radius), Spheres[i].Center + FSVONVector(Spheres[i].Radius));
+
+		for (uint32_t i = 0; i < Boxes.size(); i++)
+			AddToCells(static_cast<uint32_t>(Spheres.size()) + i, Boxes[i].Min, Boxes[i].Max);
+	}
+
+	void FSVONSyntheticWorld::GetCellRange(const FSVONVector& Min, const FSVONVector& Max, int32_t OutMin[3], int32_t OutMax[3]) const
+	{
+		const auto InverseCellSize = GridSize / (2.0f * Extent);
+		const float Mins[3] = { Min.X, Min.Y, Min.Z };
+		const float Maxs[3] = { Max.X, Max.Y, Max.Z };
+
+		for (auto Axis = 0; Axis < 3; Axis++)
+		{
+			OutMin[Axis] = std::min(std::max(static_cast<int32_t>(std::floor((Mins[Axis] + Extent) * InverseCellSize)), 0), GridSize - 1);
+			OutMax[Axis] = std::min(std::max(static_cast<int32_t>(std::floor((Maxs[Axis] + Extent) * InverseCellSize)), 0), GridSize - 1);
+		}
+	}
+
+	bool FSVONSyntheticWorld::Overlaps(uint32_t Primitive, const FSVONBox& Box) const
+	{
+		if (Primitive < Spheres.size())
+		{
+			const auto& Sphere = Spheres[Primitive];
+			return GetDistanceSquaredToBox(Sphere.Center, Box) < Sphere.Radius * Sphere.Radius;
+		}
+
+		// Touching faces don't count, like the module's area modifiers
+		const auto& Other = Boxes[Primitive - Spheres.size()];
+		return Box.Min.X < Other.Max.X && Other.Min.X < Box.Max.X
+			&& Box.Min.Y < Other.Max.Y && Other.Min.Y < Box.Max.Y
+			&& Box.Min.Z < Other.Max.Z && Other.Min.Z < Box.Max.Z;
+	}
+
+	bool FSVONSyntheticWorld::IsBlocked(const FSVONVector& Center, float HalfExtent) const
+	{
+		const FSVONBox Box(Center - FSVONVector(HalfExtent), Center + FSVONVector(HalfExtent));
+
+		if (bIsCarved)
+		{
+			// Open only if one tunnel sphere holds the whole box. Any sphere that does contains the centre, so it's in the centre's cell
+			int32_t CellMin[3], CellMax[3];
+			GetCellRange(Center, Center, CellMin, CellMax);
+			for (const auto Primitive : Cells[(CellMin[2] * GridSize + CellMin[1]) * GridSize + CellMin[0]])
+			{
+				const auto& Sphere = Spheres[Primitive];
+				const auto Far = FSVONVector(
+					std::max(std::abs(Box.Min.X - Sphere.Center.X), std::abs(Box.Max.X - Sphere.Center.X)),
+					std::max(std::abs(Box.Min.Y - Sphere.Center.Y), std::abs(Box.Max.Y - Sphere.Center.Y)),
+					std::max(std::abs(Box.Min.Z - Sphere.Center.Z), std::abs(Box.Max.Z - Sphere.Center.Z)));
+
+				if (Far.SizeSquared() <= Sphere.Radius * Sphere.Radius)
+					return false;
+			}
+
+			return true;
+		}
+
+		int32_t CellMin[3], CellMax[3];
+		GetCellRange(Box.Min, Box.Max, CellMin, CellMax);
+		for (auto Z = CellMin[2]; Z <= CellMax[2]; Z++)
+		{
+			for (auto Y = CellMin[1]; Y <= CellMax[1]; Y++)
+			{
+				for (auto X = CellMin[0]; X <= CellMax[0]; X++)
+				{
+					for (const auto Primitive : Cells[(Z * GridSize + Y) * GridSize + X])
+					{
+						if (Overlaps(Primitive, Box))
+							return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool GetRandomFreeLink(const FSVONOctree& Octree, FSVONRandomStream& Random, FSVONLink& OutLink)
+	{
+		const auto Bounds = Octree.GetBounds();
+		for (auto Attempt = 0; Attempt < 1000; Attempt++)
+		{
+			const FSVONVector Location(
+				Random.GetRange(Bounds.Min.X, Bounds.Max.X),
+				Random.GetRange(Bounds.Min.Y, Bounds.Max.Y),
+				Random.GetRange(Bounds.Min.Z, Bounds.Max.Z));
+
+			if (Octree.GetLink(Location, OutLink))
+				return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SVONCoreGenerator.h"
+
+namespace SVONCore
+{
+	enum class ESVONSyntheticWorld : uint8_t
+	{
+		Spheres,	// Random floating spheres
+		City,		// Grid of tower blocks on a ground plane, streets between them
+		Caves,		// Solid rock with tunnels of overlapping spheres carved through it
+		Maze		// Cubic cells with walls between them, a random spanning tree of openings
+	};
+
+	/* Small seeded generator, the same sequence on every platform unlike the standard distributions */
+	struct FSVONRandomStream
+	{
+		uint64_t State;
+
+		explicit FSVONRandomStream(uint64_t Seed)
+			: State(Seed) {}
+
+		/* SplitMix64 */
+		uint64_t Next()
+		{
+			uint64_t Value = (State += 0x9E3779B97F4A7C15ULL);
+			Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBULL;
+			return Value ^ (Value >> 31);
+		}
+
+		/* In [0, 1) */
+		float GetFraction() { return static_cast<float>(Next() >> 40) / static_cast<float>(1ULL << 24); }
+		float GetRange(float Min, float Max) { return Min + (Max - Min) * GetFraction(); }
+
+		/* In [0, Count) */
+		int32_t GetIndex(int32_t Count) { return static_cast<int32_t>(Next() % static_cast<uint64_t>(Count)); }
+	};
+
+	/* Procedural occupancy for headless tools. The same type, seed and extent always give the same world */
+	class FSVONSyntheticWorld : public ISVONOccupancy
+	{
+	public:
+		FSVONSyntheticWorld(ESVONSyntheticWorld Type, uint32_t Seed, float Extent);
+
+		virtual bool IsBlocked(const FSVONVector& Center, float HalfExtent) const override;
+
+		static const char* GetName(ESVONSyntheticWorld Type);
+		static bool ParseName(const std::string& Name, ESVONSyntheticWorld& OutType);
+
+	private:
+		struct FSphere
+		{
+			FSVONVector Center;
+			float Radius;
+		};
+
+		float Extent;
+
+		// Caves are blocked everywhere except inside the spheres
+		bool bIsCarved = false;
+
+		std::vector<FSphere> Spheres;
+		std::vector<FSVONBox> Boxes;
+
+		/* Uniform buckets of sphere and box indices, boxes offset by the number of spheres */
+		static const int32_t GridSize = 16;
+		std::vector<std::vector<uint32_t>> Cells;
+
+		void BuildSpheres(uint32_t Seed);
+		void BuildCity(uint32_t Seed);
+		void BuildCaves(uint32_t Seed);
+		void BuildMaze(uint32_t Seed);
+
+		void BuildCells();
+		void GetCellRange(const FSVONVector& Min, const FSVONVector& Max, int32_t OutMin[3], int32_t OutMax[3]) const;
+
+		bool Overlaps(uint32_t Primitive, const FSVONBox& Box) const;
+	};
+
+	/* A random free link, or false if the octree is too solid to find one in a reasonable number of tries */
+	bool GetRandomFreeLink(const FSVONOctree& Octree, FSVONRandomStream& Random, FSVONLink& OutLink);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+
+#include "SVONDefines.h"
+
+#include "SVONModifierVolume.generated.h"
+
+/* Tags the space it covers in any SVON volume generated around it. The octree is subdivided down to layer 0 inside it, so the
+   tags are as precise as a layer 0 node */
+UCLASS(HideCategories = (Tags, Cooking, Actor, HLOD, Mobile, LOD))
+class UESVON_API ASVONModifierVolume
+	: public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	ASVONModifierVolume();
+
+	// Areas to stamp, query filters decide whether paths avoid them or pay extra to cross them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON", meta = (Bitmask, BitmaskEnum = "ESVONAreaFlags"))
+	int32 AreaFlags;
+
+	uint8 GetAreaFlags() const { return static_cast<uint8>(AreaFlags & ((1 << FSVONAreaFilter::NumAreas) - 1)); }
+};
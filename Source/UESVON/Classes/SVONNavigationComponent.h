@@ -2,14 +2,20 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Templates/SubclassOf.h"
 #include "SVONNavigationPath.h"
 #include "SVONLink.h"
 #include "SVONTypes.h"
+#include "SVONBatchPathFinder.h"
 
 #include "SVONNavigationComponent.generated.h"
 
 class ASVONVolumeActor;
 struct FSVONLink;
+struct FSVONPathFinderSettings;
+struct FSVONGoalCost;
+class UNavigationQueryFilter;
+class FSVONIncrementalPathFinder;
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class UESVON_API USVONNavigationComponent 
@@ -42,9 +48,55 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Heuristics")
 	ESVONPathCostType PathCostType = ESVONPathCostType::SPCT_Euclidean;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVO Navigation | Smoothing")
+	// Extra cost for moving next to obstacles, from the volume's distance field. At 1, touching a wall costs double
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Heuristics", meta = (ClampMin = "0"))
+	float ObstacleAvoidanceWeight = 0.0f;
+
+	// Distance from obstacles where the avoidance cost fades out
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Heuristics", meta = (ClampMin = "0"))
+	float ObstacleAvoidanceDistance = 200.0f;
+
+	// Capped at 4, Chaikin doubles the path's points each pass
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVO Navigation | Smoothing", meta = (ClampMin = "0", ClampMax = "4", UIMin = "0", UIMax = "4"))
 	int32 SmoothingIterations = 0;
 
+	// Drop waypoints that have a clear line of sight past them, checked against the voxel data. Off by default, like smoothing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVO Navigation | Smoothing")
+	bool bUseStringPulling = false;
+
+	// Chaikin runs SmoothingIterations passes, Catmull-Rom splits each segment into SmoothingIterations + 1 pieces
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVO Navigation | Smoothing")
+	ESVONPathSmoothingType SmoothingType = ESVONPathSmoothingType::SPST_None;
+
+	// Radius of the agent, used to pick which of the volume's baked clearance levels it navigates
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON", meta = (ClampMin = "0"))
+	float AgentRadius = 0.0f;
+
+	// How far to look for somewhere navigable when the start or target is inside blocked space. Zero fails those requests instead
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Connectivity", meta = (ClampMin = "0"))
+	float NearestLinkSearchRadius = 200.0f;
+
+	// When the target is in a region the start can't reach, path to the closest point we can reach instead of failing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Connectivity")
+	bool bRedirectUnreachableTarget = false;
+
+	// How far from an unreachable target to look for a point we can reach. The lookup runs on the game thread and may visit every
+	// node within this distance of the target, so keep it to what a redirect is worth
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Connectivity", meta = (ClampMin = "0", EditCondition = "bRedirectUnreachableTarget"))
+	float RedirectSearchRadius = 1000.0f;
+
+	// Path to targets in other loaded volumes, through the portals between them. Otherwise only our current volume is searched
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Portals")
+	bool bAllowCrossVolumePaths = true;
+
+	// Links a flow field may settle per request before giving up until the next one, zero is unlimited
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Flow Field", meta = (ClampMin = "0"))
+	int32 FlowFieldExpansionsPerRequest = 20000;
+
+	// Keep the last search and repair it when the goal moves, rather than searching again. Used by move tasks tracking a moving goal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tracking")
+	bool bUseIncrementalPlanner = false;
+
 	// Sets default values for this component's properties
 	USVONNavigationComponent();
 
@@ -58,14 +110,35 @@ protected:
 	// Do I have a valid nav volume ready?
 	bool HasNavVolume();
 
+	// A valid nav volume that was baked for our AgentRadius. Warns if the volume's radii are all too small for us
+	bool HasNavVolumeForAgent();
+
 	// Check the scene for a valid volume that I am within the extents of
 	bool FindVolume();
 
 	// Print current layer/morton Code information
 	void DebugLocalLocation(FVector& aPosition);
 
+	// Find the start and target links for a request, moving blocked endpoints into free space and rejecting or redirecting targets the start can't reach
+	bool GetPathEndpoints(const FVector& StartLocation, const FVector& TargetLocation, FSVONLink& OutStartLink, FSVONLink& OutTargetLink, FVector& OutTargetLocation);
+
+	// True if cross volume paths are allowed and the location is in a registered volume other than ours
+	bool IsInOtherVolume(const FVector& Location) const;
+
+	// Stitch a path together through the volumes between ours and the one containing the target
+	bool FindPathAcrossVolumes(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass);
+
+	// The volume's clearance level for our AgentRadius. Only meaningful once HasNavVolumeForAgent has passed
+	uint8 GetClearanceLevel() const;
+
+	// Copy the pathfinding properties, and the areas the filter class avoids, into a settings block for the path finder
+	void GetPathFinderSettings(FSVONPathFinderSettings& OutSettings, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr) const;
+
 	FSVONNavPathSharedPtr SVONPath;
 
+	// Kept between FindPathIncremental calls, replaced when the volume or path finder settings change
+	TSharedPtr<FSVONIncrementalPathFinder> IncrementalPathFinder;
+
 	FSVONLink LastLocation;
 
 	TQueue<int32> JobQueue;
@@ -85,10 +158,32 @@ public:
 
 	const ASVONVolumeActor* GetCurrentVolume() const { return CurrentNavVolume; }
 
-	/* This method isn't hooked up at the moment, pending integration with existing systems */
-	bool FindPathAsync(const FVector& StartLocation, const FVector& TargetLocation, FThreadSafeBool& CompleteFlag, FSVONNavPathSharedPtr* OutNavPath);
+	/* This method isn't hooked up at the moment, pending integration with existing systems. The filter class picks which tagged
+	   areas to avoid, see USVONNavigationQueryFilter */
+	bool FindPathAsync(const FVector& StartLocation, const FVector& TargetLocation, FThreadSafeBool& CompleteFlag, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
+
+	bool FindPathImmediate(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
+
+	/* FindPathImmediate, but picking up this component's last search where it can, for a target that keeps moving. See
+	   FSVONIncrementalPathFinder. Targets in other volumes get a full search every time */
+	bool FindPathIncremental(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
+
+	/* Drops the search FindPathIncremental keeps, for when the agent starts chasing something else */
+	void ResetIncrementalPath();
+
+	/* Solves every query in the batch as one job on the SVON worker pool, for many short hops at once. All of them must be
+	   in this component's volume. The batch's bIsComplete is set once its spans and points are filled */
+	bool FindPathBatchAsync(FSVONPathBatchPtr Batch, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
+
+	/* Follows the volume's shared flow field to the target instead of searching, for when many agents head to the same place.
+	   Returns false while the field hasn't reached the start yet, each call extends it by FlowFieldExpansionsPerRequest */
+	bool FindPathFlowField(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
+
+	/* Next hop towards the target on the shared flow field, a lookup once the field covers the location */
+	bool GetFlowFieldNextLocation(const FVector& Location, const FVector& TargetLocation, FVector& OutNextLocation, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
 
-	bool FindPathImmediate(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath);
+	/* Costs from the start to the nearest MaxResults goals (all of them if MaxResults <= 0) in one search, nearest first */
+	int32 FindGoalCosts(const FVector& StartLocation, const TArray<FVector>& GoalLocations, int32 MaxResults, TArray<FSVONGoalCost>& OutResults, TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr);
 
 	FSVONNavPathSharedPtr& GetPath() { return SVONPath; }
 };
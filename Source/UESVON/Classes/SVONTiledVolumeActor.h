@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+
+#include "SVONTileLoadTask.h"
+
+#include "SVONTiledVolumeActor.generated.h"
+
+class ASVONVolumeActor;
+
+/* Navigation for a world too big for one resident octree. The brush is split into cubic tiles, each baked to its own file.
+   At runtime tiles around the navigation components in the world are loaded in the background and spawned as ordinary
+   volumes, which portal to each other through the volume registry. Tiles nobody is near are evicted once the budget is
+   exceeded, so memory follows where the agents are rather than the size of the world */
+UCLASS(HideCategories = (Tags, Cooking, Actor, HLOD, Mobile, LOD))
+class UESVON_API ASVONTiledVolumeActor
+	: public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	ASVONTiledVolumeActor();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Edge length of a tile. Tiles are cubes starting at the brush's minimum corner
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles", meta = (ClampMin = "100"))
+	float TileSize = 25600.0f;
+
+	// VoxelPower of each tile's octree
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles", meta = (ClampMin = "1", ClampMax = "12"))
+	int32 TileVoxelPower = 6;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles")
+	TEnumAsByte<ECollisionChannel> CollisionChannel;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles")
+	float Clearance = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles")
+	TArray<float> AdditionalClearances;
+
+	// Where tiles are baked to and streamed from, relative to the project's content directory. Add it to the packaging
+	// settings' additional non-asset directories so it ships
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Tiles")
+	FString TileDirectory = TEXT("SVONTiles");
+
+	// Tiles within this distance of any navigation component are loaded
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Streaming", meta = (ClampMin = "0"))
+	float LoadRadius = 30000.0f;
+
+	// Loaded tiles over this are evicted, least recently needed first. Tiles near an agent are kept even over budget
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Streaming", meta = (ClampMin = "1"))
+	int32 MemoryBudgetMB = 256;
+
+	// Seconds between looking for tiles to load and evict. Finished loads are picked up every tick
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Streaming", meta = (ClampMin = "0"))
+	float UpdateInterval = 0.5f;
+
+	/* Generates every tile of the brush and writes them, with an index, to TileDirectory */
+	UFUNCTION(CallInEditor, Category = "SVON|Tiles")
+	void BakeTiles();
+
+	int32 GetNumLoadedTiles() const;
+	SIZE_T GetLoadedBytes() const;
+
+private:
+	struct FTile
+	{
+		TWeakObjectPtr<ASVONVolumeActor> Volume;
+		FSVONTileLoadPtr Load;
+		SIZE_T NumBytes = 0;
+		float LastNeeded = 0.0f;
+	};
+
+	FBox Bounds;
+	FIntVector NumTiles;
+
+	// Tiles the index says were baked, anything else is left unloaded
+	TSet<FIntVector> BakedTiles;
+	TMap<FIntVector, FTile> Tiles;
+
+	float TimeSinceUpdate = 0.0f;
+
+	void SetupTiles();
+	FString GetTileDirectory() const;
+	FBox GetTileBounds(const FIntVector& Tile) const;
+	FIntVector GetTileCoord(const FVector& Location) const;
+
+	void UpdateTiles();
+	void FinishLoads();
+	void EvictTiles(const TSet<FIntVector>& Needed);
+
+	void StartLoad(const FIntVector& Coord, FTile& Tile);
+	ASVONVolumeActor* SpawnTileVolume(const FIntVector& Coord, FSVONTileLoad& Load);
+};
@@ -2,11 +2,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Volume.h"
+#include "HAL/ThreadSafeCounter.h"
 
 #include "SVONDefines.h"
 #include "SVONNode.h"
 #include "SVONLeafNode.h"
 #include "SVONData.h"
+#include "SVONDataBlob.h"
+#include "SVONConnectivity.h"
+#include "SVONDistanceField.h"
+#include "SVONFlowField.h"
+#include "SVONLinkIndex.h"
+#include "SVONPathCache.h"
+#include "SVONPortal.h"
 #include "UESVON.h"
 
 #include "SVONVolumeActor.generated.h"
@@ -18,6 +26,24 @@ enum class ESVOGenerationStrategy : uint8
 	SGS_GenerateOnBeginPlay		UMETA(DisplayName = "Generate on BeginPlay")
 };
 
+/* What a volume's memory goes on, for svon.DumpMemory. The blob holds the octree and everything baked with it, the rest
+   is built at runtime */
+struct UESVON_API FSVONVolumeMemory
+{
+	SIZE_T Blob = 0;
+	SIZE_T Nodes = 0;
+	SIZE_T Leaves = 0;
+	SIZE_T Connectivity = 0;
+	SIZE_T DistanceField = 0;
+
+	SIZE_T LinkIndex = 0;
+	SIZE_T FlowFields = 0;
+	int32 NumFlowFields = 0;
+	SIZE_T PathCache = 0;
+
+	SIZE_T GetTotal() const { return Blob + LinkIndex + FlowFields + PathCache; }
+};
+
 UCLASS(HideCategories = (Tags, Cooking, Actor, HLOD, Mobile, LOD))
 class UESVON_API ASVONVolumeActor 
     : public AVolume
@@ -28,6 +54,8 @@ public:
     ASVONVolumeActor();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void BeginDestroy() override;
 
 	//~ Begin AActor Interface
 	virtual void PostRegisterAllComponents() override;
@@ -70,9 +98,51 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
 	float Clearance = 0.0f;
 
+	// Larger agent radii baked in the same pass as Clearance. Each one adds a leaf bitboard per leaf, agents pick the smallest that fits them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
+	TArray<float> AdditionalClearances;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
 	ESVOGenerationStrategy GenerationStrategy = ESVOGenerationStrategy::SGS_UseBaked;
 
+	// Save the baked octree compressed. Much smaller map packages for high VoxelPower, at the cost of decompressing it on load
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
+	bool bCompressBakedData = false;
+
+	// Only store leaves that are partly blocked. Completely blocked leaves become a flag on their node and empty ones become free nodes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
+	bool bElideUniformLeaves = true;
+
+	// Keep recently found paths, so repeated requests between the same nodes skip the search. Can be changed at runtime, the
+	// next query picks it up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Path Cache")
+	bool bEnablePathCache = false;
+
+	// Maximum number of cached paths, the least recently used are evicted first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Path Cache", meta = (ClampMin = "1", EditCondition = "bEnablePathCache"))
+	int32 PathCacheSize = 64;
+
+	// Label connected regions when generating, so requests between disconnected regions fail without a search. Baked with the octree
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
+	bool bBuildConnectivity = true;
+
+	// Compute each node and leaf voxel's distance to the nearest obstacle when generating, for path costs that avoid walls. Baked with the octree
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
+	bool bBuildDistanceField = true;
+
+	// Number of flow fields kept for shared goals, the least recently used is dropped first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Flow Field", meta = (ClampMin = "1"))
+	int32 FlowFieldCacheSize = 4;
+
+	// Build portals to other volumes this one touches or overlaps as they stream in, so paths can cross between them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Portals")
+	bool bConnectToAdjacentVolumes = true;
+
+	// Distance between samples on a shared boundary, each cell of it keeps one portal per pair of regions they join. Zero uses
+	// the layer 0 node size of the coarser volume
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON|Portals", meta = (ClampMin = "0", EditCondition = "bConnectToAdjacentVolumes"))
+	float PortalSpacing = 0.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SVON")
 	uint8 NumLayers = 0;
 
@@ -83,54 +153,182 @@ public:
 
 	const FVector& GetOrigin() const { return Origin; }
 	const FVector& GetExtent() const { return Extent; }
+	FBox GetBounds() const { return FBox(Origin - Extent, Origin + Extent); }
+
+	/* True inside the brush, or inside the tile bounds for volumes spawned by a tiled volume */
+	bool ContainsPoint(const FVector& Location) const;
+
+	/* Use these bounds instead of the brush's. Tiles are spawned at runtime with no brush of their own */
+	void SetTileBounds(const FBox& Bounds);
+	bool HasTileBounds() const { return TileBounds.IsValid != 0; }
+
+	/* The octree every query reads, flattened once generation finishes or straight from the baked buffer */
+	const FSVONDataBlob& GetBlob() const { return Blob; }
+
+	/* Unique to this volume and the octree it holds. A new one is handed out whenever the data is generated, loaded or
+	   replaced, so something kept for a volume can tell it isn't for a tile respawned at the same address */
+	uint32 GetDataId() const { return DataId; }
+
+	/* Replace the octree with data loaded elsewhere, along with the derived data baked into it. Caches are dropped. Pass the
+	   blob's link index if it was already built elsewhere, otherwise it's built here */
+	void SetBlob(FSVONDataBlob&& InBlob, FSVONLinkIndex* InLinkIndex = nullptr);
+
+	/* Octree, the connectivity labels and distance field built from it, cached paths and flow fields */
+	SIZE_T GetAllocatedSize() const;
+
+	/* The same, broken down by what it's for. Game thread only */
+	FSVONVolumeMemory GetMemory() const;
 	const uint8 GetNumLayers() const { return NumLayers; }
-	const TArray<FSVONNode>& GetLayer(FLayerIndex Layer) const;
-	float GetVoxelSize(FLayerIndex Layer) const;
+	TArrayView<const FSVONNode> GetLayer(FLayerIndex Layer) const;
+	FORCEINLINE float GetVoxelSize(FLayerIndex Layer) const { return GetLayerGeometry(Layer).VoxelSize; }
+	FORCEINLINE const FSVONLayerGeometry& GetLayerGeometry(FLayerIndex Layer) const { return LayerGeometry[FMath::Min<int32>(Layer, MaxLayers - 1)]; }
 
 	bool IsReadyForNavigation();
 	
 	bool GetLinkLocation(const FSVONLink& Link, FVector& OutLocation) const;
+	void GetLinkGridPosition(const FSVONLink& Link, FIntVector& OutPosition) const;
 	bool GetNodeLocation(FLayerIndex Layer, FMortonCode Code, FVector& OutLocation) const;
 	const FSVONNode& GetNode(const FSVONLink& Link) const;
-	const FSVONLeafNode& GetLeafNode(FNodeIndex Index) const;
+	/* The leaf of a layer 0 node with children */
+	const FSVONLeafNode& GetLeafNode(const FSVONNode& Node, uint8 ClearanceLevel = 0) const;
+
+	void GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors, uint8 ClearanceLevel = 0) const;
+	void GetNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors, uint8 ClearanceLevel = 0) const;
+
+	/* ESVONAreaFlags bits stamped on the link by modifier volumes. Only layer 0 nodes and their leaf voxels are ever tagged */
+	FORCEINLINE uint8 GetAreaFlags(const FSVONLink& Link) const { return Link.LayerIndex == 0 ? Blob.GetAreaFlags()[Link.NodeIndex] : 0; }
 
-	void GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors) const;
-	void GetNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors) const;
+	/* Levels baked into the current data, at least 1. The octree is built for the largest, only the leaf bitboards differ */
+	int32 GetNumClearanceLevels() const { return Blob.GetNumClearanceLevels(); }
+
+	/* Smallest baked clearance level that fits an agent of this radius, INDEX_NONE if the agent is bigger than all of them.
+	   Data without radii has the one level, which every agent gets */
+	int32 GetClearanceLevel(float AgentRadius) const;
 
 	virtual void Serialize(FArchive& Ar) override;
 
+	/* Dense numbering of our nodes and leaf voxels, for data kept per link */
+	const FSVONLinkIndex& GetLinkIndex() const { return LinkIndex; }
+
+	/* Empty unless bBuildConnectivity is set, in which case every query treats links as connected */
+	const FSVONConnectivity& GetConnectivity() const { return Connectivity; }
+
+	/* Empty unless bBuildDistanceField is set, in which case every link reads as far from obstacles */
+	const FSVONDistanceField& GetDistanceField() const { return DistanceField; }
+
+	/* Flow field towards the goal, shared by every agent heading there with the same filter. Created unbuilt on first use, game thread only */
+	TSharedPtr<FSVONFlowField> GetFlowField(const FSVONLink& Goal, uint8 ClearanceLevel = 0, const FSVONAreaFilter& AreaFilter = FSVONAreaFilter());
+
+	/* Ways into the neighboring volumes, maintained by FSVONVolumeRegistry as volumes stream in and out */
+	const TArray<FSVONPortal>& GetPortals() const { return Portals; }
+	void AddPortal(const FSVONPortal& Portal) { Portals.Add(Portal); }
+	void RemovePortalsTo(const ASVONVolumeActor* Neighbor);
+	void ClearPortals() { Portals.Empty(); }
+
+	/* The cache is internally synchronized, so it's handed out mutable to path finders on any thread. bEnablePathCache and
+	   PathCacheSize are applied to it here, so setting them at runtime takes effect on the next query */
+	FSVONPathCache& GetPathCache() const;
+	FSVONPathCacheStats GetPathCacheStats() const { return GetPathCache().GetStats(); }
+
+	/* Drop every cached path, or only those passing through a region that's been rebuilt */
+	void InvalidatePathCache() { PathCache.Invalidate(); }
+	void InvalidatePathCache(const FBox& Region) { PathCache.Invalidate(Region); }
+
+	/* Counts the async searches queued against us and not finished yet, tiles aren't destroyed while there are any. Begin
+	   on the game thread as the task is made, end from the worker once it's done with us */
+	void BeginAsyncSearch() { NumAsyncSearches.Increment(); }
+	void EndAsyncSearch() { NumAsyncSearches.Decrement(); }
+	bool HasAsyncSearches() const { return NumAsyncSearches.GetValue() > 0; }
+
 private:
+	// Link layer indices are 4 bits wide, so a volume can never have more layers than this
+	static const int32 MaxLayers = 16;
+
 	bool bIsReadyForNavigation = false;
 
 	FVector Origin;
 	FVector Extent;
 	FVector DebugLocation;
 
+	// Only valid for tiles, see SetTileBounds
+	FBox TileBounds = FBox(ForceInit);
+
+	// Built into during generation only, then flattened into Blob and emptied
 	FSVONData Data;
+	FSVONDataBlob Blob;
+	uint32 DataId;
+
+	// Per-layer constants, rebuilt whenever VoxelPower or the bounds change
+	FSVONLayerGeometry LayerGeometry[MaxLayers];
+
+	// Connectivity and the distance field read their baked arrays out of the blob through this
+	FSVONLinkIndex LinkIndex;
+	FSVONConnectivity Connectivity;
+	FSVONDistanceField DistanceField;
+
+	mutable FSVONPathCache PathCache;
+
+	FThreadSafeCounter NumAsyncSearches;
+
+	TArray<FSVONPortal> Portals;
+
+	// Keyed by goal, clearance level and area filter hash
+	TMap<TTuple<FSVONLink, uint8, uint32>, TSharedPtr<FSVONFlowField>> FlowFields;
+	uint64 FlowFieldClock = 0;
+
+	// What we last added to the volume memory stat. The path cache reports its own
+	SIZE_T ReportedBytes = 0;
 
 	// First pass rasterize results
 	TArray<TSet<FMortonCode>> BlockedIndices;
 
+	// Bounds and flags of the modifier volumes overlapping us, gathered for the duration of a generate
+	TArray<TPair<FBox, uint8>> AreaModifiers;
+
 	TArray<FSVONNode>& GetLayer(FLayerIndex Layer);
 
 	void SetupVolume();
+	void UpdateLayerGeometry();
+	/* Builds the connectivity and distance field for a freshly generated octree and bakes them into the blob */
+	void UpdateDerivedData();
+
+	/* Points the connectivity and distance field at what's baked into the blob. Builds the link index unless one is given */
+	void LoadDerivedData(FSVONLinkIndex* InLinkIndex = nullptr);
+
+	/* Everything but the path cache, which is filled from other threads */
+	SIZE_T GetDataSize() const;
+
+	/* Moves the volume memory stat to our current size, after the data or the flow fields change */
+	void UpdateMemoryStat();
+
+	void GatherAreaModifiers();
+
+	/* Compresses the blob and checks it decompresses to the same data. False if it doesn't, so it's saved raw instead */
+	bool CompressBlob(TArray<uint8>& OutBytes) const;
+	void DecompressBlob(const TArray<uint8>& Bytes);
+
+	/* Flags of every modifier overlapping the box, touching faces don't count */
+	uint8 GetAreaFlagsInBox(const FBox& Box) const;
 
 	bool FirstPassRasterize();
 	void RasterizeLayer(FLayerIndex Layer);
 
-	int32 GetNodesInLayer(FLayerIndex Layer);
-	int32 GetNodesPerSide(FLayerIndex Layer);
+	FORCEINLINE int32 GetNodesInLayer(FLayerIndex Layer) const { return GetLayerGeometry(Layer).NodeCount; }
+	FORCEINLINE int32 GetNodesPerSide(FLayerIndex Layer) const { return GetLayerGeometry(Layer).NodesPerSide; }
 
-	bool GetIndexForCode(FLayerIndex Layer, FMortonCode Code, FNodeIndex& OutIndex) const;
+	bool GetIndexForCode(FLayerIndex Layer, FMortonCode Code, FNodeIndex& OutIndex);
 
     void BuildNeighborLinks(FLayerIndex Layer);
 	bool FindLinkInDirection(FLayerIndex Layer, const FNodeIndex NodeIndex, uint8 Direction, FSVONLink& OutLinkToUpdate, FVector& OutStartLocationForDebug);
-	void RasterizeLeafNode(FVector& Origin, FNodeIndex LeafIndex);
+	void RasterizeLeafNode(const FVector& Origin, TArray<FSVONLeafNode>& OutLeaves);
 	bool SetNeighbor(const FLayerIndex Layer, const FNodeIndex ArrayIndex, const EDirection Direction);
 
 	bool IsAnyMemberBlocked(FLayerIndex Layer, FMortonCode Code);
 
-	bool IsBlocked(const FVector& Location, const float Size) const;
+	bool IsBlocked(const FVector& Location, const float Size, const float AgentClearance) const;
+
+	// Clearance the octree itself is rasterized with, the largest baked level
+	float GetMaxClearance() const { return Data.ClearanceRadii.Num() > 0 ? Data.ClearanceRadii.Last() : Clearance; }
 
 	bool IsInDebugRange(const FVector& Location) const;
 };
@@ -163,7 +163,8 @@ void UAITask_SVONMoveTo::PerformMove()
 	// If we're ready to path, then request the path
 	if (Result.Code == ESVONPathfindingRequestResult::SPRR_ReadyToPath)
 	{
-		bUseAsyncPathFinding ? RequestPathAsync() : RequestPath();
+		// Repairs are cheap and the incremental search lives on the game thread, so they don't go async
+		bUseAsyncPathFinding && !ShouldRepairPath() ? RequestPathAsync() : RequestPath();
 
 		switch (Result.Code)
 		{
@@ -178,9 +179,8 @@ void UAITask_SVONMoveTo::PerformMove()
 			RequestMove(); // Start the move
 			break;
 
-		case ESVONPathfindingRequestResult::SPRR_Deferred: // Async
+		case ESVONPathfindingRequestResult::SPRR_Deferred: // Async, RequestPathAsync has already reset the flag and it may be set already by a cache hit
 			MoveRequestID = Result.MoveId;
-			AsyncTaskComplete = false;
 			break;
 
 		default:
@@ -305,12 +305,22 @@ void UAITask_SVONMoveTo::RequestPath()
 	UE_LOG(UESVON, Error, TEXT("SVONMoveTo: Requesting Synchronous pathfinding!"));
 #endif
 
-	if (NavigationComponent->FindPathImmediate(NavigationComponent->GetPawnLocation(), MoveRequest.IsMoveToActorRequest() ? MoveRequest.GetGoalActor()->GetActorLocation() : MoveRequest.GetGoalLocation(), &SVONPath))
+	const auto StartLocation = NavigationComponent->GetPawnLocation();
+	const auto GoalLocation = MoveRequest.IsMoveToActorRequest() ? MoveRequest.GetGoalActor()->GetActorLocation() : MoveRequest.GetGoalLocation();
+
+	if (ShouldRepairPath()
+		? NavigationComponent->FindPathIncremental(StartLocation, GoalLocation, &SVONPath, MoveRequest.GetNavigationFilter())
+		: NavigationComponent->FindPathImmediate(StartLocation, GoalLocation, &SVONPath, MoveRequest.GetNavigationFilter()))
 		Result.Code = ESVONPathfindingRequestResult::SPRR_Success;
 
 	return;
 }
 
+bool UAITask_SVONMoveTo::ShouldRepairPath() const
+{
+	return bUseContinuousTracking && NavigationComponent && NavigationComponent->bUseIncrementalPlanner;
+}
+
 void UAITask_SVONMoveTo::RequestPathAsync()
 {
 	Result.Code = ESVONPathfindingRequestResult::SPRR_Failed;
@@ -323,7 +333,7 @@ void UAITask_SVONMoveTo::RequestPathAsync()
 	AsyncTaskComplete = false;
 
 	// Request the async path
-	SVONNavigationComponent->FindPathAsync(NavigationComponent->GetPawnLocation(), MoveRequest.IsMoveToActorRequest() ? MoveRequest.GetGoalActor()->GetActorLocation() : MoveRequest.GetGoalLocation(), AsyncTaskComplete, &SVONPath);
+	SVONNavigationComponent->FindPathAsync(NavigationComponent->GetPawnLocation(), MoveRequest.IsMoveToActorRequest() ? MoveRequest.GetGoalActor()->GetActorLocation() : MoveRequest.GetGoalLocation(), AsyncTaskComplete, &SVONPath, MoveRequest.GetNavigationFilter());
 
 	Result.Code = ESVONPathfindingRequestResult::SPRR_Deferred;
 }
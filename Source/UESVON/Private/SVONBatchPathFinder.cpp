@@ -0,0 +1,88 @@
+#include "SVONBatchPathFinder.h"
+
+#include "SVONMediator.h"
+#include "SVONVolumeActor.h"
+#include "libmorton/morton.h"
+
+int32 FSVONPathBatch::Add(const FVector& StartLocation, const FVector& TargetLocation)
+{
+	TargetLocations.Add(TargetLocation);
+	return StartLocations.Add(StartLocation);
+}
+
+TArrayView<const FSVONPathPoint> FSVONPathBatch::GetPath(int32 QueryIndex) const
+{
+	if (!Spans.IsValidIndex(QueryIndex) || Spans[QueryIndex].NumPoints == 0)
+		return TArrayView<const FSVONPathPoint>();
+
+	return TArrayView<const FSVONPathPoint>(Points.GetData() + Spans[QueryIndex].FirstPoint, Spans[QueryIndex].NumPoints);
+}
+
+void FSVONPathBatch::Reset()
+{
+	StartLocations.Reset();
+	TargetLocations.Reset();
+	Spans.Reset();
+	Points.Reset();
+	bIsComplete = false;
+}
+
+void FSVONBatchPathFinder::Solve(FSVONPathBatch& Batch)
+{
+	struct FPendingQuery
+	{
+		FMortonCode SortKey;
+		int32 Index;
+		FSVONLink Start;
+		FSVONLink Target;
+		FVector TargetLocation;
+	};
+
+	Batch.Spans.Reset();
+	Batch.Spans.SetNum(Batch.Num());
+	Batch.Points.Reset();
+
+	// Queries with an end off the graph, or ends in regions that don't connect, fail without a search
+	const auto& Connectivity = Volume.GetConnectivity();
+	TArray<FPendingQuery> Pending;
+	Pending.Reserve(Batch.Num());
+	for (auto i = 0; i < Batch.Num(); i++)
+	{
+		// Like a single query, paths start where asked but end at the navigable point nearest the target
+		FPendingQuery Query;
+		Query.Index = i;
+		FVector SnappedStartLocation;
+		if (!FSVONMediator::FindNearestNavigableLink(Batch.StartLocations[i], Volume, Batch.NearestLinkSearchRadius, Query.Start, SnappedStartLocation, Settings.ClearanceLevel)
+			|| !FSVONMediator::FindNearestNavigableLink(Batch.TargetLocations[i], Volume, Batch.NearestLinkSearchRadius, Query.Target, Query.TargetLocation, Settings.ClearanceLevel)
+			|| !Connectivity.AreConnected(Query.Start, Query.Target))
+			continue;
+
+		FIntVector Position;
+		Volume.GetLinkGridPosition(Query.Start, Position);
+		Query.SortKey = morton3D_64_encode(Position.X, Position.Y, Position.Z);
+		Pending.Add(Query);
+	}
+
+	Pending.Sort([](const FPendingQuery& A, const FPendingQuery& B) { return A.SortKey < B.SortKey; });
+
+	// One path for the whole batch, each search fills it and it's copied out into the packed points
+	FSVONNavPathSharedPtr Path = MakeShareable(new FSVONNavigationPath());
+	auto& PathPoints = Path->GetPathPoints();
+
+	for (const auto& Query : Pending)
+	{
+		PathPoints.Reset();
+
+		const auto& StartLocation = Batch.StartLocations[Query.Index];
+		if (!PathFinder.FindCachedPath(Query.Start, Query.Target, StartLocation, Query.TargetLocation, &Path)
+			&& !PathFinder.FindPath(Query.Start, Query.Target, StartLocation, Query.TargetLocation, &Path))
+			continue;
+
+		auto& Span = Batch.Spans[Query.Index];
+		Span.FirstPoint = Batch.Points.Num();
+		Span.NumPoints = PathPoints.Num();
+		Span.bSucceeded = true;
+
+		Batch.Points.Append(PathPoints);
+	}
+}
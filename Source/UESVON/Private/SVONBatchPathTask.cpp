@@ -0,0 +1,15 @@
+#include "SVONBatchPathTask.h"
+
+#include "SVONWorkerPool.h"
+
+void FSVONBatchPathTask::DoWork()
+{
+	FSVONBatchPathFinder PathFinder(World, Volume, Settings);
+
+	auto& Scratch = FSVONWorkerContext::Get().Scratch;
+	PathFinder.SwapScratch(Scratch);
+	PathFinder.Solve(*Batch);
+	PathFinder.SwapScratch(Scratch);
+
+	Batch->bIsComplete = true;
+}
@@ -0,0 +1,222 @@
+#include "SVONConnectivity.h"
+
+#include "SVONDataBlob.h"
+#include "SVONLinkIndex.h"
+#include "SVONVolumeActor.h"
+
+const int32 FSVONConnectivity::InvalidComponent;
+
+namespace
+{
+	int32 FindRoot(TArray<int32>& Parents, int32 Element)
+	{
+		while (Parents[Element] != Element)
+		{
+			// Path halving keeps the trees flat without recursion
+			Parents[Element] = Parents[Parents[Element]];
+			Element = Parents[Element];
+		}
+
+		return Element;
+	}
+
+	void Union(TArray<int32>& Parents, int32 A, int32 B)
+	{
+		A = FindRoot(Parents, A);
+		B = FindRoot(Parents, B);
+
+		if (A != B)
+			Parents[FMath::Max(A, B)] = FMath::Min(A, B);
+	}
+}
+
+void FSVONConnectivity::Reset()
+{
+	Index = nullptr;
+	NodeComponents = TArrayView<const int32>();
+	LeafVoxelComponents = TArrayView<const int32>();
+	NumComponents = 0;
+}
+
+void FSVONConnectivity::Load(const FSVONDataBlob& Blob, const FSVONLinkIndex& InIndex)
+{
+	Reset();
+
+	if (Blob.GetNodeComponents().Num() != InIndex.GetNumNodes() || Blob.GetNodeComponents().Num() == 0 || Blob.GetLeafVoxelComponents().Num() % 64 != 0)
+		return;
+
+	Index = &InIndex;
+	NodeComponents = Blob.GetNodeComponents();
+	LeafVoxelComponents = Blob.GetLeafVoxelComponents();
+	NumComponents = Blob.GetNumComponents();
+}
+
+void FSVONConnectivity::Build(const ASVONVolumeActor& Volume, const FSVONLinkIndex& Index, FSVONDerivedData& OutData)
+{
+	OutData.NodeComponents.Empty();
+	OutData.LeafVoxelComponents.Empty();
+	OutData.NumComponents = 0;
+
+	const int32 NumLayers = Volume.GetNumLayers();
+	if (NumLayers == 0)
+		return;
+
+	const auto NumElements = Index.Num();
+
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(NumElements);
+	for (auto i = 0; i < NumElements; i++)
+		Parents[i] = i;
+
+	TBitArray<> IsFree(false, NumElements);
+	TBitArray<> IsExpanded(false, NumElements);
+
+	// Seed with every free node and leaf voxel
+	TArray<FSVONLink> WorkingSet;
+	for (auto LayerIndex = 0; LayerIndex < NumLayers; LayerIndex++)
+	{
+		const auto Layer = Volume.GetLayer(LayerIndex);
+		for (auto i = 0; i < Layer.Num(); i++)
+		{
+			const auto& Node = Layer[i];
+			if (!Node.HasChildren())
+			{
+				WorkingSet.Emplace(LayerIndex, i, 0);
+				IsFree[Index.GetIndex(WorkingSet.Last())] = true;
+			}
+			else if (LayerIndex == 0)
+			{
+				const auto& Leaf = Volume.GetLeafNode(Node);
+				for (auto SubNodeIndex = 0; SubNodeIndex < 64; SubNodeIndex++)
+				{
+					if (Leaf.GetNode(SubNodeIndex))
+						continue;
+
+					WorkingSet.Emplace(0, i, SubNodeIndex);
+					IsFree[Index.GetIndex(WorkingSet.Last())] = true;
+				}
+			}
+		}
+	}
+
+	// Expand exactly as the path finder would. Any link it can step onto is expanded too, even if it isn't one of our
+	// free seeds, so every edge A* could follow is joined and we never report a reachable pair as unreachable
+	TArray<FSVONLink> Neighbors;
+	while (WorkingSet.Num() > 0)
+	{
+		const auto Link = WorkingSet.Pop(false);
+		const auto Element = Index.GetIndex(Link);
+		if (IsExpanded[Element])
+			continue;
+
+		IsExpanded[Element] = true;
+
+		Neighbors.Reset();
+		if (Link.LayerIndex == 0 && Volume.GetNode(Link).HasChildren())
+			Volume.GetLeafNeighbors(Link, Neighbors);
+		else
+			Volume.GetNeighbors(Link, Neighbors);
+
+		for (const auto& Neighbor : Neighbors)
+		{
+			if (!Index.IsKnownLink(Neighbor))
+				continue;
+
+			const auto NeighborElement = Index.GetIndex(Neighbor);
+			Union(Parents, Element, NeighborElement);
+
+			if (!IsExpanded[NeighborElement])
+				WorkingSet.Add(Neighbor);
+		}
+	}
+
+	// Number the roots of the free elements
+	TMap<int32, int32> RootLabels;
+	auto GetLabel = [&](int32 Element)
+	{
+		if (!IsFree[Element])
+			return InvalidComponent;
+
+		const auto Root = FindRoot(Parents, Element);
+		if (const auto Label = RootLabels.Find(Root))
+			return *Label;
+
+		return RootLabels.Add(Root, RootLabels.Num());
+	};
+
+	auto& NodeComponents = OutData.NodeComponents;
+	auto& LeafVoxelComponents = OutData.LeafVoxelComponents;
+	NodeComponents.Init(InvalidComponent, Index.GetNumNodes());
+
+	for (auto LayerIndex = 0; LayerIndex < NumLayers; LayerIndex++)
+	{
+		const auto Layer = Volume.GetLayer(LayerIndex);
+		for (auto i = 0; i < Layer.Num(); i++)
+		{
+			auto& Component = NodeComponents[Index.GetNodeIndex(LayerIndex, i)];
+			if (!Layer[i].HasChildren())
+			{
+				Component = GetLabel(Index.GetNodeIndex(LayerIndex, i));
+				continue;
+			}
+
+			if (LayerIndex > 0)
+				continue;
+
+			// A leaf whose free voxels are all in one component only needs the one label
+			int32 VoxelLabels[64];
+			auto LeafLabel = InvalidComponent;
+			auto bIsSplit = false;
+			for (auto SubNodeIndex = 0; SubNodeIndex < 64; SubNodeIndex++)
+			{
+				VoxelLabels[SubNodeIndex] = GetLabel(Index.GetIndex(FSVONLink(0, i, SubNodeIndex)));
+				if (VoxelLabels[SubNodeIndex] == InvalidComponent)
+					continue;
+
+				if (LeafLabel == InvalidComponent)
+					LeafLabel = VoxelLabels[SubNodeIndex];
+				else if (LeafLabel != VoxelLabels[SubNodeIndex])
+					bIsSplit = true;
+			}
+
+			if (bIsSplit)
+			{
+				Component = -(LeafVoxelComponents.Num() / 64) - 2;
+				LeafVoxelComponents.Append(VoxelLabels, 64);
+			}
+			else
+				Component = LeafLabel;
+		}
+	}
+
+	OutData.NumComponents = RootLabels.Num();
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Connectivity : %d components, %d split leaves"), OutData.NumComponents, LeafVoxelComponents.Num() / 64);
+#endif
+}
+
+int32 FSVONConnectivity::GetComponent(const FSVONLink& Link) const
+{
+	if (!Index || !Index->IsKnownLink(Link))
+		return InvalidComponent;
+
+	const auto Value = NodeComponents[Index->GetNodeIndex(Link.LayerIndex, Link.NodeIndex)];
+	if (Value >= InvalidComponent)
+		return Value;
+
+	// Baked data, so don't trust the leaf index blindly
+	const auto VoxelIndex = (-Value - 2) * 64 + Link.SubNodeIndex;
+	return LeafVoxelComponents.IsValidIndex(VoxelIndex) ? LeafVoxelComponents[VoxelIndex] : InvalidComponent;
+}
+
+bool FSVONConnectivity::AreConnected(const FSVONLink& A, const FSVONLink& B) const
+{
+	const auto ComponentA = GetComponent(A);
+	const auto ComponentB = GetComponent(B);
+
+	if (ComponentA == InvalidComponent || ComponentB == InvalidComponent)
+		return true;
+
+	return ComponentA == ComponentB;
+}
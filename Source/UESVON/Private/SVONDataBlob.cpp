@@ -0,0 +1,463 @@
+#include "SVONDataBlob.h"
+
+#include "UESVON.h"
+#include "SVONStats.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+const int32 FSVONDataBlob::Alignment;
+const uint32 FSVONDataBlob::BlobMagic;
+const uint32 FSVONDataBlob::BlobVersion;
+
+namespace
+{
+	// Written as a whole word, so it reads back differently on a machine of the other byte order
+	const uint32 NativeByteOrder = 0x01020304;
+
+	const int32 RadiiSection = 0;
+	const int32 AreaFlagsSection = 1;
+	const int32 FirstLayerSection = 2;
+
+	// After the leaves, relative to the first derived section
+	const int32 NodeComponentsSection = 0;
+	const int32 LeafVoxelComponentsSection = 1;
+	const int32 NodeDistancesSection = 2;
+	const int32 LeafVoxelDistancesSection = 3;
+	const int32 NumDerivedSections = 4;
+
+	const SIZE_T DerivedElementSizes[NumDerivedSections] = { sizeof(int32), sizeof(int32), sizeof(uint8), sizeof(uint8) };
+}
+
+FSVONDataBlob::FSVONDataBlob()
+	: Base(nullptr),
+	Size(0)
+{
+}
+
+FSVONDataBlob::~FSVONDataBlob()
+{
+	Reset();
+}
+
+FSVONDataBlob::FSVONDataBlob(FSVONDataBlob&& Other)
+	: Base(nullptr),
+	Size(0)
+{
+	*this = MoveTemp(Other);
+}
+
+FSVONDataBlob& FSVONDataBlob::operator=(FSVONDataBlob&& Other)
+{
+	if (this != &Other)
+	{
+		Reset();
+
+		// Moving either storage keeps its address, so Base stays valid
+		Bytes = MoveTemp(Other.Bytes);
+		MappedFile = MoveTemp(Other.MappedFile);
+		MappedRegion = MoveTemp(Other.MappedRegion);
+		Base = Other.Base;
+		Size = Other.Size;
+
+		Other.Base = nullptr;
+		Other.Size = 0;
+	}
+
+	return *this;
+}
+
+void FSVONDataBlob::Reset()
+{
+	if (Base)
+	{
+		DEC_DWORD_STAT(STAT_SVONNumVolumeBlobs);
+	}
+
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Bytes.Empty();
+
+	Base = nullptr;
+	Size = 0;
+}
+
+void FSVONDataBlob::Build(const FSVONData& Data)
+{
+	TArray<int32> LayerSizes;
+	for (const auto& Layer : Data.Layers)
+		LayerSizes.Add(Layer.Num());
+
+	Allocate(LayerSizes, Data.LeafNodes.Num(), Data.ClearanceLeafNodes.Num() + 1, Data.ClearanceRadii.Num(), Data.AreaFlags.Num());
+
+	// Clearance levels are sized to match LeafNodes, anything past that is never indexed
+	auto Copy = [](auto Destination, const auto& Source)
+	{
+		const auto Count = FMath::Min(Destination.Num(), Source.Num());
+		if (Count > 0)
+			FMemory::Memcpy(Destination.GetData(), Source.GetData(), Count * Source.GetTypeSize());
+	};
+
+	Copy(GetMutableClearanceRadii(), Data.ClearanceRadii);
+	Copy(GetMutableAreaFlags(), Data.AreaFlags);
+
+	for (auto i = 0; i < Data.Layers.Num(); i++)
+		Copy(GetMutableLayer(i), Data.Layers[i]);
+
+	Copy(GetMutableLeafNodes(0), Data.LeafNodes);
+	for (auto i = 0; i < Data.ClearanceLeafNodes.Num(); i++)
+		Copy(GetMutableLeafNodes(i + 1), Data.ClearanceLeafNodes[i]);
+}
+
+void FSVONDataBlob::Allocate(const TArray<int32>& LayerSizes, int32 NumLeafNodes, int32 NumClearanceLevels, int32 NumClearanceRadii, int32 NumAreaFlags, const TArray<int32>& DerivedSizes)
+{
+	Reset();
+
+	const auto NumLayers = LayerSizes.Num();
+	const auto FirstDerivedSection = FirstLayerSection + NumLayers + NumClearanceLevels;
+	const auto NumSections = FirstDerivedSection + NumDerivedSections;
+
+	TArray<FSection> Sections;
+	Sections.SetNumZeroed(NumSections);
+
+	auto Offset = Align(static_cast<uint64>(sizeof(FHeader) + sizeof(FSection) * NumSections), static_cast<uint64>(Alignment));
+	auto AddSection = [&](int32 Index, int32 Count, SIZE_T ElementSize)
+	{
+		Sections[Index].Offset = Offset;
+		Sections[Index].Count = Count;
+		Offset = Align(Offset + static_cast<uint64>(Count) * ElementSize, static_cast<uint64>(Alignment));
+	};
+
+	AddSection(RadiiSection, NumClearanceRadii, sizeof(float));
+	AddSection(AreaFlagsSection, NumAreaFlags, sizeof(uint8));
+
+	for (auto i = 0; i < NumLayers; i++)
+		AddSection(FirstLayerSection + i, LayerSizes[i], sizeof(FSVONNode));
+
+	for (auto i = 0; i < NumClearanceLevels; i++)
+		AddSection(FirstLayerSection + NumLayers + i, NumLeafNodes, sizeof(FSVONLeafNode));
+
+	for (auto i = 0; i < NumDerivedSections; i++)
+		AddSection(FirstDerivedSection + i, DerivedSizes.IsValidIndex(i) ? DerivedSizes[i] : 0, DerivedElementSizes[i]);
+
+	// Zeroed, so padding is deterministic and the same data always bakes to the same bytes
+	Bytes.SetNumZeroed(static_cast<int32>(Offset));
+
+	FHeader Header;
+	Header.Magic = BlobMagic;
+	Header.Version = BlobVersion;
+	Header.ByteOrder = NativeByteOrder;
+	Header.NodeSize = sizeof(FSVONNode);
+	Header.LeafSize = sizeof(FSVONLeafNode);
+	Header.NumLayers = NumLayers;
+	Header.NumClearanceLevels = NumClearanceLevels;
+	Header.NumComponents = 0;
+	Header.Reserved = 0;
+	Header.Size = Offset;
+
+	FMemory::Memcpy(Bytes.GetData(), &Header, sizeof(FHeader));
+	FMemory::Memcpy(Bytes.GetData() + sizeof(FHeader), Sections.GetData(), sizeof(FSection) * NumSections);
+
+	Base = Bytes.GetData();
+	Size = Bytes.Num();
+
+	INC_DWORD_STAT(STAT_SVONNumVolumeBlobs);
+}
+
+void FSVONDataBlob::SetDerivedData(const FSVONDerivedData& Derived)
+{
+	if (IsEmpty())
+		return;
+
+	// The section table grows, so everything moves. Copy section by section out of the old buffer
+	FSVONDataBlob Octree(MoveTemp(*this));
+
+	TArray<int32> LayerSizes;
+	for (auto i = 0; i < Octree.GetNumLayers(); i++)
+		LayerSizes.Add(Octree.GetLayer(i).Num());
+
+	const TArray<int32> DerivedSizes = { Derived.NodeComponents.Num(), Derived.LeafVoxelComponents.Num(), Derived.NodeDistances.Num(), Derived.LeafVoxelDistances.Num() };
+	Allocate(LayerSizes, Octree.GetLeafNodes(0).Num(), Octree.GetNumClearanceLevels(), Octree.GetClearanceRadii().Num(), Octree.GetAreaFlags().Num(), DerivedSizes);
+
+	auto Copy = [](auto Destination, const auto& Source)
+	{
+		if (Source.Num() > 0)
+			FMemory::Memcpy(Destination.GetData(), Source.GetData(), Source.Num() * sizeof(Source[0]));
+	};
+
+	Copy(GetMutableClearanceRadii(), Octree.GetClearanceRadii());
+	Copy(GetMutableAreaFlags(), Octree.GetAreaFlags());
+
+	for (auto i = 0; i < LayerSizes.Num(); i++)
+		Copy(GetMutableLayer(i), Octree.GetLayer(i));
+
+	for (auto i = 0; i < Octree.GetNumClearanceLevels(); i++)
+		Copy(GetMutableLeafNodes(i), Octree.GetLeafNodes(i));
+
+	Copy(GetMutableNodeComponents(), Derived.NodeComponents);
+	Copy(GetMutableLeafVoxelComponents(), Derived.LeafVoxelComponents);
+	Copy(GetMutableNodeDistances(), Derived.NodeDistances);
+	Copy(GetMutableLeafVoxelDistances(), Derived.LeafVoxelDistances);
+	SetNumComponents(Derived.NumComponents);
+}
+
+bool FSVONDataBlob::Validate(const uint8* InBase, int64 InSize)
+{
+	Base = nullptr;
+	Size = 0;
+
+	auto bIsValid = InBase && IsAligned(InBase, Alignment) && InSize >= static_cast<int64>(sizeof(FHeader));
+
+	const auto Header = reinterpret_cast<const FHeader*>(InBase);
+	bIsValid = bIsValid
+		&& Header->Magic == BlobMagic
+		&& Header->Version == BlobVersion
+		&& Header->ByteOrder == NativeByteOrder
+		&& Header->NodeSize == sizeof(FSVONNode)
+		&& Header->LeafSize == sizeof(FSVONLeafNode)
+		&& Header->NumLayers <= 16
+		&& Header->NumClearanceLevels >= 1 && Header->NumClearanceLevels <= MAX_uint8
+		&& Header->Size <= static_cast<uint64>(InSize);
+
+	if (bIsValid)
+	{
+		const auto FirstDerivedSection = FirstLayerSection + Header->NumLayers + Header->NumClearanceLevels;
+		const auto NumSections = FirstDerivedSection + NumDerivedSections;
+		const auto Sections = reinterpret_cast<const FSection*>(InBase + sizeof(FHeader));
+		bIsValid = sizeof(FHeader) + sizeof(FSection) * NumSections <= Header->Size;
+
+		for (uint32 i = 0; bIsValid && i < NumSections; i++)
+		{
+			SIZE_T ElementSize = sizeof(FSVONLeafNode);
+			if (i == RadiiSection)
+				ElementSize = sizeof(float);
+			else if (i == AreaFlagsSection)
+				ElementSize = sizeof(uint8);
+			else if (i < FirstLayerSection + Header->NumLayers)
+				ElementSize = sizeof(FSVONNode);
+			else if (i >= FirstDerivedSection)
+				ElementSize = DerivedElementSizes[i - FirstDerivedSection];
+
+			const auto& Section = Sections[i];
+			bIsValid = Section.Offset % Alignment == 0
+				&& Section.Count <= static_cast<uint64>(MAX_int32)
+				&& Section.Offset + Section.Count * ElementSize <= Header->Size;
+		}
+	}
+
+	if (!bIsValid)
+	{
+		Reset();
+		return false;
+	}
+
+	Base = InBase;
+	Size = InSize;
+
+	INC_DWORD_STAT(STAT_SVONNumVolumeBlobs);
+
+	return true;
+}
+
+bool FSVONDataBlob::LoadFile(const FString& Path)
+{
+	Reset();
+
+	// Mapped pages are only read as they're touched, and the OS can drop them again under memory pressure
+	TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (Handle.IsValid())
+	{
+		TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+		if (Region.IsValid())
+		{
+			if (!Validate(Region->GetMappedPtr(), Region->GetMappedSize()))
+				return false;
+
+			MappedFile = MoveTemp(Handle);
+			MappedRegion = MoveTemp(Region);
+			return true;
+		}
+	}
+
+	// No mapping on this platform, read it all in one go instead
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+	if (!Reader.IsValid())
+		return false;
+
+	const auto FileSize = Reader->TotalSize();
+	if (FileSize <= 0 || FileSize > MAX_int32)
+		return false;
+
+	Bytes.SetNumUninitialized(static_cast<int32>(FileSize));
+	Reader->Serialize(Bytes.GetData(), FileSize);
+
+	if (!Reader->Close())
+	{
+		Reset();
+		return false;
+	}
+
+	return Validate(Bytes.GetData(), Bytes.Num());
+}
+
+bool FSVONDataBlob::SaveFile(const FString& Path) const
+{
+	if (!Base)
+		return false;
+
+	return FFileHelper::SaveArrayToFile(TArrayView<const uint8>(Base, static_cast<int32>(Size)), *Path);
+}
+
+const FSVONDataBlob::FSection& FSVONDataBlob::GetSection(int32 Index) const
+{
+	return reinterpret_cast<const FSection*>(Base + sizeof(FHeader))[Index];
+}
+
+int32 FSVONDataBlob::GetNumLayers() const
+{
+	return Base ? static_cast<int32>(GetHeader()->NumLayers) : 0;
+}
+
+TArrayView<const FSVONNode> FSVONDataBlob::GetLayer(int32 Layer) const
+{
+	check(Layer >= 0 && Layer < GetNumLayers());
+	return GetSectionView<FSVONNode>(FirstLayerSection + Layer);
+}
+
+int32 FSVONDataBlob::GetNumClearanceLevels() const
+{
+	return Base ? static_cast<int32>(GetHeader()->NumClearanceLevels) : 1;
+}
+
+TArrayView<const FSVONLeafNode> FSVONDataBlob::GetLeafNodes(int32 ClearanceLevel) const
+{
+	if (!Base)
+		return TArrayView<const FSVONLeafNode>();
+
+	const auto Level = FMath::Clamp(ClearanceLevel, 0, GetNumClearanceLevels() - 1);
+	return GetSectionView<FSVONLeafNode>(FirstLayerSection + GetNumLayers() + Level);
+}
+
+TArrayView<const float> FSVONDataBlob::GetClearanceRadii() const
+{
+	return Base ? GetSectionView<float>(RadiiSection) : TArrayView<const float>();
+}
+
+TArrayView<const uint8> FSVONDataBlob::GetAreaFlags() const
+{
+	return Base ? GetSectionView<uint8>(AreaFlagsSection) : TArrayView<const uint8>();
+}
+
+TArrayView<const int32> FSVONDataBlob::GetNodeComponents() const
+{
+	return Base ? GetSectionView<int32>(GetDerivedSection(NodeComponentsSection)) : TArrayView<const int32>();
+}
+
+TArrayView<const int32> FSVONDataBlob::GetLeafVoxelComponents() const
+{
+	return Base ? GetSectionView<int32>(GetDerivedSection(LeafVoxelComponentsSection)) : TArrayView<const int32>();
+}
+
+int32 FSVONDataBlob::GetNumComponents() const
+{
+	return Base ? static_cast<int32>(GetHeader()->NumComponents) : 0;
+}
+
+TArrayView<const uint8> FSVONDataBlob::GetNodeDistances() const
+{
+	return Base ? GetSectionView<uint8>(GetDerivedSection(NodeDistancesSection)) : TArrayView<const uint8>();
+}
+
+TArrayView<const uint8> FSVONDataBlob::GetLeafVoxelDistances() const
+{
+	return Base ? GetSectionView<uint8>(GetDerivedSection(LeafVoxelDistancesSection)) : TArrayView<const uint8>();
+}
+
+TArrayView<FSVONNode> FSVONDataBlob::GetMutableLayer(int32 Layer)
+{
+	check(Layer >= 0 && Layer < GetNumLayers());
+	return GetMutableSectionView<FSVONNode>(FirstLayerSection + Layer);
+}
+
+TArrayView<FSVONLeafNode> FSVONDataBlob::GetMutableLeafNodes(int32 ClearanceLevel)
+{
+	check(ClearanceLevel >= 0 && ClearanceLevel < GetNumClearanceLevels());
+	return GetMutableSectionView<FSVONLeafNode>(FirstLayerSection + GetNumLayers() + ClearanceLevel);
+}
+
+TArrayView<float> FSVONDataBlob::GetMutableClearanceRadii()
+{
+	return GetMutableSectionView<float>(RadiiSection);
+}
+
+TArrayView<uint8> FSVONDataBlob::GetMutableAreaFlags()
+{
+	return GetMutableSectionView<uint8>(AreaFlagsSection);
+}
+
+TArrayView<int32> FSVONDataBlob::GetMutableNodeComponents()
+{
+	return GetMutableSectionView<int32>(GetDerivedSection(NodeComponentsSection));
+}
+
+TArrayView<int32> FSVONDataBlob::GetMutableLeafVoxelComponents()
+{
+	return GetMutableSectionView<int32>(GetDerivedSection(LeafVoxelComponentsSection));
+}
+
+void FSVONDataBlob::SetNumComponents(int32 NumComponents)
+{
+	check(Base == Bytes.GetData());
+	reinterpret_cast<FHeader*>(Bytes.GetData())->NumComponents = static_cast<uint32>(FMath::Max(NumComponents, 0));
+}
+
+TArrayView<uint8> FSVONDataBlob::GetMutableNodeDistances()
+{
+	return GetMutableSectionView<uint8>(GetDerivedSection(NodeDistancesSection));
+}
+
+TArrayView<uint8> FSVONDataBlob::GetMutableLeafVoxelDistances()
+{
+	return GetMutableSectionView<uint8>(GetDerivedSection(LeafVoxelDistancesSection));
+}
+
+int32 FSVONDataBlob::GetDerivedSection(int32 Derived) const
+{
+	return FirstLayerSection + GetNumLayers() + GetNumClearanceLevels() + Derived;
+}
+
+FArchive& operator<<(FArchive& Ar, FSVONDataBlob& Blob)
+{
+	auto BlobSize = Blob.Size;
+	Ar << BlobSize;
+
+	if (Ar.IsLoading())
+	{
+		Blob.Reset();
+		if (BlobSize <= 0)
+			return Ar;
+
+		if (BlobSize > MAX_int32)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+
+		// One read into an aligned buffer, which the views then point straight into
+		Blob.Bytes.SetNumUninitialized(static_cast<int32>(BlobSize));
+		Ar.Serialize(Blob.Bytes.GetData(), BlobSize);
+
+		if (!Blob.Validate(Blob.Bytes.GetData(), Blob.Bytes.Num()))
+		{
+#if WITH_EDITOR
+			UE_LOG(UESVON, Warning, TEXT("Baked SVON data was written with a different layout, the volume needs rebuilding"));
+#endif
+		}
+	}
+	else if (BlobSize > 0)
+		Ar.Serialize(const_cast<uint8*>(Blob.Base), BlobSize);
+
+	return Ar;
+}
@@ -0,0 +1,623 @@
+#include "SVONDataCompression.h"
+
+#include "SVONDataBlob.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/Compression.h"
+
+namespace
+{
+	const uint32 CompressedMagic = 0x43564F53;
+	const uint32 CompressedVersion = 2;
+
+	// Connectivity and distance arrays, stored raw and left to the general purpose codec
+	const int32 NumDerivedStreams = 4;
+
+	const ECompressionFlags CompressionFlags = static_cast<ECompressionFlags>(COMPRESS_ZLIB | COMPRESS_BiasSpeed);
+
+	// Link tags are the layer index in the low nibble, with this set when a sub node index follows
+	const uint8 SubNodeFlag = 0x10;
+	const uint8 InvalidLayer = 15;
+
+	enum ELeafRun : uint8
+	{
+		LR_Empty = 0,
+		LR_Blocked = 1,
+		LR_Literal = 2
+	};
+
+	class FPackedWriter
+	{
+	public:
+		explicit FPackedWriter(TArray<uint8>& Bytes)
+			: Bytes(Bytes) { }
+
+		void WriteByte(uint8 Value) { Bytes.Add(Value); }
+
+		void WriteVarint(uint64 Value)
+		{
+			while (Value >= 0x80)
+			{
+				Bytes.Add(static_cast<uint8>(Value) | 0x80);
+				Value >>= 7;
+			}
+
+			Bytes.Add(static_cast<uint8>(Value));
+		}
+
+		// Zigzag, so small negative offsets stay as short as small positive ones
+		void WriteSigned(int64 Value) { WriteVarint((static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63)); }
+
+		void WriteRaw(const void* Data, int32 NumBytes) { Bytes.Append(static_cast<const uint8*>(Data), NumBytes); }
+
+	private:
+		TArray<uint8>& Bytes;
+	};
+
+	class FPackedReader
+	{
+	public:
+		FPackedReader(const uint8* Data, int32 Num)
+			: Data(Data),
+			Num(Num) { }
+
+		uint8 ReadByte()
+		{
+			if (Position >= Num)
+			{
+				bIsError = true;
+				return 0;
+			}
+
+			return Data[Position++];
+		}
+
+		uint64 ReadVarint()
+		{
+			uint64 Value = 0;
+			for (auto Shift = 0; Shift < 64 && !bIsError; Shift += 7)
+			{
+				const auto Byte = ReadByte();
+				Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+				if (!(Byte & 0x80))
+					return Value;
+			}
+
+			bIsError = true;
+			return 0;
+		}
+
+		int64 ReadSigned()
+		{
+			const auto Value = ReadVarint();
+			return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+		}
+
+		void ReadRaw(void* Out, int32 NumBytes)
+		{
+			if (NumBytes < 0 || NumBytes > Num - Position)
+			{
+				bIsError = true;
+				return;
+			}
+
+			FMemory::Memcpy(Out, Data + Position, NumBytes);
+			Position += NumBytes;
+		}
+
+		int32 GetPosition() const { return Position; }
+		bool IsAtEnd() const { return Position == Num; }
+
+		void SetError() { bIsError = true; }
+		bool IsError() const { return bIsError; }
+
+	private:
+		const uint8* Data;
+		int32 Num;
+		int32 Position = 0;
+		bool bIsError = false;
+	};
+
+	void WriteLink(FPackedWriter& Writer, const FSVONLink& Link, int64 Reference)
+	{
+		if (!Link.IsValid())
+		{
+			Writer.WriteByte(InvalidLayer);
+			return;
+		}
+
+		Writer.WriteByte(static_cast<uint8>(Link.LayerIndex | (Link.SubNodeIndex != 0 ? SubNodeFlag : 0)));
+		Writer.WriteSigned(static_cast<int64>(Link.NodeIndex) - Reference);
+
+		if (Link.SubNodeIndex != 0)
+			Writer.WriteByte(Link.SubNodeIndex);
+	}
+
+	FSVONLink ReadLink(FPackedReader& Reader, int64 Reference)
+	{
+		const auto Tag = Reader.ReadByte();
+		const auto Layer = Tag & 0x0F;
+		if (Layer == InvalidLayer)
+			return FSVONLink::GetInvalidLink();
+
+		// Node indices are 22 bits
+		const auto NodeIndex = Reference + Reader.ReadSigned();
+		if (NodeIndex < 0 || NodeIndex >= (1 << 22))
+		{
+			Reader.SetError();
+			return FSVONLink::GetInvalidLink();
+		}
+
+		const auto SubNodeIndex = (Tag & SubNodeFlag) ? Reader.ReadByte() & 0x3F : 0;
+		return FSVONLink(Layer, static_cast<uint32>(NodeIndex), SubNodeIndex);
+	}
+
+	// Each field is a plane of its own, so similar bytes sit together for the codec
+	void EncodeLayer(TArrayView<const FSVONNode> Layer, TArray<uint8>& OutBytes)
+	{
+		FPackedWriter Writer(OutBytes);
+
+		FMortonCode PreviousCode = 0;
+		for (const auto& Node : Layer)
+		{
+			// Nodes are in morton order, so these are small and positive
+			Writer.WriteVarint(Node.Code - PreviousCode);
+			PreviousCode = Node.Code;
+		}
+
+		// Runs of 8 siblings share a parent and children come in blocks of 8, so both chain well from the previous link
+		int64 PreviousParent = 0;
+		for (const auto& Node : Layer)
+		{
+			WriteLink(Writer, Node.Parent, PreviousParent);
+			if (Node.Parent.IsValid())
+				PreviousParent = Node.Parent.NodeIndex;
+		}
+
+		int64 PreviousChild = 0;
+		for (const auto& Node : Layer)
+		{
+			WriteLink(Writer, Node.FirstChild, PreviousChild);
+			if (Node.FirstChild.IsValid())
+				PreviousChild = Node.FirstChild.NodeIndex;
+		}
+
+		for (auto i = 0; i < Layer.Num(); i++)
+		{
+			for (auto Direction = 0; Direction < 6; Direction++)
+				WriteLink(Writer, Layer[i].Neighbors[Direction], i);
+		}
+	}
+
+	void DecodeLayer(FPackedReader& Reader, TArrayView<FSVONNode> OutLayer)
+	{
+		FMortonCode Code = 0;
+		for (auto& Node : OutLayer)
+		{
+			Code += Reader.ReadVarint();
+			Node.Code = Code;
+		}
+
+		int64 PreviousParent = 0;
+		for (auto& Node : OutLayer)
+		{
+			Node.Parent = ReadLink(Reader, PreviousParent);
+			if (Node.Parent.IsValid())
+				PreviousParent = Node.Parent.NodeIndex;
+		}
+
+		int64 PreviousChild = 0;
+		for (auto& Node : OutLayer)
+		{
+			Node.FirstChild = ReadLink(Reader, PreviousChild);
+			if (Node.FirstChild.IsValid())
+				PreviousChild = Node.FirstChild.NodeIndex;
+		}
+
+		for (auto i = 0; i < OutLayer.Num() && !Reader.IsError(); i++)
+		{
+			for (auto Direction = 0; Direction < 6; Direction++)
+				OutLayer[i].Neighbors[Direction] = ReadLink(Reader, i);
+		}
+	}
+
+	ELeafRun GetLeafRun(uint64 Word)
+	{
+		return Word == 0 ? LR_Empty : Word == MAX_uint64 ? LR_Blocked : LR_Literal;
+	}
+
+	// Runs of empty words, runs of fully blocked words, and runs of anything else stored as is
+	void EncodeLeaves(TArrayView<const FSVONLeafNode> Leaves, TArray<uint8>& OutBytes)
+	{
+		FPackedWriter Writer(OutBytes);
+
+		auto Start = 0;
+		while (Start < Leaves.Num())
+		{
+			const auto Run = GetLeafRun(Leaves[Start].VoxelGrid);
+
+			auto End = Start + 1;
+			while (End < Leaves.Num() && GetLeafRun(Leaves[End].VoxelGrid) == Run)
+				End++;
+
+			Writer.WriteVarint((static_cast<uint64>(End - Start) << 2) | Run);
+
+			if (Run == LR_Literal)
+			{
+				for (auto i = Start; i < End; i++)
+				{
+					const uint64 Word = Leaves[i].VoxelGrid;
+					Writer.WriteRaw(&Word, sizeof(Word));
+				}
+			}
+
+			Start = End;
+		}
+	}
+
+	void DecodeLeaves(FPackedReader& Reader, TArrayView<FSVONLeafNode> OutLeaves)
+	{
+		auto Start = 0;
+		while (Start < OutLeaves.Num() && !Reader.IsError())
+		{
+			const auto Control = Reader.ReadVarint();
+			const auto Run = static_cast<ELeafRun>(Control & 3);
+			const auto Count = Control >> 2;
+
+			if (Count == 0 || Count > static_cast<uint64>(OutLeaves.Num() - Start) || Run > LR_Literal)
+			{
+				Reader.SetError();
+				return;
+			}
+
+			for (auto i = Start; i < Start + static_cast<int32>(Count); i++)
+			{
+				uint64 Word = Run == LR_Blocked ? MAX_uint64 : 0;
+				if (Run == LR_Literal)
+					Reader.ReadRaw(&Word, sizeof(Word));
+
+				OutLeaves[i].VoxelGrid = Word;
+			}
+
+			Start += static_cast<int32>(Count);
+		}
+	}
+
+	// Streams that don't shrink are stored as is, which the reader tells from the sizes being equal
+	void CompressStream(const TArray<uint8>& Raw, TArray<uint8>& OutBytes)
+	{
+		auto CompressedSize = FCompression::CompressMemoryBound(CompressionFlags, Raw.Num());
+		OutBytes.SetNumUninitialized(CompressedSize);
+
+		if (Raw.Num() > 0
+			&& FCompression::CompressMemory(CompressionFlags, OutBytes.GetData(), CompressedSize, Raw.GetData(), Raw.Num())
+			&& CompressedSize < Raw.Num())
+			OutBytes.SetNum(CompressedSize, false);
+		else
+			OutBytes = Raw;
+	}
+
+	struct FStreamHeader
+	{
+		int32 RawSize;
+		int32 CompressedSize;
+		int32 Offset;
+	};
+
+	bool UncompressStream(const TArray<uint8>& Bytes, const FStreamHeader& Stream, TArray<uint8>& OutRaw)
+	{
+		OutRaw.SetNumUninitialized(Stream.RawSize);
+		if (Stream.CompressedSize == Stream.RawSize)
+		{
+			FMemory::Memcpy(OutRaw.GetData(), Bytes.GetData() + Stream.Offset, Stream.RawSize);
+			return true;
+		}
+
+		return FCompression::UncompressMemory(CompressionFlags, OutRaw.GetData(), Stream.RawSize, Bytes.GetData() + Stream.Offset, Stream.CompressedSize);
+	}
+}
+
+void FSVONDataCompression::Compress(const FSVONDataBlob& Blob, TArray<uint8>& OutBytes)
+{
+	const auto NumLayers = Blob.GetNumLayers();
+	const auto NumClearanceLevels = Blob.GetNumClearanceLevels();
+	const auto NumStreams = 1 + NumLayers + NumClearanceLevels + NumDerivedStreams;
+	const auto FirstDerivedStream = 1 + NumLayers + NumClearanceLevels;
+
+	const TArrayView<const uint8> Derived[NumDerivedStreams] =
+	{
+		TArrayView<const uint8>(reinterpret_cast<const uint8*>(Blob.GetNodeComponents().GetData()), static_cast<int32>(Blob.GetNodeComponents().Num() * sizeof(int32))),
+		TArrayView<const uint8>(reinterpret_cast<const uint8*>(Blob.GetLeafVoxelComponents().GetData()), static_cast<int32>(Blob.GetLeafVoxelComponents().Num() * sizeof(int32))),
+		Blob.GetNodeDistances(),
+		Blob.GetLeafVoxelDistances()
+	};
+
+	TArray<TArray<uint8>> RawStreams;
+	RawStreams.SetNum(NumStreams);
+
+	// Counts first, so the reader can size the whole blob before any other stream is decoded
+	{
+		FPackedWriter Writer(RawStreams[0]);
+		Writer.WriteVarint(NumLayers);
+		for (auto i = 0; i < NumLayers; i++)
+			Writer.WriteVarint(Blob.GetLayer(i).Num());
+
+		Writer.WriteVarint(Blob.GetLeafNodes(0).Num());
+		Writer.WriteVarint(NumClearanceLevels);
+
+		const auto Radii = Blob.GetClearanceRadii();
+		Writer.WriteVarint(Radii.Num());
+		Writer.WriteRaw(Radii.GetData(), Radii.Num() * sizeof(float));
+
+		const auto AreaFlags = Blob.GetAreaFlags();
+		Writer.WriteVarint(AreaFlags.Num());
+		Writer.WriteRaw(AreaFlags.GetData(), AreaFlags.Num());
+
+		Writer.WriteVarint(Blob.GetNodeComponents().Num());
+		Writer.WriteVarint(Blob.GetLeafVoxelComponents().Num());
+		Writer.WriteVarint(Blob.GetNodeDistances().Num());
+		Writer.WriteVarint(Blob.GetLeafVoxelDistances().Num());
+		Writer.WriteVarint(Blob.GetNumComponents());
+	}
+
+	TArray<TArray<uint8>> CompressedStreams;
+	CompressedStreams.SetNum(NumStreams);
+
+	ParallelFor(NumStreams, [&](int32 Index)
+	{
+		if (Index > 0 && Index <= NumLayers)
+			EncodeLayer(Blob.GetLayer(Index - 1), RawStreams[Index]);
+		else if (Index >= FirstDerivedStream)
+			RawStreams[Index].Append(Derived[Index - FirstDerivedStream].GetData(), Derived[Index - FirstDerivedStream].Num());
+		else if (Index > NumLayers)
+			EncodeLeaves(Blob.GetLeafNodes(Index - NumLayers - 1), RawStreams[Index]);
+
+		CompressStream(RawStreams[Index], CompressedStreams[Index]);
+	});
+
+	OutBytes.Reset();
+	FPackedWriter Writer(OutBytes);
+	Writer.WriteVarint(CompressedMagic);
+	Writer.WriteVarint(CompressedVersion);
+	Writer.WriteVarint(NumStreams);
+
+	for (auto i = 0; i < NumStreams; i++)
+	{
+		Writer.WriteVarint(RawStreams[i].Num());
+		Writer.WriteVarint(CompressedStreams[i].Num());
+	}
+
+	for (const auto& Stream : CompressedStreams)
+		Writer.WriteRaw(Stream.GetData(), Stream.Num());
+}
+
+bool FSVONDataCompression::Decompress(const TArray<uint8>& Bytes, FSVONDataBlob& OutBlob)
+{
+	OutBlob.Reset();
+
+	FPackedReader Header(Bytes.GetData(), Bytes.Num());
+	if (Header.ReadVarint() != CompressedMagic || Header.ReadVarint() != CompressedVersion)
+		return false;
+
+	const auto NumStreams = Header.ReadVarint();
+	if (NumStreams < 2 + NumDerivedStreams || NumStreams > 1 + 16 + MAX_uint8 + NumDerivedStreams)
+		return false;
+
+	TArray<FStreamHeader> Streams;
+	Streams.SetNum(static_cast<int32>(NumStreams));
+	for (auto& Stream : Streams)
+	{
+		const auto RawSize = Header.ReadVarint();
+		const auto CompressedSize = Header.ReadVarint();
+		if (RawSize > MAX_int32 || CompressedSize > RawSize)
+			return false;
+
+		Stream.RawSize = static_cast<int32>(RawSize);
+		Stream.CompressedSize = static_cast<int32>(CompressedSize);
+	}
+
+	if (Header.IsError())
+		return false;
+
+	int64 Offset = Header.GetPosition();
+	for (auto& Stream : Streams)
+	{
+		Stream.Offset = static_cast<int32>(Offset);
+		Offset += Stream.CompressedSize;
+	}
+
+	if (Offset != Bytes.Num())
+		return false;
+
+	TArray<uint8> RawMeta;
+	if (!UncompressStream(Bytes, Streams[0], RawMeta))
+		return false;
+
+	FPackedReader Meta(RawMeta.GetData(), RawMeta.Num());
+
+	const auto NumLayers = Meta.ReadVarint();
+	if (NumLayers > 16)
+		return false;
+
+	TArray<int32> LayerSizes;
+	for (uint64 i = 0; i < NumLayers; i++)
+	{
+		const auto LayerSize = Meta.ReadVarint();
+		if (LayerSize >= (1 << 22))
+			return false;
+
+		LayerSizes.Add(static_cast<int32>(LayerSize));
+	}
+
+	const auto NumLeafNodes = Meta.ReadVarint();
+	const auto NumClearanceLevels = Meta.ReadVarint();
+	if (NumLeafNodes >= (1 << 22) || NumClearanceLevels < 1 || NumStreams != 1 + NumLayers + NumClearanceLevels + NumDerivedStreams)
+		return false;
+
+	const auto NumRadii = Meta.ReadVarint();
+	if (NumRadii > NumClearanceLevels)
+		return false;
+
+	TArray<float> Radii;
+	Radii.SetNumUninitialized(static_cast<int32>(NumRadii));
+	Meta.ReadRaw(Radii.GetData(), Radii.Num() * sizeof(float));
+
+	const auto NumAreaFlags = Meta.ReadVarint();
+	if (NumAreaFlags >= (1 << 22) || Meta.IsError())
+		return false;
+
+	TArray<uint8> AreaFlags;
+	AreaFlags.SetNumUninitialized(static_cast<int32>(NumAreaFlags));
+	Meta.ReadRaw(AreaFlags.GetData(), AreaFlags.Num());
+
+	// Leaf voxel arrays are per voxel, so they can run to 64 times the leaf limit
+	TArray<int32> DerivedSizes;
+	for (auto i = 0; i < NumDerivedStreams; i++)
+	{
+		const auto DerivedSize = Meta.ReadVarint();
+		if (DerivedSize >= (1 << 28))
+			return false;
+
+		DerivedSizes.Add(static_cast<int32>(DerivedSize));
+	}
+
+	const auto NumComponents = Meta.ReadVarint();
+	if (NumComponents > MAX_int32)
+		return false;
+
+	OutBlob.Allocate(LayerSizes, static_cast<int32>(NumLeafNodes), static_cast<int32>(NumClearanceLevels), Radii.Num(), AreaFlags.Num(), DerivedSizes);
+
+	FMemory::Memcpy(OutBlob.GetMutableClearanceRadii().GetData(), Radii.GetData(), Radii.Num() * sizeof(float));
+	FMemory::Memcpy(OutBlob.GetMutableAreaFlags().GetData(), AreaFlags.GetData(), AreaFlags.Num());
+	OutBlob.SetNumComponents(static_cast<int32>(NumComponents));
+
+	if (Meta.IsError() || !Meta.IsAtEnd())
+	{
+		OutBlob.Reset();
+		return false;
+	}
+
+	// Every stream owns its own section of the blob, so they decode side by side
+	TArray<TArrayView<FSVONNode>> Layers;
+	for (auto i = 0; i < LayerSizes.Num(); i++)
+		Layers.Add(OutBlob.GetMutableLayer(i));
+
+	TArray<TArrayView<FSVONLeafNode>> Leaves;
+	for (auto i = 0; i < static_cast<int32>(NumClearanceLevels); i++)
+		Leaves.Add(OutBlob.GetMutableLeafNodes(i));
+
+	const TArrayView<uint8> Derived[NumDerivedStreams] =
+	{
+		TArrayView<uint8>(reinterpret_cast<uint8*>(OutBlob.GetMutableNodeComponents().GetData()), static_cast<int32>(DerivedSizes[0] * sizeof(int32))),
+		TArrayView<uint8>(reinterpret_cast<uint8*>(OutBlob.GetMutableLeafVoxelComponents().GetData()), static_cast<int32>(DerivedSizes[1] * sizeof(int32))),
+		OutBlob.GetMutableNodeDistances(),
+		OutBlob.GetMutableLeafVoxelDistances()
+	};
+
+	FThreadSafeBool bFailed = false;
+	ParallelFor(Streams.Num() - 1, [&](int32 Index)
+	{
+		TArray<uint8> Raw;
+		if (!UncompressStream(Bytes, Streams[Index + 1], Raw))
+		{
+			bFailed = true;
+			return;
+		}
+
+		FPackedReader Reader(Raw.GetData(), Raw.Num());
+		if (Index < Layers.Num())
+			DecodeLayer(Reader, Layers[Index]);
+		else if (Index < Layers.Num() + Leaves.Num())
+			DecodeLeaves(Reader, Leaves[Index - Layers.Num()]);
+		else
+		{
+			const auto& Destination = Derived[Index - Layers.Num() - Leaves.Num()];
+			Reader.ReadRaw(Destination.GetData(), Destination.Num());
+		}
+
+		if (Reader.IsError() || !Reader.IsAtEnd())
+			bFailed = true;
+	});
+
+	if (bFailed)
+	{
+		OutBlob.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FSVONDataCompression::AreEqual(const FSVONDataBlob& A, const FSVONDataBlob& B)
+{
+	auto LinksEqual = [](const FSVONLink& First, const FSVONLink& Second)
+	{
+		// Invalid links carry whatever index they had before, which nothing reads
+		if (!First.IsValid() || !Second.IsValid())
+			return First.IsValid() == Second.IsValid();
+
+		return First.LayerIndex == Second.LayerIndex && First.NodeIndex == Second.NodeIndex && First.SubNodeIndex == Second.SubNodeIndex;
+	};
+
+	if (A.GetNumLayers() != B.GetNumLayers() || A.GetNumClearanceLevels() != B.GetNumClearanceLevels())
+		return false;
+
+	const auto RadiiA = A.GetClearanceRadii();
+	const auto RadiiB = B.GetClearanceRadii();
+	if (RadiiA.Num() != RadiiB.Num() || FMemory::Memcmp(RadiiA.GetData(), RadiiB.GetData(), RadiiA.Num() * sizeof(float)) != 0)
+		return false;
+
+	const auto FlagsA = A.GetAreaFlags();
+	const auto FlagsB = B.GetAreaFlags();
+	if (FlagsA.Num() != FlagsB.Num() || FMemory::Memcmp(FlagsA.GetData(), FlagsB.GetData(), FlagsA.Num()) != 0)
+		return false;
+
+	for (auto LayerIndex = 0; LayerIndex < A.GetNumLayers(); LayerIndex++)
+	{
+		const auto LayerA = A.GetLayer(LayerIndex);
+		const auto LayerB = B.GetLayer(LayerIndex);
+		if (LayerA.Num() != LayerB.Num())
+			return false;
+
+		for (auto i = 0; i < LayerA.Num(); i++)
+		{
+			const auto& NodeA = LayerA[i];
+			const auto& NodeB = LayerB[i];
+			if (NodeA.Code != NodeB.Code || !LinksEqual(NodeA.Parent, NodeB.Parent) || !LinksEqual(NodeA.FirstChild, NodeB.FirstChild))
+				return false;
+
+			for (auto Direction = 0; Direction < 6; Direction++)
+			{
+				if (!LinksEqual(NodeA.Neighbors[Direction], NodeB.Neighbors[Direction]))
+					return false;
+			}
+		}
+	}
+
+	for (auto Level = 0; Level < A.GetNumClearanceLevels(); Level++)
+	{
+		const auto LeavesA = A.GetLeafNodes(Level);
+		const auto LeavesB = B.GetLeafNodes(Level);
+		if (LeavesA.Num() != LeavesB.Num())
+			return false;
+
+		for (auto i = 0; i < LeavesA.Num(); i++)
+		{
+			if (LeavesA[i].VoxelGrid != LeavesB[i].VoxelGrid)
+				return false;
+		}
+	}
+
+	// The derived arrays are plain integers, no padding to worry about
+	auto ArraysEqual = [](const auto& First, const auto& Second)
+	{
+		return First.Num() == Second.Num() && FMemory::Memcmp(First.GetData(), Second.GetData(), First.Num() * sizeof(First[0])) == 0;
+	};
+
+	return A.GetNumComponents() == B.GetNumComponents()
+		&& ArraysEqual(A.GetNodeComponents(), B.GetNodeComponents())
+		&& ArraysEqual(A.GetLeafVoxelComponents(), B.GetLeafVoxelComponents())
+		&& ArraysEqual(A.GetNodeDistances(), B.GetNodeDistances())
+		&& ArraysEqual(A.GetLeafVoxelDistances(), B.GetLeafVoxelDistances());
+}
@@ -0,0 +1,213 @@
+#include "SVONDistanceField.h"
+
+#include "SVONDataBlob.h"
+#include "SVONDefines.h"
+#include "SVONLinkIndex.h"
+#include "SVONVolumeActor.h"
+
+const uint8 FSVONDistanceField::MaxNodeDistance;
+const uint8 FSVONDistanceField::MaxLeafVoxelDistance;
+
+namespace
+{
+	struct FDistanceEntry
+	{
+		float Distance;
+		FSVONLink Link;
+	};
+
+	// True if the face neighbor of a leaf voxel, or of a childless layer 0 node, is solid. The edge of the volume isn't an obstacle
+	bool IsFaceBlocked(const ASVONVolumeActor& Volume, const FSVONNode& Node, int32 Direction, bool bIsLeafVoxel, uint_fast32_t SubNodeIndex)
+	{
+		const auto& Step = FSVONStatics::Directions[Direction];
+
+		uint_fast32_t X, Y, Z;
+		morton3D_64_decode(Node.Code, X, Y, Z);
+
+		int32 SX = 0, SY = 0, SZ = 0;
+		if (bIsLeafVoxel)
+		{
+			uint_fast32_t VX, VY, VZ;
+			morton3D_64_decode(SubNodeIndex, VX, VY, VZ);
+			SX = static_cast<int32>(VX) + Step.X;
+			SY = static_cast<int32>(VY) + Step.Y;
+			SZ = static_cast<int32>(VZ) + Step.Z;
+
+			// Still inside our own leaf
+			if (SX >= 0 && SX < 4 && SY >= 0 && SY < 4 && SZ >= 0 && SZ < 4)
+				return Volume.GetLeafNode(Node).GetNode(morton3D_64_encode(SX, SY, SZ));
+		}
+
+		const auto NodesPerSide = Volume.GetLayerGeometry(0).NodesPerSide;
+		const auto NX = static_cast<int32>(X) + Step.X;
+		const auto NY = static_cast<int32>(Y) + Step.Y;
+		const auto NZ = static_cast<int32>(Z) + Step.Z;
+		if (NX < 0 || NX >= NodesPerSide || NY < 0 || NY >= NodesPerSide || NZ < 0 || NZ >= NodesPerSide)
+			return false;
+
+		// Neighbor links inside the volume are only invalid when they'd point at a completely blocked leaf
+		const auto& NeighborLink = Node.Neighbors[Direction];
+		if (!NeighborLink.IsValid())
+			return true;
+
+		const auto& NeighborNode = Volume.GetNode(NeighborLink);
+		if (NeighborLink.LayerIndex > 0 || !NeighborNode.HasChildren())
+			return false;
+
+		// A childless node next to a leaf is only as close as the leaf's nearest voxel, which will seed itself
+		if (!bIsLeafVoxel)
+			return false;
+
+		const auto WrappedCode = morton3D_64_encode((SX + 4) & 3, (SY + 4) & 3, (SZ + 4) & 3);
+		return Volume.GetLeafNode(NeighborNode).GetNode(WrappedCode);
+	}
+}
+
+void FSVONDistanceField::Build(const ASVONVolumeActor& Volume, const FSVONLinkIndex& Index, FSVONDerivedData& OutData)
+{
+	auto& NodeDistances = OutData.NodeDistances;
+	auto& LeafVoxelDistances = OutData.LeafVoxelDistances;
+	NodeDistances.Empty();
+	LeafVoxelDistances.Empty();
+
+	if (Volume.GetNumLayers() == 0)
+		return;
+
+	TArray<float> Distances;
+	Distances.Init(MAX_flt, Index.Num());
+
+	TArray<FDistanceEntry> Frontier;
+	auto Closer = [](const FDistanceEntry& A, const FDistanceEntry& B) { return A.Distance < B.Distance; };
+
+	auto Seed = [&](const FSVONLink& Link, float Distance)
+	{
+		Distances[Index.GetIndex(Link)] = Distance;
+		Frontier.Add(FDistanceEntry{ Distance, Link });
+	};
+
+	// Seed from the free space touching obstacles, at the distance from its centre to the shared face
+	const auto LeafLayer = Volume.GetLayer(0);
+	for (auto i = 0; i < LeafLayer.Num(); i++)
+	{
+		const auto& Node = LeafLayer[i];
+		if (!Node.HasChildren())
+		{
+			for (auto Direction = 0; Direction < 6; Direction++)
+			{
+				if (IsFaceBlocked(Volume, Node, Direction, false, 0))
+				{
+					Seed(FSVONLink(0, i, 0), 2.0f);
+					break;
+				}
+			}
+
+			continue;
+		}
+
+		const auto& Leaf = Volume.GetLeafNode(Node);
+		for (auto SubNodeIndex = 0; SubNodeIndex < 64; SubNodeIndex++)
+		{
+			if (Leaf.GetNode(SubNodeIndex))
+				continue;
+
+			for (auto Direction = 0; Direction < 6; Direction++)
+			{
+				if (IsFaceBlocked(Volume, Node, Direction, true, SubNodeIndex))
+				{
+					Seed(FSVONLink(0, i, SubNodeIndex), 0.5f);
+					break;
+				}
+			}
+		}
+	}
+
+	Frontier.Heapify(Closer);
+
+	// Spread outward, grid positions are in half leaf voxels
+	TArray<FSVONLink> Neighbors;
+	FDistanceEntry Entry;
+	while (Frontier.Num() > 0)
+	{
+		Frontier.HeapPop(Entry, Closer, false);
+		if (Entry.Distance > Distances[Index.GetIndex(Entry.Link)])
+			continue;
+
+		FIntVector Position;
+		Volume.GetLinkGridPosition(Entry.Link, Position);
+
+		Neighbors.Reset();
+		if (Entry.Link.LayerIndex == 0 && Volume.GetNode(Entry.Link).HasChildren())
+			Volume.GetLeafNeighbors(Entry.Link, Neighbors);
+		else
+			Volume.GetNeighbors(Entry.Link, Neighbors);
+
+		for (const auto& Neighbor : Neighbors)
+		{
+			if (!Index.IsKnownLink(Neighbor))
+				continue;
+
+			FIntVector NeighborPosition;
+			Volume.GetLinkGridPosition(Neighbor, NeighborPosition);
+
+			const auto Distance = Entry.Distance + FVector(NeighborPosition - Position).Size() * 0.5f;
+			auto& NeighborDistance = Distances[Index.GetIndex(Neighbor)];
+			if (Distance >= NeighborDistance)
+				continue;
+
+			NeighborDistance = Distance;
+			Frontier.HeapPush(FDistanceEntry{ Distance, Neighbor }, Closer);
+		}
+	}
+
+	// Quantize
+	const auto NumNodes = Index.GetNumNodes();
+	NodeDistances.SetNumUninitialized(NumNodes);
+	for (auto i = 0; i < NumNodes; i++)
+		NodeDistances[i] = static_cast<uint8>(FMath::Min(FMath::RoundToInt(FMath::Min(Distances[i], 1024.0f)), static_cast<int32>(MaxNodeDistance)));
+
+	const auto NumLeafVoxels = Index.Num() - NumNodes;
+	LeafVoxelDistances.SetNumZeroed((NumLeafVoxels + 1) / 2);
+	for (auto i = 0; i < NumLeafVoxels; i++)
+	{
+		const auto Quantized = FMath::Min(FMath::RoundToInt(FMath::Min(Distances[NumNodes + i], 1024.0f)), static_cast<int32>(MaxLeafVoxelDistance));
+		LeafVoxelDistances[i >> 1] |= static_cast<uint8>(Quantized << ((i & 1) << 2));
+	}
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Distance field : %d bytes"), static_cast<int32>(NodeDistances.GetAllocatedSize() + LeafVoxelDistances.GetAllocatedSize()));
+#endif
+}
+
+void FSVONDistanceField::Load(const FSVONDataBlob& Blob, const FSVONLinkIndex& InIndex)
+{
+	Reset();
+
+	const auto NumLeafVoxels = InIndex.Num() - InIndex.GetNumNodes();
+	if (Blob.GetNodeDistances().Num() != InIndex.GetNumNodes() || Blob.GetNodeDistances().Num() == 0 || Blob.GetLeafVoxelDistances().Num() != (NumLeafVoxels + 1) / 2)
+		return;
+
+	Index = &InIndex;
+	NodeDistances = Blob.GetNodeDistances();
+	LeafVoxelDistances = Blob.GetLeafVoxelDistances();
+}
+
+void FSVONDistanceField::Reset()
+{
+	Index = nullptr;
+	NodeDistances = TArrayView<const uint8>();
+	LeafVoxelDistances = TArrayView<const uint8>();
+}
+
+uint8 FSVONDistanceField::GetDistance(const FSVONLink& Link) const
+{
+	if (!Index || !Index->IsKnownLink(Link))
+		return MaxNodeDistance;
+
+	const auto Element = Index->GetIndex(Link);
+	const auto NumNodes = Index->GetNumNodes();
+	if (Element < NumNodes)
+		return NodeDistances[Element];
+
+	const auto Voxel = Element - NumNodes;
+	return (LeafVoxelDistances[Voxel >> 1] >> ((Voxel & 1) << 2)) & 0xF;
+}
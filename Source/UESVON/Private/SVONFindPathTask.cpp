@@ -1,10 +1,21 @@
 #include "SVONFindPathTask.h"
 
 #include "SVONPathFinder.h"
+#include "SVONStats.h"
+#include "SVONWorkerPool.h"
 
 void FSVONFindPathTask::DoWork()
 {
+	const auto QueueWait = FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - QueuedCycles);
+	INC_FLOAT_STAT_BY(STAT_SVONAsyncQueueWait, QueueWait);
+
 	FSVONPathFinder PathFinder(World, Volume, Settings);
-	auto Result = PathFinder.FindPath(Start, Target, StartLocation, TargetLocation, Path);
+	PathFinder.SetQueueWait(QueueWait);
+
+	auto& Scratch = FSVONWorkerContext::Get().Scratch;
+	PathFinder.SwapScratch(Scratch);
+	PathFinder.FindPath(Start, Target, StartLocation, TargetLocation, Path);
+	PathFinder.SwapScratch(Scratch);
+
 	CompleteFlag = true;
 }
@@ -0,0 +1,177 @@
+#include "SVONFlowField.h"
+
+#include "SVONVolumeActor.h"
+
+FSVONFlowField::FSVONFlowField(const ASVONVolumeActor& Volume, const FSVONLink& Goal, uint8 ClearanceLevel, const FSVONAreaFilter& AreaFilter)
+	: LastUsed(0),
+	Volume(Volume),
+	Goal(Goal),
+	ClearanceLevel(ClearanceLevel),
+	AreaFilter(AreaFilter),
+	Index(Volume.GetLinkIndex()),
+	bHasReverseLinks(false),
+	NextEdgeSource(0),
+	GridUnitSize(Volume.GetVoxelSize(0) * 0.125f)
+{
+	AreaFilter.GetCostTable(AreaCostScale);
+
+	Distances.Init(MAX_flt, Index.Num());
+	NextHops.Init(FSVONLink::GetInvalidLink(), Index.Num());
+	Settled.Init(false, Index.Num());
+
+	if (Index.IsKnownLink(Goal))
+	{
+		const auto GoalIndex = Index.GetIndex(Goal);
+		Distances[GoalIndex] = 0.0f;
+		NextHops[GoalIndex] = Goal;
+		Frontier.Add(FFrontierEntry{ 0.0f, Goal });
+	}
+}
+
+bool FSVONFlowField::IsNavigable(const FSVONLink& Link) const
+{
+	const auto& Node = Volume.GetNode(Link);
+	if (!Node.HasChildren())
+		return true;
+
+	return Link.LayerIndex == 0 && !Volume.GetLeafNode(Node, ClearanceLevel).GetNode(Link.SubNodeIndex);
+}
+
+int32 FSVONFlowField::GatherEdges(int32 MaxLinks)
+{
+	auto NumGathered = 0;
+	for (; NextEdgeSource < Index.Num() && NumGathered < MaxLinks; NextEdgeSource++)
+	{
+		const auto Link = Index.GetLink(NextEdgeSource);
+		if (!IsNavigable(Link))
+			continue;
+
+		NumGathered++;
+
+		Neighbors.Reset();
+		if (Link.LayerIndex == 0 && Volume.GetNode(Link).HasChildren())
+			Volume.GetLeafNeighbors(Link, Neighbors, ClearanceLevel);
+		else
+			Volume.GetNeighbors(Link, Neighbors, ClearanceLevel);
+
+		for (const auto& Neighbor : Neighbors)
+		{
+			if (Index.IsKnownLink(Neighbor))
+				Edges.Emplace(Index.GetIndex(Neighbor), NextEdgeSource);
+		}
+	}
+
+	if (NextEdgeSource < Index.Num())
+		return NumGathered;
+
+	// Counting sort on the target, so each link's sources sit together
+	ReverseOffsets.Init(0, Index.Num() + 1);
+	for (const auto& Edge : Edges)
+		ReverseOffsets[Edge.Key + 1]++;
+
+	for (auto i = 0; i < Index.Num(); i++)
+		ReverseOffsets[i + 1] += ReverseOffsets[i];
+
+	TArray<int32> Cursors(ReverseOffsets.GetData(), Index.Num());
+	ReverseSources.SetNumUninitialized(Edges.Num());
+	for (const auto& Edge : Edges)
+		ReverseSources[Cursors[Edge.Key]++] = Edge.Value;
+
+	Edges.Empty();
+	bHasReverseLinks = true;
+
+	return NumGathered;
+}
+
+bool FSVONFlowField::Step(int32 MaxExpansions)
+{
+	auto Expansion = 0;
+	if (!bHasReverseLinks)
+	{
+		Expansion += GatherEdges(MaxExpansions);
+		if (!bHasReverseLinks)
+			return false;
+	}
+
+	auto Closer = [](const FFrontierEntry& A, const FFrontierEntry& B) { return A.Distance < B.Distance; };
+
+	FFrontierEntry Entry;
+	while (Expansion < MaxExpansions && Frontier.Num() > 0)
+	{
+		Frontier.HeapPop(Entry, Closer, false);
+
+		const auto EntryIndex = Index.GetIndex(Entry.Link);
+		if (Settled[EntryIndex])
+			continue;
+
+		Settled[EntryIndex] = true;
+		Expansion++;
+
+		FIntVector Position;
+		Volume.GetLinkGridPosition(Entry.Link, Position);
+
+		// As in the path finder, an excluded area can be left but not entered, and a step costs what the area it's onto does
+		const auto EntryAreas = Volume.GetAreaFlags(Entry.Link);
+		const auto bEntryExcluded = AreaFilter.IsExcluded(EntryAreas);
+		const auto AreaScale = AreaCostScale[EntryAreas];
+
+		// Walk the graph backwards from the goal, over the links that can step onto this one
+		for (auto Edge = ReverseOffsets[EntryIndex]; Edge < ReverseOffsets[EntryIndex + 1]; Edge++)
+		{
+			const auto SourceIndex = ReverseSources[Edge];
+			if (Settled[SourceIndex])
+				continue;
+
+			const auto Source = Index.GetLink(SourceIndex);
+			if (bEntryExcluded && !AreaFilter.IsExcluded(Volume.GetAreaFlags(Source)))
+				continue;
+
+			FIntVector SourcePosition;
+			Volume.GetLinkGridPosition(Source, SourcePosition);
+
+			const auto Distance = Entry.Distance + FVector(SourcePosition - Position).Size() * GridUnitSize * AreaScale;
+			if (Distance >= Distances[SourceIndex])
+				continue;
+
+			Distances[SourceIndex] = Distance;
+			NextHops[SourceIndex] = Entry.Link;
+			Frontier.HeapPush(FFrontierEntry{ Distance, Source }, Closer);
+		}
+	}
+
+	return IsComplete();
+}
+
+bool FSVONFlowField::BuildUntil(const FSVONLink& Link, int32 MaxExpansions)
+{
+	if (!Index.IsKnownLink(Link))
+		return false;
+
+	// Small slices, so we stop soon after the link is settled rather than a whole budget later
+	const auto SliceSize = 256;
+	auto Remaining = MaxExpansions > 0 ? MaxExpansions : MAX_int32;
+
+	while (!IsSettled(Link) && !IsComplete() && Remaining > 0)
+	{
+		const auto Slice = FMath::Min(SliceSize, Remaining);
+		Step(Slice);
+		Remaining -= Slice;
+	}
+
+	return IsSettled(Link);
+}
+
+bool FSVONFlowField::GetNextHop(const FSVONLink& Link, FSVONLink& OutNextHop) const
+{
+	if (!IsSettled(Link))
+		return false;
+
+	OutNextHop = NextHops[Index.GetIndex(Link)];
+	return true;
+}
+
+SIZE_T FSVONFlowField::GetAllocatedSize() const
+{
+	return ReverseOffsets.GetAllocatedSize() + ReverseSources.GetAllocatedSize() + Edges.GetAllocatedSize()
+		+ Distances.GetAllocatedSize() + NextHops.GetAllocatedSize() + Settled.GetAllocatedSize() + Frontier.GetAllocatedSize() + Neighbors.GetAllocatedSize();
+}
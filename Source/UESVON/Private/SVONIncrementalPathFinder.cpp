@@ -0,0 +1,331 @@
+#include "SVONIncrementalPathFinder.h"
+
+#include "UESVON.h"
+#include "SVONVolumeActor.h"
+#include "SVONPathCache.h"
+#include "SVONStats.h"
+#include "Algo/Reverse.h"
+
+FSVONIncrementalPathFinder::FSVONIncrementalPathFinder(UWorld* World, const ASVONVolumeActor& Volume, const FSVONPathFinderSettings& InSettings)
+	: Settings(InSettings),
+	PathFinder(World, Volume, Settings),
+	Volume(&Volume),
+	DataId(Volume.GetDataId()),
+	SettingsHash(InSettings.GetResultHash()),
+	NumOpen(0),
+	bHasSearch(false),
+	Generation(0),
+	KeyOffset(0.0f),
+	HeuristicScale(0.0f) {}
+
+template <typename TCostPolicy>
+int32 FSVONIncrementalPathFinder::ComputeShortestPath(const TCostPolicy& CostPolicy)
+{
+	auto NumSettled = 0;
+
+	FOpenEntry Entry;
+	while (OpenHeap.Num() > 0)
+	{
+		const auto& Top = OpenHeap.HeapTop();
+		const auto* TopState = States.Find(Top.Link);
+		if (!TopState->bOpen || TopState->Key1 != Top.Key1 || TopState->Key2 != Top.Key2)
+		{
+			OpenHeap.HeapPop(Entry, false);
+			continue;
+		}
+
+		// Done once nothing open could lead to a cheaper goal
+		const auto* GoalState = States.Find(Goal);
+		if (GoalState && GoalState->G < FLT_MAX && GoalState->G == GoalState->Rhs)
+		{
+			FOpenEntry GoalEntry;
+			CalculateKey(Goal, *GoalState, GoalEntry.Key1, GoalEntry.Key2);
+			if (!(Top < GoalEntry))
+				break;
+		}
+
+		OpenHeap.HeapPop(Entry, false);
+
+		// Queued before the goal last moved, its key has gone up since
+		auto& State = States.FindChecked(Entry.Link);
+		FOpenEntry Current;
+		CalculateKey(Entry.Link, State, Current.Key1, Current.Key2);
+		if (Entry < Current)
+		{
+			UpdateOpen(Entry.Link, State);
+			continue;
+		}
+
+		// Costs only ever come down, so an open link is always settled at its best cost rather than raised
+		State.G = State.Rhs;
+		UpdateOpen(Entry.Link, State);
+		NumSettled++;
+
+		// States can move as neighbors are added
+		const auto G = State.G;
+		const auto& Link = Entry.Link;
+
+		FIntVector Position;
+		GetVolume().GetLinkGridPosition(Link, Position);
+
+		Neighbors.Reset();
+		if (Link.LayerIndex == 0 && GetVolume().GetNode(Link).FirstChild.IsValid())
+			GetVolume().GetLeafNeighbors(Link, Neighbors, Settings.ClearanceLevel);
+		else
+			GetVolume().GetNeighbors(Link, Neighbors, Settings.ClearanceLevel);
+
+		for (const auto& Neighbor : Neighbors)
+		{
+			if (!Neighbor.IsValid() || Neighbor == Root)
+				continue;
+
+			const auto Cost = GetStepCost(CostPolicy, Link, Position, Neighbor);
+			if (Cost == FLT_MAX)
+				continue;
+
+			auto& NeighborState = States.FindOrAdd(Neighbor);
+			if (G + Cost >= NeighborState.Rhs)
+				continue;
+
+			NeighborState.Rhs = G + Cost;
+			NeighborState.Parent = Link;
+			UpdateOpen(Neighbor, NeighborState);
+		}
+	}
+
+	return NumSettled;
+}
+
+template <typename TCostPolicy>
+float FSVONIncrementalPathFinder::GetStepCost(const TCostPolicy& CostPolicy, const FSVONLink& From, const FIntVector& FromPosition, const FSVONLink& To) const
+{
+	const auto& Context = PathFinder.Context;
+	const auto ToAreas = GetVolume().GetAreaFlags(To);
+
+	// As in FSVONPathFinder::ExpandCurrent, an excluded area can be left but not entered
+	if (Context.ExcludedAreas != 0 && (ToAreas & Context.ExcludedAreas) != 0 && (GetVolume().GetAreaFlags(From) & Context.ExcludedAreas) == 0)
+		return FLT_MAX;
+
+	FIntVector ToPosition;
+	GetVolume().GetLinkGridPosition(To, ToPosition);
+
+	return CostPolicy.GetCost(Context, FromPosition, ToPosition, To) * Context.AreaCostScale[ToAreas];
+}
+
+int32 FSVONIncrementalPathFinder::FindPath(const FSVONLink& Start, const FSVONLink& Target, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
+{
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONFindPath);
+	INC_DWORD_STAT(STAT_SVONNumSearches);
+
+	// A new octree in the same volume means new links, and without the volume there's nothing to search
+	const auto* CurrentVolume = Volume.Get();
+	if (!CurrentVolume || CurrentVolume->GetDataId() != DataId)
+	{
+		Reset();
+		return 0;
+	}
+
+	// The agent has usually moved along the last path since, anywhere on it the search from the root still holds
+	const auto bCanRepair = bHasSearch && Generation == GetVolume().GetPathCache().GetGeneration() && (Start == Root || PathLinks.Contains(Start));
+	if (bCanRepair)
+	{
+		INC_DWORD_STAT(STAT_SVONNumRepairs);
+		MoveGoal(Target);
+		CompactOpenHeap();
+	}
+
+	// Picks the policies and post processing for this query, and points the heuristic at the target
+	PathFinder.SetupSearch(Start, Target);
+	if (!bCanRepair)
+		StartSearch(Start, Target);
+
+	auto Search = [&]() { return PathFinder.DispatchCostPolicy([&](const auto& CostPolicy) { return ComputeShortestPath(CostPolicy); }); };
+
+	auto NumSettled = Search();
+	auto bFound = ExtractPath();
+
+	// The best path from the root may no longer go past the agent, then the search has to start again from where it is
+	auto StartIndex = PathLinks.IndexOfByKey(Start);
+	if (bFound && StartIndex == INDEX_NONE)
+	{
+		StartSearch(Start, Target);
+		NumSettled += Search();
+		bFound = ExtractPath();
+		StartIndex = 0;
+	}
+
+	INC_DWORD_STAT_BY(STAT_SVONNodesExpanded, NumSettled);
+
+	if (!bFound)
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Incremental pathfinding failed, settled : %i"), NumSettled);
+#endif
+		return 0;
+	}
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Incremental pathfinding complete, %s, settled : %i"), bCanRepair ? TEXT("repaired") : TEXT("new search"), NumSettled);
+#endif
+
+	if (!OutPath || !OutPath->IsValid())
+		return 1;
+
+	// Goal first and without the goal link itself, the way FSVONPathFinder::BuildPath leaves them
+	TArray<FSVONPathPoint> Points;
+	for (auto i = PathLinks.Num() - 2; i >= StartIndex; i--)
+		PathFinder.AddPathPoint(PathLinks[i], Points);
+
+	PathFinder.FinishPath(Points, StartLocation, TargetLocation, OutPath);
+
+	return 1;
+}
+
+void FSVONIncrementalPathFinder::Reset()
+{
+	States.Empty();
+	OpenHeap.Empty();
+	PathLinks.Empty();
+	NumOpen = 0;
+	bHasSearch = false;
+}
+
+bool FSVONIncrementalPathFinder::IsFor(const ASVONVolumeActor& InVolume, const FSVONPathFinderSettings& InSettings) const
+{
+	return Volume.Get() == &InVolume && DataId == InVolume.GetDataId() && SettingsHash == InSettings.GetResultHash();
+}
+
+void FSVONIncrementalPathFinder::StartSearch(const FSVONLink& InStart, const FSVONLink& InGoal)
+{
+	// Reset rather than Empty, memory from the last search is reused
+	States.Reset();
+	OpenHeap.Reset();
+	PathLinks.Reset();
+	NumOpen = 0;
+
+	Root = InStart;
+	Goal = InGoal;
+	bHasSearch = true;
+	Generation = GetVolume().GetPathCache().GetGeneration();
+	KeyOffset = 0.0f;
+
+	// Steps onto the highest layer are the cheapest per unit of distance with node size compensation
+	HeuristicScale = 0.0f;
+	if (!Settings.bUseUnitCost)
+	{
+		const auto& Context = PathFinder.Context;
+		const auto NumLayers = FMath::Clamp<int32>(GetVolume().GetNumLayers(), 1, ARRAY_COUNT(Context.LayerCostScale));
+
+		HeuristicScale = Context.LayerCostScale[0];
+		for (auto i = 1; i < NumLayers; i++)
+			HeuristicScale = FMath::Min(HeuristicScale, Context.LayerCostScale[i]);
+
+		HeuristicScale = FMath::Max(HeuristicScale, 0.0f);
+	}
+
+	auto& RootState = States.Add(Root);
+	RootState.Rhs = 0.0f;
+	RootState.Parent = Root;
+	UpdateOpen(Root, RootState);
+}
+
+void FSVONIncrementalPathFinder::MoveGoal(const FSVONLink& InGoal)
+{
+	if (InGoal == Goal)
+		return;
+
+	FIntVector OldPosition, NewPosition;
+	GetVolume().GetLinkGridPosition(Goal, OldPosition);
+	GetVolume().GetLinkGridPosition(InGoal, NewPosition);
+
+	// Heuristics to the new goal are at most this much lower than to the old one, so raising every new key by it keeps the order
+	KeyOffset += FVector(NewPosition - OldPosition).Size() * PathFinder.Context.GridUnitSize * HeuristicScale;
+	Goal = InGoal;
+}
+
+float FSVONIncrementalPathFinder::GetHeuristic(const FSVONLink& Link) const
+{
+	if (HeuristicScale <= 0.0f)
+		return 0.0f;
+
+	FIntVector Position;
+	GetVolume().GetLinkGridPosition(Link, Position);
+
+	return FVector(Position - PathFinder.Context.GoalPosition).Size() * PathFinder.Context.GridUnitSize * HeuristicScale;
+}
+
+void FSVONIncrementalPathFinder::CalculateKey(const FSVONLink& Link, const FLinkState& State, float& OutKey1, float& OutKey2) const
+{
+	const auto Cost = FMath::Min(State.G, State.Rhs);
+	if (Cost == FLT_MAX)
+	{
+		OutKey1 = FLT_MAX;
+		OutKey2 = FLT_MAX;
+		return;
+	}
+
+	OutKey1 = Cost + GetHeuristic(Link) + KeyOffset;
+	OutKey2 = Cost;
+}
+
+void FSVONIncrementalPathFinder::UpdateOpen(const FSVONLink& Link, FLinkState& State)
+{
+	if (State.G == State.Rhs)
+	{
+		if (State.bOpen)
+			NumOpen--;
+
+		State.bOpen = false;
+		return;
+	}
+
+	if (!State.bOpen)
+		NumOpen++;
+
+	State.bOpen = true;
+	CalculateKey(Link, State, State.Key1, State.Key2);
+	OpenHeap.HeapPush(FOpenEntry{ State.Key1, State.Key2, Link });
+}
+
+void FSVONIncrementalPathFinder::CompactOpenHeap()
+{
+	// Every requeue leaves its old entry behind, and a long chase requeues a lot
+	if (OpenHeap.Num() <= NumOpen * 2 + 1024)
+		return;
+
+	OpenHeap.Reset();
+	for (const auto& Pair : States)
+	{
+		if (Pair.Value.bOpen)
+			OpenHeap.Add(FOpenEntry{ Pair.Value.Key1, Pair.Value.Key2, Pair.Key });
+	}
+
+	OpenHeap.Heapify();
+}
+
+bool FSVONIncrementalPathFinder::ExtractPath()
+{
+	PathLinks.Reset();
+
+	const auto* GoalState = States.Find(Goal);
+	if (!GoalState || GoalState->G == FLT_MAX)
+		return false;
+
+	auto Link = Goal;
+	PathLinks.Add(Link);
+	while (!(Link == Root))
+	{
+		Link = States.FindChecked(Link).Parent;
+		PathLinks.Add(Link);
+
+		// Parents are always settled links closer to the root, this only guards against zero cost steps
+		if (PathLinks.Num() > States.Num())
+		{
+			PathLinks.Reset();
+			return false;
+		}
+	}
+
+	Algo::Reverse(PathLinks);
+	return true;
+}
@@ -0,0 +1,3 @@
+#include "SVONLeafNode.h"
+
+const FSVONLeafNode FSVONLeafNode::Blocked = { ~0ULL };
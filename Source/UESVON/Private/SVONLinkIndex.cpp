@@ -0,0 +1,62 @@
+#include "SVONLinkIndex.h"
+
+#include "SVONDataBlob.h"
+
+void FSVONLinkIndex::Build(const FSVONDataBlob& Blob)
+{
+	Reset();
+
+	const auto NumLayers = Blob.GetNumLayers();
+	if (NumLayers == 0)
+		return;
+
+	// Every node gets an index, then every voxel of a layer 0 node that has a leaf gets one after those
+	for (auto i = 0; i < NumLayers; i++)
+	{
+		LayerOffsets.Add(NumElements);
+		LayerSizes.Add(Blob.GetLayer(i).Num());
+		NumElements += LayerSizes.Last();
+	}
+
+	const auto LeafLayer = Blob.GetLayer(0);
+	VoxelOffset = NumElements;
+
+	LeafSlots.Init(INDEX_NONE, LeafLayer.Num());
+	int32 NumLeaves = 0;
+	for (auto i = 0; i < LeafLayer.Num(); i++)
+	{
+		if (LeafLayer[i].HasChildren())
+		{
+			LeafSlots[i] = NumLeaves++;
+			LeafNodes.Add(i);
+		}
+	}
+
+	NumElements += NumLeaves * 64;
+}
+
+void FSVONLinkIndex::Reset()
+{
+	LayerOffsets.Empty();
+	LayerSizes.Empty();
+	LeafSlots.Empty();
+	LeafNodes.Empty();
+	VoxelOffset = 0;
+	NumElements = 0;
+}
+
+FSVONLink FSVONLinkIndex::GetLink(int32 Index) const
+{
+	if (Index >= VoxelOffset)
+	{
+		const auto Voxel = Index - VoxelOffset;
+		return FSVONLink(0, LeafNodes[Voxel / 64], Voxel % 64);
+	}
+
+	// A handful of layers, the last one starting at or before the index holds it
+	auto LayerIndex = LayerOffsets.Num() - 1;
+	while (LayerOffsets[LayerIndex] > Index)
+		LayerIndex--;
+
+	return FSVONLink(LayerIndex, Index - LayerOffsets[LayerIndex], 0);
+}
@@ -5,33 +5,23 @@
 
 #include "SVONVolumeActor.h"
 #include "SVONLink.h"
+#include "SVONStats.h"
 
-bool FSVONMediator::GetLinkFromLocation(const FVector& Location, const ASVONVolumeActor& Volume, FSVONLink& OutLink)
+bool FSVONMediator::GetLinkFromLocation(const FVector& Location, const ASVONVolumeActor& Volume, FSVONLink& OutLink, uint8 ClearanceLevel)
 {
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONMediatorLookup);
+
 	// Location is outside the volume, no can do
-	if (!Volume.EncompassesPoint(Location))
+	if (!Volume.ContainsPoint(Location))
 		return false;
 
-	auto Box = Volume.GetComponentsBoundingBox(true);
-
-	FVector Origin;
-	FVector Extent;
-
-	Box.GetCenterAndExtents(Origin, Extent);
-
-	// The Z-order Origin of the volume (where Code == 0)
-	auto OriginZ = Origin - Extent;
-
-	// The local Location of the point in volume space
-	auto LocalLocation = Location - OriginZ;
-
 	auto LayerIndex = Volume.GetNumLayers() - 1;
 	FNodeIndex NodeIndex = 0;
 	while (LayerIndex >= 0 && LayerIndex < Volume.GetNumLayers())
 	{
 		// Get the Layer and Voxel size
 
-		const TArray<FSVONNode>& Layer = Volume.GetLayer(LayerIndex);
+		const auto Layer = Volume.GetLayer(LayerIndex);
 		// Calculate the XYZ coordinates
 
 		FIntVector Voxel;
@@ -65,26 +55,27 @@ bool FSVONMediator::GetLinkFromLocation(const FVector& Location, const ASVONVolu
 				// If this is a Leaf Node, we need to find our subnode
 				if (LayerIndex == 0)
 				{
-					const FSVONLeafNode& Leaf = Volume.GetLeafNode(Node.FirstChild.NodeIndex);
+					const FSVONLeafNode& Leaf = Volume.GetLeafNode(Node, ClearanceLevel);
 
 					// We need to calculate the Node local Location to get the morton Code for the Leaf
-					float VoxelSize = Volume.GetVoxelSize(LayerIndex);
+					const auto& Geometry = Volume.GetLayerGeometry(LayerIndex);
+					const float InverseLeafVoxelSize = 4.0f / Geometry.VoxelSize;
 
 					// The world Location of the 0 Node
 					FVector NodeLocation;
 					Volume.GetNodeLocation(LayerIndex, Node.Code, NodeLocation);
 
 					// The morton Origin of the Node
-					auto NodeOrigin = NodeLocation - FVector(VoxelSize * 0.5f);
+					auto NodeOrigin = NodeLocation - FVector(Geometry.HalfExtent);
 
 					// The requested Location, relative to the Node Origin
 					auto NodeLocalLocation = Location - NodeOrigin;
 
 					// Now get our Voxel coordinates
 					FIntVector Coordinate;
-					Coordinate.X = FMath::FloorToInt((NodeLocalLocation.X / (VoxelSize * 0.25f)));
-					Coordinate.Y = FMath::FloorToInt((NodeLocalLocation.Y / (VoxelSize * 0.25f)));
-					Coordinate.Z = FMath::FloorToInt((NodeLocalLocation.Z / (VoxelSize * 0.25f)));
+					Coordinate.X = FMath::FloorToInt(NodeLocalLocation.X * InverseLeafVoxelSize);
+					Coordinate.Y = FMath::FloorToInt(NodeLocalLocation.Y * InverseLeafVoxelSize);
+					Coordinate.Z = FMath::FloorToInt(NodeLocalLocation.Z * InverseLeafVoxelSize);
 
 					// So our link is.....*drum roll*
 					OutLink.LayerIndex = 0; // Layer 0 (Leaf)
@@ -112,17 +103,114 @@ bool FSVONMediator::GetLinkFromLocation(const FVector& Location, const ASVONVolu
 	return false;
 }
 
-void FSVONMediator::GetVolumeXYZ(const FVector& Location, const ASVONVolumeActor& Volume, const int Layer, FIntVector& OutXYZ)
+bool FSVONMediator::FindNearestNavigableLink(const FVector& Location, const ASVONVolumeActor& Volume, float Radius, FSVONLink& OutLink, FVector& OutLocation, uint8 ClearanceLevel, int32 RequiredComponent)
 {
-	auto Box = Volume.GetComponentsBoundingBox(true);
+	if (Volume.GetNumLayers() == 0)
+		return false;
+
+	const auto& Connectivity = Volume.GetConnectivity();
+	auto IsInComponent = [&](const FSVONLink& Link)
+	{
+		return RequiredComponent == INDEX_NONE || Connectivity.GetComponent(Link) == RequiredComponent;
+	};
+
+	// The common case, we're already somewhere navigable
+	if (GetLinkFromLocation(Location, Volume, OutLink, ClearanceLevel) && IsInComponent(OutLink))
+	{
+		OutLocation = Location;
+		return true;
+	}
+
+	// Counted from here, so the lookup above isn't counted twice
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONMediatorLookup);
 
-	FVector Origin;
-	FVector Extent;
+	struct FCandidate
+	{
+		float DistanceSquared;
+		FSVONLink Link;
+		bool bIsLeafVoxel;
+	};
+
+	auto Closer = [](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared < B.DistanceSquared; };
+
+	const auto RadiusSquared = Radius * Radius;
+	TArray<FCandidate> Queue;
+
+	auto Push = [&](const FSVONLink& Link, const FVector& Center, float HalfSize, bool bIsLeafVoxel)
+	{
+		const auto DistanceSquared = FBox(Center - FVector(HalfSize), Center + FVector(HalfSize)).ComputeSquaredDistanceToPoint(Location);
+		if (DistanceSquared <= RadiusSquared)
+			Queue.HeapPush(FCandidate{ DistanceSquared, Link, bIsLeafVoxel }, Closer);
+	};
+
+	auto PushNode = [&](FLayerIndex LayerIndex, FNodeIndex NodeIndex)
+	{
+		FVector Center;
+		Volume.GetNodeLocation(LayerIndex, Volume.GetLayer(LayerIndex)[NodeIndex].Code, Center);
+		Push(FSVONLink(LayerIndex, NodeIndex, 0), Center, Volume.GetLayerGeometry(LayerIndex).HalfExtent, false);
+	};
+
+	const FLayerIndex RootLayer = Volume.GetNumLayers() - 1;
+	for (FNodeIndex i = 0; i < static_cast<FNodeIndex>(Volume.GetLayer(RootLayer).Num()); i++)
+		PushNode(RootLayer, i);
+
+	// Candidates come off the heap nearest first, so the first navigable one is the answer
+	FCandidate Candidate;
+	while (Queue.Num() > 0)
+	{
+		Queue.HeapPop(Candidate, Closer, false);
 
-	Box.GetCenterAndExtents(Origin, Extent);
+		const auto& Link = Candidate.Link;
+		const auto& Node = Volume.GetNode(Link);
+		auto HalfSize = Volume.GetLayerGeometry(Link.LayerIndex).HalfExtent;
 
-	// The Z-order Origin of the volume (where Code == 0)
-	auto OriginZ = Origin - Extent;
+		if (Candidate.bIsLeafVoxel || !Node.HasChildren())
+		{
+			if (!IsInComponent(Link))
+				continue;
+
+			if (Candidate.bIsLeafVoxel)
+				HalfSize *= 0.25f;
+
+			// Pull the point slightly inside, so looking it up again lands in this node rather than the blocked one beside it
+			FVector Center;
+			Volume.GetLinkLocation(Link, Center);
+			const auto Inset = FVector(HalfSize * 0.95f);
+
+			OutLink = Link;
+			OutLocation = FBox(Center - Inset, Center + Inset).GetClosestPointTo(Location);
+			return true;
+		}
+
+		if (Link.LayerIndex > 0)
+		{
+			// Children are 8 siblings in morton order
+			for (auto i = 0; i < 8; i++)
+				PushNode(Node.FirstChild.LayerIndex, Node.FirstChild.NodeIndex + i);
+
+			continue;
+		}
+
+		const auto& Leaf = Volume.GetLeafNode(Node, ClearanceLevel);
+		for (auto i = 0; i < 64; i++)
+		{
+			if (Leaf.GetNode(i))
+				continue;
+
+			const FSVONLink VoxelLink(0, Link.NodeIndex, i);
+			FVector Center;
+			Volume.GetLinkLocation(VoxelLink, Center);
+			Push(VoxelLink, Center, HalfSize * 0.25f, true);
+		}
+	}
+
+	return false;
+}
+
+void FSVONMediator::GetVolumeXYZ(const FVector& Location, const ASVONVolumeActor& Volume, const int Layer, FIntVector& OutXYZ)
+{
+	// The Z-order Origin of the volume (where Code == 0), cached by the volume whenever its bounds change
+	auto OriginZ = Volume.GetOrigin() - Volume.GetExtent();
 
 	// The local Location of the point in volume space
 	auto LocalLocation = Location - OriginZ;
@@ -130,10 +218,60 @@ void FSVONMediator::GetVolumeXYZ(const FVector& Location, const ASVONVolumeActor
 	auto LayerIndex = Layer;
 
 	// Get the Layer and Voxel size
-	auto VoxelSize = Volume.GetVoxelSize(LayerIndex);
+	auto InverseVoxelSize = 1.0f / Volume.GetVoxelSize(LayerIndex);
 	
 	// Calculate the XYZ coordinates
-	OutXYZ.X = FMath::FloorToInt((LocalLocation.X / VoxelSize));
-	OutXYZ.Y = FMath::FloorToInt((LocalLocation.Y / VoxelSize));
-	OutXYZ.Z = FMath::FloorToInt((LocalLocation.Z / VoxelSize));
+	OutXYZ.X = FMath::FloorToInt(LocalLocation.X * InverseVoxelSize);
+	OutXYZ.Y = FMath::FloorToInt(LocalLocation.Y * InverseVoxelSize);
+	OutXYZ.Z = FMath::FloorToInt(LocalLocation.Z * InverseVoxelSize);
+}
+
+bool FSVONMediator::IsLineClear(const FVector& Start, const FVector& End, const ASVONVolumeActor& Volume, uint8 ClearanceLevel, uint8 ExcludedAreas)
+{
+	FSVONLink Link;
+
+	auto IsClearAt = [&](const FVector& Location)
+	{
+		return GetLinkFromLocation(Location, Volume, Link, ClearanceLevel) && (Volume.GetAreaFlags(Link) & ExcludedAreas) == 0;
+	};
+
+	const auto Delta = End - Start;
+	const auto Length = Delta.Size();
+	if (Length < KINDA_SMALL_NUMBER)
+		return IsClearAt(Start);
+
+	const auto Direction = Delta / Length;
+
+	// Small step past each node boundary so the next lookup lands in the neighbouring node
+	const auto Epsilon = Volume.GetVoxelSize(0) * 0.25f * 0.01f;
+
+	auto Distance = 0.0f;
+	while (Distance < Length)
+	{
+		const auto Location = Start + Direction * Distance;
+		if (!IsClearAt(Location))
+			return false;
+
+		// The free node (or leaf voxel) we're in, we can skip straight to where the segment leaves it
+		FVector NodeCenter;
+		Volume.GetLinkLocation(Link, NodeCenter);
+
+		float HalfSize = Volume.GetLayerGeometry(Link.GetLayerIndex()).HalfExtent;
+		if (Link.GetLayerIndex() == 0 && Volume.GetNode(Link).HasChildren())
+			HalfSize *= 0.25f;
+
+		auto Exit = BIG_NUMBER;
+		for (auto Axis = 0; Axis < 3; Axis++)
+		{
+			if (FMath::Abs(Direction[Axis]) < KINDA_SMALL_NUMBER)
+				continue;
+
+			const auto Boundary = NodeCenter[Axis] + (Direction[Axis] > 0.0f ? HalfSize : -HalfSize);
+			Exit = FMath::Min(Exit, (Boundary - Location[Axis]) / Direction[Axis]);
+		}
+
+		Distance += FMath::Max(Exit, 0.0f) + Epsilon;
+	}
+
+	return IsClearAt(End);
 }
@@ -0,0 +1,14 @@
+#include "SVONModifierVolume.h"
+
+#include "Components/BrushComponent.h"
+
+ASVONModifierVolume::ASVONModifierVolume()
+	: AreaFlags(FSVONAreaFilter::GetFlag(ESVONAreaFlags::SAF_NoFly))
+{
+	GetBrushComponent()->Mobility = EComponentMobility::Static;
+	GetBrushComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	BrushColor = FColor(255, 160, 0, 255);
+
+	bColored = true;
+}
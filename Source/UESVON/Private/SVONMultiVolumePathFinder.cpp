@@ -0,0 +1,243 @@
+#include "SVONMultiVolumePathFinder.h"
+
+#include "SVONVolumeActor.h"
+#include "SVONMediator.h"
+#include "SVONNavigationPath.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+	TPair<int32, int32> MakeLegKey(int32 A, int32 B)
+	{
+		return A < B ? MakeTuple(A, B) : MakeTuple(B, A);
+	}
+}
+
+bool FSVONMultiVolumePathFinder::FindPath(ASVONVolumeActor& StartVolume, const FVector& StartLocation, ASVONVolumeActor& TargetVolume, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
+{
+	if (!OutPath || !OutPath->IsValid())
+		return false;
+
+	BuildRouteGraph(StartVolume, StartLocation, TargetVolume, TargetLocation);
+
+	TArray<int32> Route;
+	TArray<FSVONPathPoint> Points;
+	for (auto Attempt = 0; Attempt < MaxRoutes; Attempt++)
+	{
+		if (!FindRoute(Route))
+			break;
+
+		Points.Reset();
+		auto bIsRouteClear = true;
+		for (auto i = 0; i + 1 < Route.Num() && bIsRouteClear; i++)
+		{
+			const auto& From = Nodes[Route[i]];
+			const auto& To = Nodes[Route[i + 1]];
+
+			// Stepping through a portal, the next leg starts right where this one ended
+			if (From.Volume != To.Volume)
+				continue;
+
+			if (!FindLeg(From, To, Points))
+			{
+				FailedLegs.Add(MakeLegKey(Route[i], Route[i + 1]));
+				bIsRouteClear = false;
+			}
+		}
+
+		if (bIsRouteClear)
+		{
+			OutPath->Get()->GetPathPoints().Append(Points);
+#if WITH_EDITOR
+			UE_LOG(UESVON, Display, TEXT("Multi volume path found through %d route nodes, attempts : %d"), Route.Num(), Attempt + 1);
+#endif
+			return true;
+		}
+	}
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Multi volume pathfinding failed, %d route nodes, %d failed legs"), Nodes.Num(), FailedLegs.Num());
+#endif
+
+	return false;
+}
+
+void FSVONMultiVolumePathFinder::BuildRouteGraph(ASVONVolumeActor& StartVolume, const FVector& StartLocation, ASVONVolumeActor& TargetVolume, const FVector& TargetLocation)
+{
+	Nodes.Reset();
+	VolumeNodes.Reset();
+	FailedLegs.Reset();
+
+	auto AddNode = [&](const ASVONVolumeActor& Volume, const FVector& Location, bool bIsEndpoint)
+	{
+		FRouteNode Node;
+		Node.Volume = &Volume;
+		Node.Location = Location;
+		Node.Partner = INDEX_NONE;
+
+		// Portals are only ever placed in free space, but may be blocked for a larger clearance level. A volume not baked for
+		// an agent this big can't be passed through at all
+		const auto ClearanceLevel = Volume.GetClearanceLevel(AgentRadius);
+		if (ClearanceLevel == INDEX_NONE)
+			Node.Link.SetInvalid();
+		else if (!FSVONMediator::GetLinkFromLocation(Location, Volume, Node.Link, ClearanceLevel)
+			&& !(bIsEndpoint && NearestLinkSearchRadius > 0.0f && FSVONMediator::FindNearestNavigableLink(Location, Volume, NearestLinkSearchRadius, Node.Link, Node.Location, ClearanceLevel)))
+			Node.Link.SetInvalid();
+
+		const auto Index = Nodes.Add(Node);
+		VolumeNodes.FindOrAdd(&Volume).Add(Index);
+		return Index;
+	};
+
+	// Node 0 is the start and node 1 the target
+	AddNode(StartVolume, StartLocation, true);
+	AddNode(TargetVolume, TargetLocation, true);
+
+	struct FPortalRef
+	{
+		int32 Node;
+		const ASVONVolumeActor* Neighbor;
+		uint32 Id;
+	};
+
+	TMap<TPair<const ASVONVolumeActor*, uint32>, int32> PortalNodes;
+	TArray<FPortalRef> PortalRefs;
+
+	// Every volume reachable through portals, however far, the coarse search is cheap next to the legs
+	TArray<const ASVONVolumeActor*> Pending;
+	TSet<const ASVONVolumeActor*> Visited;
+	Pending.Add(&StartVolume);
+	Visited.Add(&StartVolume);
+	while (Pending.Num() > 0)
+	{
+		const auto Volume = Pending.Pop(false);
+		for (const auto& Portal : Volume->GetPortals())
+		{
+			const ASVONVolumeActor* Neighbor = Portal.Neighbor.Get();
+			if (!Neighbor)
+				continue;
+
+			const auto Node = AddNode(*Volume, Portal.Location, false);
+			PortalNodes.Add(MakeTuple(Volume, Portal.Id), Node);
+			PortalRefs.Add(FPortalRef{ Node, Neighbor, Portal.Id });
+
+			if (!Visited.Contains(Neighbor))
+			{
+				Visited.Add(Neighbor);
+				Pending.Add(Neighbor);
+			}
+		}
+	}
+
+	// Join the two sides of each portal
+	for (const auto& Ref : PortalRefs)
+	{
+		if (const auto Partner = PortalNodes.Find(MakeTuple(Ref.Neighbor, Ref.Id)))
+			Nodes[Ref.Node].Partner = *Partner;
+	}
+}
+
+bool FSVONMultiVolumePathFinder::FindRoute(TArray<int32>& OutRoute) const
+{
+	OutRoute.Reset();
+
+	const auto& Target = Nodes[1];
+	if (!Nodes[0].Link.IsValid() || !Target.Link.IsValid())
+		return false;
+
+	TArray<float> GScores;
+	TArray<int32> CameFrom;
+	TBitArray<> Closed(false, Nodes.Num());
+	GScores.Init(MAX_flt, Nodes.Num());
+	CameFrom.Init(INDEX_NONE, Nodes.Num());
+
+	auto Score = [&](int32 Index) { return GScores[Index] + FVector::Dist(Nodes[Index].Location, Target.Location); };
+
+	// Portals are clustered per region pair, but a volume with many neighbors still has a fair few of them
+	struct FOpenEntry
+	{
+		float Score;
+		int32 Index;
+
+		bool operator<(const FOpenEntry& Other) const { return Score < Other.Score; }
+	};
+
+	TArray<FOpenEntry> OpenHeap;
+	GScores[0] = 0.0f;
+	OpenHeap.HeapPush(FOpenEntry{ Score(0), 0 });
+
+	FOpenEntry Entry;
+	while (OpenHeap.Num() > 0)
+	{
+		// Nodes are queued again when their cost comes down, the older entries turn up after they're closed
+		OpenHeap.HeapPop(Entry, false);
+		const auto Current = Entry.Index;
+		if (Closed[Current])
+			continue;
+
+		Closed[Current] = true;
+
+		if (Current == 1)
+		{
+			for (auto Index = Current; Index != INDEX_NONE; Index = CameFrom[Index])
+				OutRoute.Add(Index);
+
+			Algo::Reverse(OutRoute);
+			return true;
+		}
+
+		const auto& Node = Nodes[Current];
+		auto Relax = [&](int32 Next, float Cost)
+		{
+			if (Closed[Next] || GScores[Current] + Cost >= GScores[Next])
+				return;
+
+			GScores[Next] = GScores[Current] + Cost;
+			CameFrom[Next] = Current;
+			OpenHeap.HeapPush(FOpenEntry{ Score(Next), Next });
+		};
+
+		// Through the portal
+		if (Node.Partner != INDEX_NONE && Nodes[Node.Partner].Link.IsValid())
+			Relax(Node.Partner, FVector::Dist(Node.Location, Nodes[Node.Partner].Location));
+
+		// Anywhere in the same region of this volume, at straight line cost
+		const auto& Connectivity = Node.Volume->GetConnectivity();
+		for (const auto Next : VolumeNodes.FindChecked(Node.Volume))
+		{
+			const auto& NextNode = Nodes[Next];
+			if (Next == Current || !NextNode.Link.IsValid() || FailedLegs.Contains(MakeLegKey(Current, Next)) || !Connectivity.AreConnected(Node.Link, NextNode.Link))
+				continue;
+
+			Relax(Next, FVector::Dist(Node.Location, NextNode.Location));
+		}
+	}
+
+	return false;
+}
+
+bool FSVONMultiVolumePathFinder::FindLeg(const FRouteNode& From, const FRouteNode& To, TArray<FSVONPathPoint>& OutPoints)
+{
+	const auto ClearanceLevel = From.Volume->GetClearanceLevel(AgentRadius);
+	if (ClearanceLevel == INDEX_NONE)
+		return false;
+
+	auto LegSettings = Settings;
+	LegSettings.ClearanceLevel = ClearanceLevel;
+
+	FSVONNavPathSharedPtr LegPath = MakeShareable(new FSVONNavigationPath());
+
+	FSVONPathFinder PathFinder(World, *From.Volume, LegSettings);
+	if (!PathFinder.FindCachedPath(From.Link, To.Link, From.Location, To.Location, &LegPath)
+		&& !PathFinder.FindPath(From.Link, To.Link, From.Location, To.Location, &LegPath))
+		return false;
+
+	// Consecutive legs share an end point
+	for (const auto& Point : LegPath->GetPathPoints())
+	{
+		if (OutPoints.Num() == 0 || !OutPoints.Last().Location.Equals(Point.Location))
+			OutPoints.Add(Point);
+	}
+
+	return true;
+}
@@ -10,9 +10,16 @@
 #include "SVONVolumeActor.h"
 #include "SVONLink.h"
 #include "SVONPathFinder.h"
+#include "SVONIncrementalPathFinder.h"
 #include "SVONNavigationPath.h"
 #include "SVONFindPathTask.h"
+#include "SVONBatchPathTask.h"
+#include "SVONWorkerPool.h"
 #include "SVONMediator.h"
+#include "SVONFlowField.h"
+#include "SVONNavigationQueryFilter.h"
+#include "SVONVolumeRegistry.h"
+#include "SVONMultiVolumePathFinder.h"
 
 // Sets default values for this component's properties
 USVONNavigationComponent::USVONNavigationComponent()
@@ -35,21 +42,44 @@ void USVONNavigationComponent::BeginPlay()
 /** Are we inside a valid nav volume ? */
 bool USVONNavigationComponent::HasNavVolume()
 {
-	return CurrentNavVolume
+	return IsValid(CurrentNavVolume)
 		&& GetOwner()
-		&& CurrentNavVolume->EncompassesPoint(GetPawnLocation())
+		&& CurrentNavVolume->ContainsPoint(GetPawnLocation())
 		&& CurrentNavVolume->GetNumLayers() > 0;
 }
 
+bool USVONNavigationComponent::HasNavVolumeForAgent()
+{
+	if (!HasNavVolume())
+		return false;
+
+	if (CurrentNavVolume->GetClearanceLevel(AgentRadius) == INDEX_NONE)
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Warning, TEXT("Agent radius %f is bigger than every clearance %s was baked for, add it to the volume's AdditionalClearances"), AgentRadius, *CurrentNavVolume->GetName());
+#endif
+		return false;
+	}
+
+	return true;
+}
+
 bool USVONNavigationComponent::FindVolume()
 {
+	// Registered volumes are loaded and ready, which is all of them once play has begun
+	if (auto Volume = FSVONVolumeRegistry::Get(GetWorld()).FindVolume(GetPawnLocation()))
+	{
+		CurrentNavVolume = Volume;
+		return true;
+	}
+
 	TArray<AActor*> NavVolumes;
 	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASVONVolumeActor::StaticClass(), NavVolumes);
 
 	for (AActor* Actor : NavVolumes)
 	{
 		auto Volume = Cast<ASVONVolumeActor>(Actor);
-		if (Volume && Volume->EncompassesPoint(GetPawnLocation()))
+		if (Volume && Volume->ContainsPoint(GetPawnLocation()))
 		{
 			CurrentNavVolume = Volume;
 			return true;
@@ -152,7 +182,7 @@ FSVONLink USVONNavigationComponent::GetNavLocation(FVector& OutLocation)
 	return NavLink;
 }
 
-bool USVONNavigationComponent::FindPathAsync(const FVector& StartLocation, const FVector& TargetLocation, FThreadSafeBool& CompleteFlag, FSVONNavPathSharedPtr* OutNavPath)
+bool USVONNavigationComponent::FindPathAsync(const FVector& StartLocation, const FVector& TargetLocation, FThreadSafeBool& CompleteFlag, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass)
 {
 #if WITH_EDITOR
 	UE_LOG(UESVON, Display, TEXT("Finding path from %s and %s"), *StartLocation.ToString(), *TargetLocation.ToString());
@@ -161,37 +191,38 @@ bool USVONNavigationComponent::FindPathAsync(const FVector& StartLocation, const
 	FSVONLink StartNavLink;
 	FSVONLink TargetNavLink;
 
-	if (HasNavVolume())
+	if (HasNavVolumeForAgent())
 	{
-		// Get the nav link from our volume
-		if (!FSVONMediator::GetLinkFromLocation(StartLocation, *CurrentNavVolume, StartNavLink))
+		// The legs of a path through other volumes are found here on the game thread, those volumes may stream out at any time
+		if (IsInOtherVolume(TargetLocation))
 		{
-#if WITH_EDITOR
-			UE_LOG(UESVON, Display, TEXT("Path finder failed to find start nav link"));
-#endif
-			return false;
+			const auto bFoundPath = FindPathAcrossVolumes(StartLocation, TargetLocation, OutNavPath, FilterClass);
+			CompleteFlag = true;
+			return bFoundPath;
 		}
 
-		if (!FSVONMediator::GetLinkFromLocation(TargetLocation, *CurrentNavVolume, TargetNavLink))
-		{
-#if WITH_EDITOR
-			UE_LOG(UESVON, Display, TEXT("Path finder failed to find target nav link"));
-#endif
+		FVector PathTargetLocation;
+		if (!GetPathEndpoints(StartLocation, TargetLocation, StartNavLink, TargetNavLink, PathTargetLocation))
 			return false;
-		}
 
 		DebugPoints.Empty();
 		PointDebugIndex = -1;
 
 		FSVONPathFinderSettings Settings;
-		Settings.bUseUnitCost = bUseUnitCost;
-		Settings.UnitCost = UnitCost;
-		Settings.WeightEstimate = WeightEstimate;
-		Settings.NodeSizeCompensation = NodeSizeCompensation;
-		Settings.PathCostType = PathCostType;
-		Settings.SmoothingIterations = SmoothingIterations;
+		GetPathFinderSettings(Settings, FilterClass);
+
+		// A cached path is ready straight away, no need to go to another thread
+		FSVONPathFinder CachePathFinder(GetWorld(), *CurrentNavVolume, Settings);
+		if (CachePathFinder.FindCachedPath(StartNavLink, TargetNavLink, StartLocation, PathTargetLocation, OutNavPath))
+		{
+#if WITH_EDITOR
+			UE_LOG(UESVON, Display, TEXT("Path cache hit"));
+#endif
+			CompleteFlag = true;
+			return true;
+		}
 
-		(new FAutoDeleteAsyncTask<FSVONFindPathTask>(*CurrentNavVolume, Settings, GetWorld(), StartNavLink, TargetNavLink, StartLocation, TargetLocation, OutNavPath, CompleteFlag, DebugPoints))->StartBackgroundTask();
+		(new FAutoDeleteAsyncTask<FSVONFindPathTask>(*CurrentNavVolume, Settings, GetWorld(), StartNavLink, TargetNavLink, StartLocation, PathTargetLocation, OutNavPath, CompleteFlag, DebugPoints))->StartBackgroundTask(FSVONWorkerPool::Get());
 
 		bIsBusy = true;
 
@@ -201,7 +232,23 @@ bool USVONNavigationComponent::FindPathAsync(const FVector& StartLocation, const
 	return false;
 }
 
-bool USVONNavigationComponent::FindPathImmediate(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath)
+bool USVONNavigationComponent::FindPathBatchAsync(FSVONPathBatchPtr Batch, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	if (!HasNavVolumeForAgent() || !Batch.IsValid())
+		return false;
+
+	FSVONPathFinderSettings Settings;
+	GetPathFinderSettings(Settings, FilterClass);
+
+	Batch->NearestLinkSearchRadius = NearestLinkSearchRadius;
+	Batch->bIsComplete = false;
+
+	(new FAutoDeleteAsyncTask<FSVONBatchPathTask>(*CurrentNavVolume, Settings, GetWorld(), Batch))->StartBackgroundTask(FSVONWorkerPool::Get());
+
+	return true;
+}
+
+bool USVONNavigationComponent::FindPathImmediate(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass)
 {
 #if WITH_EDITOR
 	UE_LOG(UESVON, Display, TEXT("Finding path immediate from %s and %s"), *StartLocation.ToString(), *TargetLocation.ToString());
@@ -209,24 +256,14 @@ bool USVONNavigationComponent::FindPathImmediate(const FVector& StartLocation, c
 
 	FSVONLink StartNavLink;
 	FSVONLink TargetNavLink;
-	if (HasNavVolume())
+	if (HasNavVolumeForAgent())
 	{
-		// Get the nav link from our volume
-		if (!FSVONMediator::GetLinkFromLocation(StartLocation, *CurrentNavVolume, StartNavLink))
-		{
-#if WITH_EDITOR
-			UE_LOG(UESVON, Display, TEXT("Path finder failed to find start nav link"));
-#endif
-			return false;
-		}
+		if (IsInOtherVolume(TargetLocation))
+			return FindPathAcrossVolumes(StartLocation, TargetLocation, OutNavPath, FilterClass);
 
-		if (!FSVONMediator::GetLinkFromLocation(TargetLocation, *CurrentNavVolume, TargetNavLink))
-		{
-#if WITH_EDITOR
-			UE_LOG(UESVON, Display, TEXT("Path finder failed to find target nav link"));
-#endif
+		FVector PathTargetLocation;
+		if (!GetPathEndpoints(StartLocation, TargetLocation, StartNavLink, TargetNavLink, PathTargetLocation))
 			return false;
-		}
 
 		if (!OutNavPath || !OutNavPath->IsValid())
 		{
@@ -245,16 +282,12 @@ bool USVONNavigationComponent::FindPathImmediate(const FVector& StartLocation, c
 		TArray<FVector> DebugOpenPoints;
 
 		FSVONPathFinderSettings Settings;
-		Settings.bUseUnitCost = bUseUnitCost;
-		Settings.UnitCost = UnitCost;
-		Settings.WeightEstimate = WeightEstimate;
-		Settings.NodeSizeCompensation = NodeSizeCompensation;
-		Settings.PathCostType = PathCostType;
-		Settings.SmoothingIterations = SmoothingIterations;
+		GetPathFinderSettings(Settings, FilterClass);
 
 		FSVONPathFinder PathFinder(GetWorld(), *CurrentNavVolume, Settings);
 
-		auto Result = PathFinder.FindPath(StartNavLink, TargetNavLink, StartLocation, TargetLocation, OutNavPath);
+		if (!PathFinder.FindCachedPath(StartNavLink, TargetNavLink, StartLocation, PathTargetLocation, OutNavPath))
+			PathFinder.FindPath(StartNavLink, TargetNavLink, StartLocation, PathTargetLocation, OutNavPath);
 
 		bIsBusy = true;
 		PointDebugIndex = 0;
@@ -267,6 +300,242 @@ bool USVONNavigationComponent::FindPathImmediate(const FVector& StartLocation, c
 	return false;
 }
 
+bool USVONNavigationComponent::FindPathIncremental(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	if (!HasNavVolumeForAgent() || !OutNavPath || !OutNavPath->IsValid())
+		return false;
+
+	if (IsInOtherVolume(TargetLocation))
+		return FindPathAcrossVolumes(StartLocation, TargetLocation, OutNavPath, FilterClass);
+
+	FSVONLink StartNavLink;
+	FSVONLink TargetNavLink;
+	FVector PathTargetLocation;
+	if (!GetPathEndpoints(StartLocation, TargetLocation, StartNavLink, TargetNavLink, PathTargetLocation))
+		return false;
+
+	auto Path = OutNavPath->Get();
+	Path->ResetForRepath();
+
+	DebugPoints.Empty();
+	PointDebugIndex = -1;
+
+	FSVONPathFinderSettings Settings;
+	GetPathFinderSettings(Settings, FilterClass);
+
+	// A new volume, agent radius or filter class is a different graph or different costs, nothing carries over
+	if (!IncrementalPathFinder.IsValid() || !IncrementalPathFinder->IsFor(*CurrentNavVolume, Settings))
+		IncrementalPathFinder = MakeShareable(new FSVONIncrementalPathFinder(GetWorld(), *CurrentNavVolume, Settings));
+
+	if (!IncrementalPathFinder->FindPath(StartNavLink, TargetNavLink, StartLocation, PathTargetLocation, OutNavPath))
+		return false;
+
+	bIsBusy = true;
+	PointDebugIndex = 0;
+
+	Path->SetIsReady(true);
+
+	return true;
+}
+
+void USVONNavigationComponent::ResetIncrementalPath()
+{
+	IncrementalPathFinder.Reset();
+}
+
+bool USVONNavigationComponent::IsInOtherVolume(const FVector& Location) const
+{
+	return bAllowCrossVolumePaths && CurrentNavVolume && !CurrentNavVolume->ContainsPoint(Location) && FSVONVolumeRegistry::Get(GetWorld()).FindVolume(Location);
+}
+
+bool USVONNavigationComponent::FindPathAcrossVolumes(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	auto TargetVolume = FSVONVolumeRegistry::Get(GetWorld()).FindVolume(TargetLocation);
+	if (!TargetVolume || !OutNavPath || !OutNavPath->IsValid())
+		return false;
+
+	auto Path = OutNavPath->Get();
+	Path->ResetForRepath();
+
+	FSVONPathFinderSettings Settings;
+	GetPathFinderSettings(Settings, FilterClass);
+
+	FSVONMultiVolumePathFinder PathFinder(GetWorld(), Settings, AgentRadius);
+	PathFinder.NearestLinkSearchRadius = NearestLinkSearchRadius;
+	if (!PathFinder.FindPath(*CurrentNavVolume, StartLocation, *TargetVolume, TargetLocation, OutNavPath))
+		return false;
+
+	Path->SetIsReady(true);
+
+	return true;
+}
+
+bool USVONNavigationComponent::FindPathFlowField(const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutNavPath, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	if (!HasNavVolumeForAgent())
+		return false;
+
+	FSVONLink StartNavLink;
+	FSVONLink TargetNavLink;
+	FVector PathTargetLocation;
+	if (!GetPathEndpoints(StartLocation, TargetLocation, StartNavLink, TargetNavLink, PathTargetLocation))
+		return false;
+
+	if (!OutNavPath || !OutNavPath->IsValid())
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Nav path data invalid"));
+#endif
+		return false;
+	}
+
+	FSVONPathFinderSettings Settings;
+	GetPathFinderSettings(Settings, FilterClass);
+
+	auto FlowField = CurrentNavVolume->GetFlowField(TargetNavLink, Settings.ClearanceLevel, Settings.AreaFilter);
+	if (!FlowField->BuildUntil(StartNavLink, FlowFieldExpansionsPerRequest))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Flow field hasn't reached the start yet"));
+#endif
+		return false;
+	}
+
+	auto Path = OutNavPath->Get();
+	Path->ResetForRepath();
+
+	FSVONPathFinder PathFinder(GetWorld(), *CurrentNavVolume, Settings);
+	if (!PathFinder.FindPathInFlowField(*FlowField, StartNavLink, StartLocation, PathTargetLocation, OutNavPath))
+		return false;
+
+	Path->SetIsReady(true);
+
+	return true;
+}
+
+bool USVONNavigationComponent::GetFlowFieldNextLocation(const FVector& Location, const FVector& TargetLocation, FVector& OutNextLocation, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	if (!HasNavVolumeForAgent())
+		return false;
+
+	FSVONLink NavLink;
+	FSVONLink TargetNavLink;
+	FVector NavLocation;
+	if (!FSVONMediator::FindNearestNavigableLink(Location, *CurrentNavVolume, NearestLinkSearchRadius, NavLink, NavLocation, GetClearanceLevel())
+		|| !FSVONMediator::FindNearestNavigableLink(TargetLocation, *CurrentNavVolume, NearestLinkSearchRadius, TargetNavLink, OutNextLocation, GetClearanceLevel()))
+		return false;
+
+	FSVONAreaFilter AreaFilter;
+	USVONNavigationQueryFilter::GetAreaFilter(FilterClass, AreaFilter);
+
+	auto FlowField = CurrentNavVolume->GetFlowField(TargetNavLink, GetClearanceLevel(), AreaFilter);
+
+	FSVONLink NextHop;
+	if (!FlowField->BuildUntil(NavLink, FlowFieldExpansionsPerRequest) || !FlowField->GetNextHop(NavLink, NextHop))
+		return false;
+
+	// At the goal the target location itself is the next hop
+	if (!(NextHop == TargetNavLink))
+		CurrentNavVolume->GetLinkLocation(NextHop, OutNextLocation);
+
+	return true;
+}
+
+int32 USVONNavigationComponent::FindGoalCosts(const FVector& StartLocation, const TArray<FVector>& GoalLocations, int32 MaxResults, TArray<FSVONGoalCost>& OutResults, TSubclassOf<UNavigationQueryFilter> FilterClass)
+{
+	OutResults.Reset();
+
+	if (!HasNavVolumeForAgent())
+		return 0;
+
+	FSVONLink StartNavLink;
+	FVector PathStartLocation;
+	if (!FSVONMediator::FindNearestNavigableLink(StartLocation, *CurrentNavVolume, NearestLinkSearchRadius, StartNavLink, PathStartLocation, GetClearanceLevel()))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Path finder failed to find start nav link"));
+#endif
+		return 0;
+	}
+
+	// Goals we can't place stay invalid, so the results still index into GoalLocations
+	TArray<FSVONLink> GoalNavLinks;
+	GoalNavLinks.SetNum(GoalLocations.Num());
+	for (auto i = 0; i < GoalLocations.Num(); i++)
+	{
+		FVector GoalLocation;
+		if (!FSVONMediator::FindNearestNavigableLink(GoalLocations[i], *CurrentNavVolume, NearestLinkSearchRadius, GoalNavLinks[i], GoalLocation, GetClearanceLevel()))
+			GoalNavLinks[i].SetInvalid();
+	}
+
+	FSVONPathFinderSettings Settings;
+	GetPathFinderSettings(Settings, FilterClass);
+
+	FSVONPathFinder PathFinder(GetWorld(), *CurrentNavVolume, Settings);
+	return PathFinder.FindGoalCosts(StartNavLink, GoalNavLinks, MaxResults, OutResults);
+}
+
+bool USVONNavigationComponent::GetPathEndpoints(const FVector& StartLocation, const FVector& TargetLocation, FSVONLink& OutStartLink, FSVONLink& OutTargetLink, FVector& OutTargetLocation)
+{
+	// Get the nav links from our volume, looking nearby if either end is blocked
+	FVector PathStartLocation;
+	if (!FSVONMediator::FindNearestNavigableLink(StartLocation, *CurrentNavVolume, NearestLinkSearchRadius, OutStartLink, PathStartLocation, GetClearanceLevel()))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Path finder failed to find start nav link"));
+#endif
+		return false;
+	}
+
+	if (!FSVONMediator::FindNearestNavigableLink(TargetLocation, *CurrentNavVolume, NearestLinkSearchRadius, OutTargetLink, OutTargetLocation, GetClearanceLevel()))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Path finder failed to find target nav link"));
+#endif
+		return false;
+	}
+
+	const auto& Connectivity = CurrentNavVolume->GetConnectivity();
+	if (Connectivity.AreConnected(OutStartLink, OutTargetLink))
+		return true;
+
+	// A search would only exhaust the start's region, so either give up now or aim for the closest point in it
+	if (!bRedirectUnreachableTarget || !FSVONMediator::FindNearestNavigableLink(TargetLocation, *CurrentNavVolume, RedirectSearchRadius, OutTargetLink, OutTargetLocation, GetClearanceLevel(), Connectivity.GetComponent(OutStartLink)))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Display, TEXT("Path finder target is unreachable from start"));
+#endif
+		return false;
+	}
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Path finder target is unreachable, redirected to %s"), *OutTargetLocation.ToString());
+#endif
+
+	return true;
+}
+
+void USVONNavigationComponent::GetPathFinderSettings(FSVONPathFinderSettings& OutSettings, TSubclassOf<UNavigationQueryFilter> FilterClass) const
+{
+	OutSettings.bUseUnitCost = bUseUnitCost;
+	OutSettings.UnitCost = UnitCost;
+	OutSettings.WeightEstimate = WeightEstimate;
+	OutSettings.NodeSizeCompensation = NodeSizeCompensation;
+	OutSettings.PathCostType = PathCostType;
+	OutSettings.SmoothingIterations = SmoothingIterations;
+	OutSettings.bUseStringPulling = bUseStringPulling;
+	OutSettings.SmoothingType = SmoothingType;
+	OutSettings.ClearanceLevel = GetClearanceLevel();
+	OutSettings.ObstacleAvoidanceWeight = ObstacleAvoidanceWeight;
+	OutSettings.ObstacleAvoidanceDistance = ObstacleAvoidanceDistance;
+	USVONNavigationQueryFilter::GetAreaFilter(FilterClass, OutSettings.AreaFilter);
+}
+
+uint8 USVONNavigationComponent::GetClearanceLevel() const
+{
+	return CurrentNavVolume ? static_cast<uint8>(FMath::Max(CurrentNavVolume->GetClearanceLevel(AgentRadius), 0)) : 0;
+}
+
 void USVONNavigationComponent::DebugLocalLocation(FVector& OutLocation) 
 {
 	if (HasNavVolume())
@@ -0,0 +1,27 @@
+#include "SVONNavigationQueryFilter.h"
+
+USVONNavigationQueryFilter::USVONNavigationQueryFilter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	const FSVONAreaFilter Defaults;
+	ExcludedAreas = Defaults.ExcludedAreas;
+	RestrictedCost = Defaults.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_Restricted)];
+	ExpensiveCost = Defaults.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_Expensive)];
+	NoFlyCost = Defaults.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_NoFly)];
+}
+
+void USVONNavigationQueryFilter::GetAreaFilter(FSVONAreaFilter& OutFilter) const
+{
+	OutFilter.ExcludedAreas = static_cast<uint8>(ExcludedAreas & ((1 << FSVONAreaFilter::NumAreas) - 1));
+	OutFilter.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_Restricted)] = RestrictedCost;
+	OutFilter.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_Expensive)] = ExpensiveCost;
+	OutFilter.CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_NoFly)] = NoFlyCost;
+}
+
+void USVONNavigationQueryFilter::GetAreaFilter(TSubclassOf<UNavigationQueryFilter> FilterClass, FSVONAreaFilter& OutFilter)
+{
+	OutFilter = FSVONAreaFilter();
+
+	if (const auto Filter = Cast<USVONNavigationQueryFilter>(FilterClass.GetDefaultObject()))
+		Filter->GetAreaFilter(OutFilter);
+}
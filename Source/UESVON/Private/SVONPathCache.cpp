@@ -0,0 +1,161 @@
+#include "SVONPathCache.h"
+
+#include "SVONStats.h"
+
+#include "Misc/ScopeLock.h"
+
+FSVONPathCache::~FSVONPathCache()
+{
+	DEC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, NumBytes);
+}
+
+void FSVONPathCache::SetCapacity(int32 InCapacity)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Set before every query, it rarely changes
+	const auto NewCapacity = FMath::Max(InCapacity, 0);
+	if (NewCapacity == Capacity)
+		return;
+
+	Capacity = NewCapacity;
+	EvictToCapacity();
+	UpdateAllocatedSize();
+}
+
+bool FSVONPathCache::Find(const FSVONPathCacheKey& Key, TArray<FSVONPathPoint>& OutPoints)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (Capacity == 0)
+		return false;
+
+	auto Entry = Entries.Find(Key);
+	if (!Entry)
+	{
+		Misses++;
+		INC_DWORD_STAT(STAT_SVONPathCacheMisses);
+		return false;
+	}
+
+	Hits++;
+	INC_DWORD_STAT(STAT_SVONPathCacheHits);
+	Entry->LastUsed = ++Clock;
+	OutPoints = Entry->Points;
+
+	return true;
+}
+
+void FSVONPathCache::Add(const FSVONPathCacheKey& Key, const TArray<FSVONPathPoint>& Points, uint32 SearchGeneration)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Disabled, or the volume changed while this path was being found
+	if (Capacity == 0 || SearchGeneration != Generation)
+		return;
+
+	auto& Entry = Entries.FindOrAdd(Key);
+	PointBytes -= Entry.Points.GetAllocatedSize();
+	Entry.Points = Points;
+	PointBytes += Entry.Points.GetAllocatedSize();
+	Entry.Bounds = FBox(ForceInit);
+	for (const auto& Point : Points)
+		Entry.Bounds += Point.Location;
+	Entry.LastUsed = ++Clock;
+
+	EvictToCapacity();
+	UpdateAllocatedSize();
+}
+
+void FSVONPathCache::Invalidate()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	Entries.Empty();
+	PointBytes = 0;
+	Generation++;
+
+	UpdateAllocatedSize();
+}
+
+void FSVONPathCache::Invalidate(const FBox& Box)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Bounds.Intersect(Box))
+		{
+			PointBytes -= It.Value().Points.GetAllocatedSize();
+			It.RemoveCurrent();
+		}
+	}
+
+	Generation++;
+
+	UpdateAllocatedSize();
+}
+
+FSVONPathCacheStats FSVONPathCache::GetStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FSVONPathCacheStats Stats;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	Stats.NumEntries = Entries.Num();
+	Stats.Capacity = Capacity;
+	Stats.MemoryBytes = NumBytes;
+
+	return Stats;
+}
+
+SIZE_T FSVONPathCache::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	return NumBytes;
+}
+
+void FSVONPathCache::EvictToCapacity()
+{
+	// Capacities are small, so a linear scan for the oldest entry is cheaper than keeping a list in order
+	while (Entries.Num() > Capacity)
+	{
+		FSVONPathCacheKey OldestKey;
+		auto OldestUsed = MAX_uint64;
+		for (const auto& Pair : Entries)
+		{
+			if (Pair.Value.LastUsed < OldestUsed)
+			{
+				OldestUsed = Pair.Value.LastUsed;
+				OldestKey = Pair.Key;
+			}
+		}
+
+		RemoveEntry(OldestKey);
+	}
+}
+
+void FSVONPathCache::RemoveEntry(const FSVONPathCacheKey& Key)
+{
+	if (const auto* Entry = Entries.Find(Key))
+		PointBytes -= Entry->Points.GetAllocatedSize();
+
+	Entries.Remove(Key);
+}
+
+void FSVONPathCache::UpdateAllocatedSize()
+{
+	const auto NewBytes = PointBytes + Entries.GetAllocatedSize();
+	if (NewBytes > NumBytes)
+	{
+		INC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, NewBytes - NumBytes);
+	}
+	else
+	{
+		DEC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, NumBytes - NewBytes);
+	}
+
+	NumBytes = NewBytes;
+}
@@ -4,152 +4,257 @@
 
 #include "SVONVolumeActor.h"
 #include "SVONNavigationPath.h"
+#include "SVONPathPostProcessor.h"
+#include "SVONPathCache.h"
+#include "SVONFlowField.h"
+#include "Algo/Reverse.h"
+
+bool FSVONPathFinder::FindCachedPath(const FSVONLink& InStart, const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
+{
+	auto& PathCache = Volume.GetPathCache();
+	if (!PathCache.IsEnabled() || !OutPath || !OutPath->IsValid())
+		return false;
+
+	TArray<FSVONPathPoint> Points;
+	if (!PathCache.Find(FSVONPathCacheKey(InStart, InGoal, Settings.GetResultHash()), Points))
+		return false;
+
+	Start = InStart;
+	Goal = InGoal;
+	FinishPath(Points, StartLocation, TargetLocation, OutPath);
+
+	return true;
+}
 
 int32 FSVONPathFinder::FindPath(const FSVONLink& InStart, const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
 {
-	OpenSet.Empty();
-	ClosedSet.Empty();
-	CameFrom.Empty();
-	FScore.Empty();
-	GScore.Empty();
-	Current = FSVONLink();
-	this->Goal = InGoal;
-	this->Start = InStart;
+	// SetupSearch decides whether obstacle avoidance is possible, so it runs before the policies are picked
+	SetupSearch(InStart, InGoal);
+	bCacheResult = true;
 
-    OpenSet.Add(InStart);
-	CameFrom.Add(InStart, InStart);
-	GScore.Add(InStart, 0);
-	FScore.Add(InStart, HeuristicScore(InStart, this->Goal)); // Distance to target
+	return DispatchCostPolicy([&](const auto& CostPolicy)
+	{
+		if (Settings.PathCostType == ESVONPathCostType::SPCT_Manhattan)
+			return SearchPath(InStart, InGoal, StartLocation, TargetLocation, OutPath, CostPolicy, FSVONManhattanHeuristic());
 
+		return SearchPath(InStart, InGoal, StartLocation, TargetLocation, OutPath, CostPolicy, FSVONEuclideanHeuristic());
+	});
+}
+
+template <typename TCostPolicy>
+void FSVONPathFinder::SearchGoalCosts(const TCostPolicy& CostPolicy, TMultiMap<FSVONLink, int32>& PendingGoals, int32 MaxResults, TArray<FSVONGoalCost>& OutResults)
+{
+	TArray<int32> SettledGoals;
 	int NumIterations = 0;
-	while (OpenSet.Num() > 0)
+	while (OpenSet.Num() > 0 && PendingGoals.Num() > 0 && OutResults.Num() < MaxResults)
 	{
-		float LowestScore = FLT_MAX;
-		for (FSVONLink& Link : OpenSet)
+		PopLowestScore();
+
+		SettledGoals.Reset();
+		PendingGoals.MultiFind(Current, SettledGoals);
+		if (SettledGoals.Num() > 0)
 		{
-			if (!FScore.Contains(Link) || FScore[Link] < LowestScore)
+			const auto Cost = GScore.FindRef(Current);
+			for (const auto GoalIndex : SettledGoals)
 			{
-				LowestScore = FScore[Link];
-				Current = Link;
+				if (OutResults.Num() < MaxResults)
+					OutResults.Emplace(GoalIndex, Cost);
 			}
-		}
 
-		OpenSet.Remove(Current);
-		ClosedSet.Add(Current);
-
-		if (Current == InGoal)
-		{
-			BuildPath(CameFrom, Current, StartLocation, TargetLocation, OutPath);
-#if WITH_EDITOR
-			UE_LOG(UESVON, Display, TEXT("Pathfinding complete, iterations : %i"), NumIterations);
-#endif
-			return 1;
+			PendingGoals.Remove(Current);
 		}
 
-		const FSVONNode& CurrentNode = Volume.GetNode(Current);
-
-		TArray<FSVONLink> Neighbors;
-		if (Current.LayerIndex == 0 && CurrentNode.FirstChild.IsValid())
-			Volume.GetLeafNeighbors(Current, Neighbors);
-		else
-			Volume.GetNeighbors(Current, Neighbors);
-
-		for (const FSVONLink& Neighbor : Neighbors)
-			ProcessLink(Neighbor);
+		ExpandCurrent(CostPolicy, FSVONZeroHeuristic());
 
 		NumIterations++;
 	}
 
+	INC_DWORD_STAT(STAT_SVONNumSearches);
+	INC_DWORD_STAT_BY(STAT_SVONNodesExpanded, NumIterations);
+
 #if WITH_EDITOR
-	UE_LOG(UESVON, Display, TEXT("Pathfinding failed, iterations : %i"), NumIterations);
+	UE_LOG(UESVON, Display, TEXT("Multi goal search reached %i goals, iterations : %i"), OutResults.Num(), NumIterations);
 #endif
-
-	return 0;
 }
 
-float FSVONPathFinder::HeuristicScore(const FSVONLink& Start, const FSVONLink& Target)
+int32 FSVONPathFinder::FindGoalCosts(const FSVONLink& InStart, const TArray<FSVONLink>& Goals, int32 MaxResults, TArray<FSVONGoalCost>& OutResults)
 {
-	/* Just using manhattan distance for now */
-	float Score = 0.f;
+	OutResults.Reset();
 
-	FVector StartLocation, EndLocation;
-	Volume.GetLinkLocation(Start, StartLocation);
-	Volume.GetLinkLocation(Target, EndLocation);
-	switch (Settings.PathCostType)
+	// Goals the start can't reach are dropped up front, if every goal is unreachable we don't expand at all
+	const auto& Connectivity = Volume.GetConnectivity();
+	TMultiMap<FSVONLink, int32> PendingGoals;
+	for (auto i = 0; i < Goals.Num(); i++)
 	{
-		case ESVONPathCostType::SPCT_Manhattan:
-			Score = FMath::Abs(EndLocation.X - StartLocation.X) + FMath::Abs(EndLocation.Y - StartLocation.Y) + FMath::Abs(EndLocation.Z - StartLocation.Z);
-			break;
-
-		case ESVONPathCostType::SPCT_Euclidean:
-		default:
-			Score = (StartLocation - EndLocation).Size();
-			break;
+		if (Goals[i].IsValid() && Connectivity.AreConnected(InStart, Goals[i]))
+			PendingGoals.Add(Goals[i], i);
 	}
-	
-	Score *= (1.0f - (static_cast<float>(Target.LayerIndex) / static_cast<float>(Volume.GetNumLayers())) * Settings.NodeSizeCompensation);
 
-	return Score;
+	if (MaxResults <= 0)
+		MaxResults = Goals.Num();
+
+	// Plain Dijkstra, there's no single goal to aim for. Goals are settled in order of cost, so the first K are the K nearest
+	ResetSearch(InStart, InStart);
+	bCacheResult = true;
+
+	DispatchCostPolicy([&](const auto& CostPolicy)
+	{
+		SearchGoalCosts(CostPolicy, PendingGoals, MaxResults, OutResults);
+	});
+
+	return OutResults.Num();
 }
 
-float FSVONPathFinder::GetCost(const FSVONLink& Start, const FSVONLink& Target)
+bool FSVONPathFinder::BuildPathToGoal(const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
 {
-	float Cost = 0.0f;
+	if (!ClosedSet.Contains(InGoal))
+		return false;
 
-	// Unit Cost implementation
-	if (Settings.bUseUnitCost)
-		Cost = Settings.UnitCost;
-	else
+	Goal = InGoal;
+	BuildPath(CameFrom, InGoal, StartLocation, TargetLocation, OutPath);
+
+	return true;
+}
+
+bool FSVONPathFinder::FindPathInFlowField(const FSVONFlowField& FlowField, const FSVONLink& InStart, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
+{
+	if (!OutPath || !OutPath->IsValid() || !FlowField.IsSettled(InStart))
+		return false;
+
+	Start = InStart;
+	Goal = FlowField.GetGoal();
+
+	// Follow the next hops to the goal. Points run goal first like BuildPath, so the start is added and the goal isn't
+	TArray<FSVONPathPoint> Points;
+	auto Link = InStart;
+	FSVONLink NextHop;
+	while (!(Link == Goal))
 	{
-		FVector StartLocation(0.f), EndLocation(0.f);
-		const FSVONNode& StartNode = Volume.GetNode(Start);
-		const FSVONNode& EndNode = Volume.GetNode(Target);
-		Volume.GetLinkLocation(Start, StartLocation);
-		Volume.GetLinkLocation(Target, EndLocation);
-		Cost = (StartLocation - EndLocation).Size();
+		AddPathPoint(Link, Points);
+
+		if (!FlowField.GetNextHop(Link, NextHop) || Points.Num() > FlowField.GetNumLinks())
+			return false;
+
+		Link = NextHop;
 	}
 
-	Cost *= (1.0f - (StaticCast<float>(Target.LayerIndex) / StaticCast<float>(Volume.GetNumLayers())) * Settings.NodeSizeCompensation);
+	Algo::Reverse(Points);
+	FinishPath(Points, StartLocation, TargetLocation, OutPath);
 
-	return Cost;
+	return true;
 }
 
-void FSVONPathFinder::ProcessLink(const FSVONLink& Neighbor)
+void FSVONPathFinder::RecordQuery(bool bSucceeded, int32 NumIterations, double StartTime) const
 {
-    if (Neighbor.IsValid())
+	FSVONQueryRecord Record;
+	Record.Start = Start;
+	Record.Goal = Goal;
+	Record.NumIterations = NumIterations;
+	Record.NumNodesReached = CameFrom.Num();
+	Record.QueueWaitMilliseconds = QueueWaitMilliseconds;
+	Record.bSucceeded = bSucceeded;
+	Record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+
+	// The path isn't built yet, so this walks back over the links the search took
+	if (bSucceeded)
 	{
-		if (ClosedSet.Contains(Neighbor))
-			return;
+		FVector Previous, Location;
+		Volume.GetLinkLocation(Goal, Previous);
+		for (auto Link = Goal; CameFrom.Contains(Link) && !(Link == CameFrom[Link]); Previous = Location)
+		{
+			Link = CameFrom[Link];
+			Volume.GetLinkLocation(Link, Location);
+			Record.PathLength += FVector::Dist(Previous, Location);
+		}
+	}
 
-		if (!OpenSet.Contains(Neighbor))
+	Record.Timestamp = FPlatformTime::Seconds();
+	Record.SearchMilliseconds = static_cast<float>((Record.Timestamp - StartTime) * 1000.0);
+
+	FSVONQueryTelemetry::Get().Record(Record);
+}
+
+void FSVONPathFinder::SwapScratch(FSVONSearchScratch& Scratch)
+{
+	Swap(OpenSet, Scratch.OpenSet);
+	Swap(ClosedSet, Scratch.ClosedSet);
+	Swap(CameFrom, Scratch.CameFrom);
+	Swap(GScore, Scratch.GScore);
+	Swap(FScore, Scratch.FScore);
+	Swap(Neighbors, Scratch.Neighbors);
+	Swap(Candidates, Scratch.Candidates);
+	Swap(CandidatePositions, Scratch.CandidatePositions);
+	Swap(CandidateHeuristics, Scratch.CandidateHeuristics);
+	Swap(PostProcessScratch, Scratch.PostProcessScratch);
+}
+
+void FSVONPathFinder::ResetSearch(const FSVONLink& InStart, const FSVONLink& InGoal)
+{
+	// Reset rather than Empty, memory from an earlier search is reused
+	OpenSet.Reset();
+	ClosedSet.Reset();
+	CameFrom.Reset();
+	FScore.Reset();
+	GScore.Reset();
+	Current = FSVONLink();
+	SetupSearch(InStart, InGoal);
+	CacheGeneration = Volume.GetPathCache().GetGeneration();
+
+	OpenSet.Add(InStart);
+	CameFrom.Add(InStart, InStart);
+	GScore.Add(InStart, 0);
+	FScore.Add(InStart, 0.0f);
+}
+
+void FSVONPathFinder::PopLowestScore()
+{
+	float LowestScore = FLT_MAX;
+	for (FSVONLink& Link : OpenSet)
+	{
+		if (!FScore.Contains(Link) || FScore[Link] < LowestScore)
 		{
-			OpenSet.Add(Neighbor);
-            if (Settings.bDebugOpenNodes)
-            {
-                FVector Location;
-                Volume.GetLinkLocation(Neighbor, Location);
-                Settings.DebugPoints.Add(Location);
-            }
+			LowestScore = FScore[Link];
+			Current = Link;
 		}
+	}
+
+	OpenSet.Remove(Current);
+	ClosedSet.Add(Current);
+}
+
+void FSVONPathFinder::SetupSearch(const FSVONLink& InStart, const FSVONLink& InGoal)
+{
+	Start = InStart;
+	Goal = InGoal;
+
+	Context.Volume = &Volume;
+	Volume.GetLinkGridPosition(Goal, Context.GoalPosition);
+	Context.GoalLayer = Goal.GetLayerIndex();
 
-		float GScore = FLT_MAX;
-		if (this->GScore.Contains(Current))
-			GScore = this->GScore[Current] + GetCost(Current, Neighbor);
-		else
-			this->GScore.Add(Current, FLT_MAX);
+	Context.GridUnitSize = Volume.GetVoxelSize(0) * 0.125f;
 
-		if (GScore >= (this->GScore.Contains(Neighbor) ? this->GScore[Neighbor] : FLT_MAX))
-			return;
+	const auto NumLayers = FMath::Max<float>(Volume.GetNumLayers(), 1.0f);
+	for (auto i = 0; i < ARRAY_COUNT(Context.LayerCostScale); i++)
+		Context.LayerCostScale[i] = 1.0f - (static_cast<float>(i) / NumLayers) * Settings.NodeSizeCompensation;
 
-		CameFrom.Add(Neighbor, Current);
-	    this->GScore.Add(Neighbor, GScore);
-	    this->FScore.Add(Neighbor, this->GScore[Neighbor] + (Settings.WeightEstimate * HeuristicScore(Neighbor, Goal)));
+	Context.UnitCost = Settings.UnitCost;
+
+	// The distance field is in leaf voxels, which are two grid units across
+	Context.ObstacleAvoidanceWeight = Settings.ObstacleAvoidanceWeight;
+	Context.ObstacleRange = 0.0f;
+	Context.InverseObstacleRange = 0.0f;
+	if (Settings.ObstacleAvoidanceWeight > 0.0f && Settings.ObstacleAvoidanceDistance > 0.0f && Volume.GetDistanceField().IsBuilt())
+	{
+		Context.ObstacleRange = Settings.ObstacleAvoidanceDistance / (Context.GridUnitSize * 2.0f);
+		Context.InverseObstacleRange = 1.0f / Context.ObstacleRange;
 	}
+
+	Context.ExcludedAreas = Settings.AreaFilter.ExcludedAreas;
+	Settings.AreaFilter.GetCostTable(Context.AreaCostScale);
 }
 
 void FSVONPathFinder::BuildPath(const TMap<FSVONLink, FSVONLink>& CameFrom, FSVONLink Current, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
 {
-	FSVONPathPoint Point;
 	TArray<FSVONPathPoint> Points;
 	if (!OutPath || !OutPath->IsValid())
 		return;
@@ -157,22 +262,32 @@ void FSVONPathFinder::BuildPath(const TMap<FSVONLink, FSVONLink>& CameFrom, FSVO
 	while (CameFrom.Contains(Current) && !(Current == CameFrom[Current]))
 	{
 		Current = CameFrom[Current];
-		Volume.GetLinkLocation(Current, Point.Location);
-        Points.Add(Point);
-		const auto& Node = Volume.GetNode(Current);
-		if (Current.GetLayerIndex() == 0)
-		{
-			if (!Node.HasChildren())
-				Points[Points.Num() - 1].Layer = 1;
-			else
-				Points[Points.Num() - 1].Layer = 0;
-		}
-		else
-		{
-			Points[Points.Num() - 1].Layer = Current.GetLayerIndex() + 1;
-		}
+		AddPathPoint(Current, Points);
 	}
 
+	auto& PathCache = Volume.GetPathCache();
+	if (PathCache.IsEnabled() && bCacheResult)
+		PathCache.Add(FSVONPathCacheKey(Start, Goal, Settings.GetResultHash()), Points, CacheGeneration);
+
+	FinishPath(Points, StartLocation, TargetLocation, OutPath);
+}
+
+void FSVONPathFinder::AddPathPoint(const FSVONLink& Link, TArray<FSVONPathPoint>& Points) const
+{
+	FSVONPathPoint Point;
+	Volume.GetLinkLocation(Link, Point.Location);
+
+	const auto& Node = Volume.GetNode(Link);
+	if (Link.GetLayerIndex() == 0)
+		Point.Layer = Node.HasChildren() ? 0 : 1;
+	else
+		Point.Layer = Link.GetLayerIndex() + 1;
+
+	Points.Add(Point);
+}
+
+void FSVONPathFinder::FinishPath(TArray<FSVONPathPoint>& Points, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath)
+{
 	if (Points.Num() > 1)
 	{
 		Points[0].Location = TargetLocation;
@@ -187,26 +302,9 @@ void FSVONPathFinder::BuildPath(const TMap<FSVONLink, FSVONLink>& CameFrom, FSVO
 		Points.Emplace(StartLocation, Start.GetLayerIndex());
 	}
 
-	//Smooth_Chaikin(Points, Settings.SmoothingIterations);
+	FSVONPathPostProcessor PostProcessor(Volume, Settings, PostProcessScratch);
+	PostProcessor.Process(Points);
 
     for (auto i = Points.Num() - 1; i >= 0; i--)
         OutPath->Get()->GetPathPoints().Add(Points[i]);
 }
-
-//void FSVONPathFinder::Smooth_Chaikin(TArray<FVector>& Points, int NumIterations)
-//{
-//	for (auto i = 0; i < NumIterations; i++)
-//	{
-//		for (int j = 0; j < Points.Num() - 1; j += 2)
-//		{
-//			FVector StartLocation = Points[j];
-//			FVector EndLocation = Points[j + 1];
-//			if (j > 0)
-//                Points[j] = FMath::Lerp(StartLocation, EndLocation, 0.25f);
-//
-//			FVector SecondValue = FMath::Lerp(StartLocation, EndLocation, 0.75f);
-//			Points.Insert(SecondValue, j + 1);
-//		}
-//		Points.RemoveAt(Points.Num() - 1);
-//	}
-//}
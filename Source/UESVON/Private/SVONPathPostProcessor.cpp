@@ -0,0 +1,159 @@
+#include "SVONPathPostProcessor.h"
+
+#include "SVONMediator.h"
+#include "SVONPathFinder.h"
+#include "SVONVolumeActor.h"
+
+void FSVONPathPostProcessor::Process(TArray<FSVONPathPoint>& InOutPoints)
+{
+	if (InOutPoints.Num() < 3)
+		return;
+
+	// Settings can come from anywhere, not just the component's clamped property
+	const auto SmoothingIterations = FMath::Clamp<int32>(Settings.SmoothingIterations, 0, MaxSmoothingIterations);
+
+	// Size both buffers for the largest pass up front, so nothing reallocates while we ping-pong between them
+	auto MaxPoints = InOutPoints.Num();
+	if (SmoothingIterations > 0)
+	{
+		switch (Settings.SmoothingType)
+		{
+		case ESVONPathSmoothingType::SPST_Chaikin:
+			MaxPoints <<= SmoothingIterations;
+			break;
+		case ESVONPathSmoothingType::SPST_CatmullRom:
+			MaxPoints = (MaxPoints - 1) * (SmoothingIterations + 1) + 1;
+			break;
+		default:
+			break;
+		}
+	}
+
+	InOutPoints.Reserve(MaxPoints);
+	Scratch.Reserve(MaxPoints);
+
+	if (Settings.bUseStringPulling)
+		StringPull(InOutPoints);
+
+	if (SmoothingIterations <= 0)
+		return;
+
+	switch (Settings.SmoothingType)
+	{
+	case ESVONPathSmoothingType::SPST_Chaikin:
+		SmoothChaikin(InOutPoints, SmoothingIterations);
+		break;
+
+	case ESVONPathSmoothingType::SPST_CatmullRom:
+		SmoothCatmullRom(InOutPoints, SmoothingIterations + 1);
+		break;
+
+	case ESVONPathSmoothingType::SPST_None:
+	default:
+		break;
+	}
+}
+
+void FSVONPathPostProcessor::StringPull(TArray<FSVONPathPoint>& InOutPoints)
+{
+	const auto NumPoints = InOutPoints.Num();
+	if (NumPoints < 3)
+		return;
+
+	Scratch.Reset();
+	Scratch.Add(InOutPoints[0]);
+
+	auto Anchor = 0;
+	while (Anchor < NumPoints - 1)
+	{
+		// Walk forward until the next point is hidden from the anchor, the last visible one is our next waypoint
+		auto Next = Anchor + 1;
+		while (Next + 1 < NumPoints && FSVONMediator::IsLineClear(InOutPoints[Anchor].Location, InOutPoints[Next + 1].Location, Volume, Settings.ClearanceLevel, Settings.AreaFilter.ExcludedAreas))
+			Next++;
+
+		Scratch.Add(InOutPoints[Next]);
+		Anchor = Next;
+	}
+
+	Swap(InOutPoints, Scratch);
+}
+
+void FSVONPathPostProcessor::SmoothChaikin(TArray<FSVONPathPoint>& InOutPoints, int32 NumIterations)
+{
+	for (auto Iteration = 0; Iteration < NumIterations; Iteration++)
+	{
+		const auto NumPoints = InOutPoints.Num();
+		if (NumPoints < 3)
+			return;
+
+		Scratch.Reset();
+		Scratch.Add(InOutPoints[0]);
+
+		for (auto i = 1; i < NumPoints - 1; i++)
+		{
+			const auto& Corner = InOutPoints[i];
+			const auto In = FMath::Lerp(InOutPoints[i - 1].Location, Corner.Location, 0.75f);
+			const auto Out = FMath::Lerp(Corner.Location, InOutPoints[i + 1].Location, 0.25f);
+
+			// The new points sit on existing segments, so only the edge that cuts the corner needs checking
+			if (FSVONMediator::IsLineClear(In, Out, Volume, Settings.ClearanceLevel, Settings.AreaFilter.ExcludedAreas))
+			{
+				Scratch.Emplace(In, Corner.Layer);
+				Scratch.Emplace(Out, Corner.Layer);
+			}
+			else
+				Scratch.Add(Corner);
+		}
+
+		Scratch.Add(InOutPoints.Last());
+
+		Swap(InOutPoints, Scratch);
+	}
+}
+
+void FSVONPathPostProcessor::SmoothCatmullRom(TArray<FSVONPathPoint>& InOutPoints, int32 NumSubdivisions)
+{
+	const auto NumPoints = InOutPoints.Num();
+	if (NumPoints < 3 || NumSubdivisions < 2)
+		return;
+
+	Scratch.Reset();
+
+	for (auto i = 0; i < NumPoints - 1; i++)
+	{
+		const auto& P0 = InOutPoints[FMath::Max(i - 1, 0)].Location;
+		const auto& P1 = InOutPoints[i].Location;
+		const auto& P2 = InOutPoints[i + 1].Location;
+		const auto& P3 = InOutPoints[FMath::Min(i + 2, NumPoints - 1)].Location;
+
+		Scratch.Add(InOutPoints[i]);
+
+		const auto SpanStart = Scratch.Num();
+		auto Previous = P1;
+		auto bIsSpanClear = true;
+
+		for (auto j = 1; j < NumSubdivisions && bIsSpanClear; j++)
+		{
+			const auto T = static_cast<float>(j) / static_cast<float>(NumSubdivisions);
+			const auto T2 = T * T;
+			const auto T3 = T2 * T;
+
+			const auto Location = 0.5f * ((2.0f * P1)
+				+ (P2 - P0) * T
+				+ (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * T2
+				+ (3.0f * P1 - P0 - 3.0f * P2 + P3) * T3);
+
+			bIsSpanClear = FSVONMediator::IsLineClear(Previous, Location, Volume, Settings.ClearanceLevel, Settings.AreaFilter.ExcludedAreas);
+			Scratch.Emplace(Location, T < 0.5f ? InOutPoints[i].Layer : InOutPoints[i + 1].Layer);
+			Previous = Location;
+		}
+
+		// If the curve clips anything, this span stays straight
+		if (!bIsSpanClear || !FSVONMediator::IsLineClear(Previous, P2, Volume, Settings.ClearanceLevel, Settings.AreaFilter.ExcludedAreas))
+			Scratch.SetNum(SpanStart, false);
+	}
+
+	Scratch.Add(InOutPoints.Last());
+
+	Swap(InOutPoints, Scratch);
+}
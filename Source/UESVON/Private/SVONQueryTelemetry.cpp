@@ -0,0 +1,181 @@
+#include "SVONQueryTelemetry.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+const int32 FSVONQueryTelemetry::Capacity;
+
+namespace
+{
+	// Set once the ring is allocated, so Find can tell without calling Get
+	volatile int32 bIsCreated = 0;
+
+	TAutoConsoleVariable<int32> CVarSVONTelemetry(
+		TEXT("svon.Telemetry"),
+		0,
+		TEXT("Keep a record of the last few thousand path searches, for svon.DumpQueries. 0 off, 1 on."));
+
+	/* Nearest rank, on values that are already sorted */
+	float GetPercentile(const TArray<float>& SortedValues, float Percentile)
+	{
+		if (SortedValues.Num() == 0)
+			return 0.0f;
+
+		const auto Rank = FMath::CeilToInt(Percentile / 100.0f * SortedValues.Num());
+		return SortedValues[FMath::Clamp(Rank, 1, SortedValues.Num()) - 1];
+	}
+
+	void DumpQueries(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		// Records are kept after svon.Telemetry is turned off, but with nothing recorded there's no ring to look in
+		const auto* Telemetry = FSVONQueryTelemetry::Find();
+		if (!Telemetry || Telemetry->GetNumRecorded() == 0)
+		{
+			Ar.Log(TEXT("Nothing recorded, set svon.Telemetry 1 first"));
+			return;
+		}
+
+		const auto NumWorst = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+		const auto BasePath = Args.Num() > 1 ? Args[1] : FPaths::ProfilingDir() / TEXT("SVON") / FString::Printf(TEXT("Queries-%s"), *FDateTime::Now().ToString());
+
+		Telemetry->WriteCSV(BasePath, NumWorst, Ar);
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpQueriesCommand(
+		TEXT("svon.DumpQueries"),
+		TEXT("Writes percentiles of the recorded path searches, and the slowest of them, to CSV. Arguments : [NumWorst=20] [BasePath]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&DumpQueries));
+}
+
+FSVONQueryTelemetry::FSVONQueryTelemetry()
+{
+	Slots.SetNumZeroed(Capacity);
+	FPlatformAtomics::InterlockedExchange(&bIsCreated, 1);
+}
+
+FSVONQueryTelemetry& FSVONQueryTelemetry::Get()
+{
+	static FSVONQueryTelemetry Instance;
+	return Instance;
+}
+
+const FSVONQueryTelemetry* FSVONQueryTelemetry::Find()
+{
+	return FPlatformAtomics::AtomicRead(&bIsCreated) != 0 ? &Get() : nullptr;
+}
+
+bool FSVONQueryTelemetry::IsEnabled()
+{
+	return CVarSVONTelemetry.GetValueOnAnyThread() != 0;
+}
+
+void FSVONQueryTelemetry::Record(const FSVONQueryRecord& Record)
+{
+	auto& Slot = Slots[(NextSlot.Increment() - 1) % Capacity];
+
+	// Only wraps onto a slot still being written if a whole ring of searches finished during one write
+	const auto Sequence = FPlatformAtomics::AtomicRead(&Slot.Sequence);
+	if ((Sequence & 1) != 0 || FPlatformAtomics::InterlockedCompareExchange(&Slot.Sequence, Sequence + 1, Sequence) != Sequence)
+	{
+		NumDropped.Increment();
+		return;
+	}
+
+	Slot.Record = Record;
+
+	// Full barrier, the record is visible before the slot reads as complete
+	FPlatformAtomics::InterlockedExchange(&Slot.Sequence, Sequence + 2);
+}
+
+void FSVONQueryTelemetry::GetRecords(TArray<FSVONQueryRecord>& OutRecords) const
+{
+	OutRecords.Reset(Capacity);
+
+	for (const auto& Slot : Slots)
+	{
+		const auto Before = FPlatformAtomics::AtomicRead(&Slot.Sequence);
+		if (Before == 0 || (Before & 1) != 0)
+			continue;
+
+		const auto Record = Slot.Record;
+		FPlatformMisc::MemoryBarrier();
+
+		if (FPlatformAtomics::AtomicRead(&Slot.Sequence) == Before)
+			OutRecords.Add(Record);
+	}
+
+	OutRecords.Sort([](const FSVONQueryRecord& A, const FSVONQueryRecord& B) { return A.Timestamp < B.Timestamp; });
+}
+
+bool FSVONQueryTelemetry::WriteCSV(const FString& BasePath, int32 NumWorst, FOutputDevice& Ar) const
+{
+	TArray<FSVONQueryRecord> Records;
+	GetRecords(Records);
+
+	TArray<float> SearchTimes, QueueWaits, Iterations, NodesReached, PathLengths;
+	auto NumSucceeded = 0;
+	for (const auto& Record : Records)
+	{
+		SearchTimes.Add(Record.SearchMilliseconds);
+		Iterations.Add(Record.NumIterations);
+		NodesReached.Add(Record.NumNodesReached);
+
+		if (Record.QueueWaitMilliseconds >= 0.0f)
+			QueueWaits.Add(Record.QueueWaitMilliseconds);
+
+		if (Record.bSucceeded)
+		{
+			PathLengths.Add(Record.PathLength);
+			NumSucceeded++;
+		}
+	}
+
+	const float Percentiles[] = { 50.0f, 90.0f, 99.0f, 99.9f, 100.0f };
+
+	FString Summary = TEXT("Metric,Count,P50,P90,P99,P99.9,Max\n");
+	auto AddRow = [&](const TCHAR* Name, TArray<float>& Values)
+	{
+		Values.Sort();
+		Summary += FString::Printf(TEXT("%s,%d"), Name, Values.Num());
+		for (const auto Percentile : Percentiles)
+			Summary += FString::Printf(TEXT(",%g"), GetPercentile(Values, Percentile));
+		Summary += TEXT("\n");
+	};
+
+	AddRow(TEXT("SearchMs"), SearchTimes);
+	AddRow(TEXT("QueueWaitMs"), QueueWaits);
+	AddRow(TEXT("Iterations"), Iterations);
+	AddRow(TEXT("NodesReached"), NodesReached);
+	AddRow(TEXT("PathLength"), PathLengths);
+
+	auto Slowest = Records;
+	Slowest.Sort([](const FSVONQueryRecord& A, const FSVONQueryRecord& B) { return A.SearchMilliseconds > B.SearchMilliseconds; });
+	Slowest.SetNum(FMath::Clamp(NumWorst, 0, Slowest.Num()));
+
+	FString Worst = TEXT("Timestamp,ThreadId,Start,Goal,StartLayer,GoalLayer,Succeeded,SearchMs,QueueWaitMs,Iterations,NodesReached,PathLength\n");
+	for (const auto& Record : Slowest)
+	{
+		Worst += FString::Printf(TEXT("%.3f,%u,%s,%s,%d,%d,%d,%g,%g,%d,%d,%g\n"),
+			Record.Timestamp, Record.ThreadId, *Record.Start.ToString(), *Record.Goal.ToString(),
+			Record.Start.GetLayerIndex(), Record.Goal.GetLayerIndex(), Record.bSucceeded ? 1 : 0,
+			Record.SearchMilliseconds, Record.QueueWaitMilliseconds, Record.NumIterations, Record.NumNodesReached, Record.PathLength);
+	}
+
+	const auto SummaryPath = BasePath + TEXT("-Percentiles.csv");
+	const auto WorstPath = BasePath + TEXT("-Worst.csv");
+	if (!FFileHelper::SaveStringToFile(Summary, *SummaryPath) || !FFileHelper::SaveStringToFile(Worst, *WorstPath))
+	{
+		Ar.Logf(TEXT("Couldn't write %s"), *BasePath);
+		return false;
+	}
+
+	Ar.Logf(TEXT("%d searches (%d succeeded, %d dropped), search ms p50 %g p99 %g max %g. Wrote %s and %s"),
+		Records.Num(), NumSucceeded, GetNumDropped(),
+		GetPercentile(SearchTimes, 50.0f), GetPercentile(SearchTimes, 99.0f), GetPercentile(SearchTimes, 100.0f),
+		*SummaryPath, *WorstPath);
+
+	return true;
+}
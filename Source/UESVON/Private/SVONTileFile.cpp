@@ -0,0 +1,43 @@
+#include "SVONTileFile.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+const uint32 FSVONTileFile::IndexMagic;
+
+bool FSVONTileFile::SaveIndex(const FString& Directory, const TArray<FIntVector>& Tiles)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes, true);
+
+	auto Magic = IndexMagic;
+	Writer << Magic;
+	Writer << const_cast<TArray<FIntVector>&>(Tiles);
+
+	return !Writer.IsError() && FFileHelper::SaveArrayToFile(Bytes, *FPaths::Combine(Directory, TEXT("Tiles.svonindex")));
+}
+
+bool FSVONTileFile::LoadIndex(const FString& Directory, TArray<FIntVector>& OutTiles)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FPaths::Combine(Directory, TEXT("Tiles.svonindex"))))
+		return false;
+
+	FMemoryReader Reader(Bytes, true);
+
+	uint32 Magic = 0;
+	Reader << Magic;
+	if (Magic != IndexMagic)
+		return false;
+
+	Reader << OutTiles;
+
+	return !Reader.IsError();
+}
+
+FString FSVONTileFile::GetTilePath(const FString& Directory, const FIntVector& Tile)
+{
+	return FPaths::Combine(Directory, FString::Printf(TEXT("Tile_%d_%d_%d.svontile"), Tile.X, Tile.Y, Tile.Z));
+}
@@ -0,0 +1,10 @@
+#include "SVONTileLoadTask.h"
+
+void FSVONTileLoadTask::DoWork()
+{
+	Load->bSucceeded = Load->Blob.LoadFile(Load->Path);
+	if (Load->bSucceeded)
+		Load->LinkIndex.Build(Load->Blob);
+
+	Load->bIsComplete = true;
+}
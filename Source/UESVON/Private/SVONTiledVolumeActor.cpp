@@ -0,0 +1,331 @@
+#include "SVONTiledVolumeActor.h"
+
+#include "SVONNavigationComponent.h"
+#include "SVONTileFile.h"
+#include "SVONVolumeActor.h"
+
+#include "Components/BrushComponent.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+ASVONTiledVolumeActor::ASVONTiledVolumeActor()
+	: Bounds(ForceInit),
+	NumTiles(FIntVector::ZeroValue)
+{
+	GetBrushComponent()->Mobility = EComponentMobility::Static;
+	GetBrushComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	BrushColor = FColor(160, 255, 160, 255);
+
+	bColored = true;
+
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ASVONTiledVolumeActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetupTiles();
+
+	TArray<FIntVector> Index;
+	if (!FSVONTileFile::LoadIndex(GetTileDirectory(), Index))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Warning, TEXT("%s has no baked tiles in %s"), *GetName(), *GetTileDirectory());
+#endif
+	}
+
+	BakedTiles.Empty(Index.Num());
+	BakedTiles.Append(Index);
+
+	// Agents spawned this frame should find their tiles straight away
+	TimeSinceUpdate = UpdateInterval;
+}
+
+void ASVONTiledVolumeActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Loads still in flight hold their own reference to the result and just finish into nothing
+	for (auto& Pair : Tiles)
+	{
+		if (Pair.Value.Volume.IsValid())
+			Pair.Value.Volume->Destroy();
+	}
+
+	Tiles.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASVONTiledVolumeActor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	FinishLoads();
+
+	TimeSinceUpdate += DeltaSeconds;
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		TimeSinceUpdate = 0.0f;
+		UpdateTiles();
+	}
+}
+
+void ASVONTiledVolumeActor::SetupTiles()
+{
+	Bounds = GetComponentsBoundingBox(true);
+
+	const auto Size = Bounds.GetSize();
+	NumTiles.X = FMath::Max(FMath::CeilToInt(Size.X / TileSize), 1);
+	NumTiles.Y = FMath::Max(FMath::CeilToInt(Size.Y / TileSize), 1);
+	NumTiles.Z = FMath::Max(FMath::CeilToInt(Size.Z / TileSize), 1);
+}
+
+FString ASVONTiledVolumeActor::GetTileDirectory() const
+{
+	return FPaths::Combine(FPaths::ProjectContentDir(), TileDirectory);
+}
+
+FBox ASVONTiledVolumeActor::GetTileBounds(const FIntVector& Tile) const
+{
+	const auto Min = Bounds.Min + FVector(Tile) * TileSize;
+	return FBox(Min, Min + FVector(TileSize));
+}
+
+FIntVector ASVONTiledVolumeActor::GetTileCoord(const FVector& Location) const
+{
+	const auto Local = (Location - Bounds.Min) / TileSize;
+	return FIntVector(
+		FMath::Clamp(FMath::FloorToInt(Local.X), 0, NumTiles.X - 1),
+		FMath::Clamp(FMath::FloorToInt(Local.Y), 0, NumTiles.Y - 1),
+		FMath::Clamp(FMath::FloorToInt(Local.Z), 0, NumTiles.Z - 1));
+}
+
+void ASVONTiledVolumeActor::UpdateTiles()
+{
+	const auto Now = GetWorld()->GetTimeSeconds();
+	const auto LoadBounds = Bounds.ExpandBy(LoadRadius);
+
+	// Every baked tile within range of a navigation component in our world
+	TSet<FIntVector> Needed;
+	for (TObjectIterator<USVONNavigationComponent> It; It; ++It)
+	{
+		if (It->GetWorld() != GetWorld() || It->IsPendingKill() || !It->GetOwner())
+			continue;
+
+		const auto Location = It->GetPawnLocation();
+		if (!LoadBounds.IsInsideOrOn(Location))
+			continue;
+
+		const auto Min = GetTileCoord(Location - FVector(LoadRadius));
+		const auto Max = GetTileCoord(Location + FVector(LoadRadius));
+		for (auto X = Min.X; X <= Max.X; X++)
+		{
+			for (auto Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				for (auto Z = Min.Z; Z <= Max.Z; Z++)
+				{
+					const FIntVector Coord(X, Y, Z);
+					if (BakedTiles.Contains(Coord))
+						Needed.Add(Coord);
+				}
+			}
+		}
+	}
+
+	for (const auto& Coord : Needed)
+	{
+		auto& Tile = Tiles.FindOrAdd(Coord);
+		Tile.LastNeeded = Now;
+
+		if (!Tile.Volume.IsValid() && !Tile.Load.IsValid())
+			StartLoad(Coord, Tile);
+	}
+
+	EvictTiles(Needed);
+}
+
+void ASVONTiledVolumeActor::StartLoad(const FIntVector& Coord, FTile& Tile)
+{
+	Tile.Load = MakeShareable(new FSVONTileLoad());
+	Tile.Load->Path = FSVONTileFile::GetTilePath(GetTileDirectory(), Coord);
+
+	(new FAutoDeleteAsyncTask<FSVONTileLoadTask>(Tile.Load))->StartBackgroundTask();
+}
+
+void ASVONTiledVolumeActor::FinishLoads()
+{
+	for (auto& Pair : Tiles)
+	{
+		auto& Tile = Pair.Value;
+		if (!Tile.Load.IsValid() || !Tile.Load->bIsComplete)
+			continue;
+
+		const auto Load = Tile.Load;
+		Tile.Load.Reset();
+
+		if (!Load->bSucceeded)
+		{
+			// Don't keep retrying a file that isn't there or is from a newer build
+#if WITH_EDITOR
+			UE_LOG(UESVON, Warning, TEXT("Failed to load SVON tile %s"), *Load->Path);
+#endif
+			BakedTiles.Remove(Pair.Key);
+			continue;
+		}
+
+		if (auto Volume = SpawnTileVolume(Pair.Key, *Load))
+		{
+			Tile.Volume = Volume;
+			Tile.NumBytes = Volume->GetAllocatedSize();
+		}
+	}
+}
+
+ASVONVolumeActor* ASVONTiledVolumeActor::SpawnTileVolume(const FIntVector& Coord, FSVONTileLoad& Load)
+{
+	const auto TileBounds = GetTileBounds(Coord);
+	const FTransform Transform(TileBounds.GetCenter());
+
+	FActorSpawnParameters Params;
+	Params.Owner = this;
+	Params.ObjectFlags |= RF_Transient;
+	Params.bDeferConstruction = true;
+
+	auto Volume = GetWorld()->SpawnActor<ASVONVolumeActor>(ASVONVolumeActor::StaticClass(), Transform, Params);
+	if (!Volume)
+		return nullptr;
+
+	// Bounds and data go in before construction finishes, so the volume's BeginPlay treats it like any baked volume and
+	// registers it, which portals it to the tiles already loaded around it. Everything derived was baked or built by the load
+	// task, so there's nothing left to compute here
+	Volume->GenerationStrategy = ESVOGenerationStrategy::SGS_UseBaked;
+	Volume->SetTileBounds(TileBounds);
+	Volume->SetBlob(MoveTemp(Load.Blob), &Load.LinkIndex);
+	Volume->FinishSpawning(Transform);
+
+	return Volume;
+}
+
+void ASVONTiledVolumeActor::EvictTiles(const TSet<FIntVector>& Needed)
+{
+	const auto Budget = static_cast<SIZE_T>(MemoryBudgetMB) * 1024 * 1024;
+	auto LoadedBytes = GetLoadedBytes();
+
+	while (LoadedBytes > Budget)
+	{
+		// Least recently needed loaded tile that nobody is near now. Tiles with searches still running on them stay until
+		// a later update finds them finished, destroying them would pull their octree out from under the workers
+		const FIntVector* Oldest = nullptr;
+		auto OldestTime = MAX_flt;
+		for (const auto& Pair : Tiles)
+		{
+			const auto& Volume = Pair.Value.Volume;
+			if (Volume.IsValid() && !Volume->HasAsyncSearches() && !Needed.Contains(Pair.Key) && Pair.Value.LastNeeded < OldestTime)
+			{
+				OldestTime = Pair.Value.LastNeeded;
+				Oldest = &Pair.Key;
+			}
+		}
+
+		if (!Oldest)
+			break;
+
+		const auto Coord = *Oldest;
+		auto& Tile = Tiles[Coord];
+		LoadedBytes -= Tile.NumBytes;
+
+		// Destroying ends play, which unregisters the volume and drops the portals to it
+		Tile.Volume->Destroy();
+		Tiles.Remove(Coord);
+	}
+}
+
+int32 ASVONTiledVolumeActor::GetNumLoadedTiles() const
+{
+	auto Count = 0;
+	for (const auto& Pair : Tiles)
+	{
+		if (Pair.Value.Volume.IsValid())
+			Count++;
+	}
+
+	return Count;
+}
+
+SIZE_T ASVONTiledVolumeActor::GetLoadedBytes() const
+{
+	SIZE_T Result = 0;
+	for (const auto& Pair : Tiles)
+	{
+		if (Pair.Value.Volume.IsValid())
+			Result += Pair.Value.NumBytes;
+	}
+
+	return Result;
+}
+
+void ASVONTiledVolumeActor::BakeTiles()
+{
+	auto World = GetWorld();
+	if (!World)
+		return;
+
+	SetupTiles();
+
+	const auto Directory = GetTileDirectory();
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	FActorSpawnParameters Params;
+	Params.ObjectFlags |= RF_Transient;
+
+	TArray<FIntVector> Baked;
+	SIZE_T TotalBytes = 0;
+
+	for (auto X = 0; X < NumTiles.X; X++)
+	{
+		for (auto Y = 0; Y < NumTiles.Y; Y++)
+		{
+			for (auto Z = 0; Z < NumTiles.Z; Z++)
+			{
+				const FIntVector Coord(X, Y, Z);
+				const auto TileBounds = GetTileBounds(Coord);
+
+				auto Volume = World->SpawnActor<ASVONVolumeActor>(ASVONVolumeActor::StaticClass(), FTransform(TileBounds.GetCenter()), Params);
+				if (!Volume)
+					continue;
+
+				// The octree goes to disk along with its connectivity and distance field, so streaming a tile in doesn't rebuild them
+				Volume->VoxelPower = TileVoxelPower;
+				Volume->CollisionChannel = CollisionChannel;
+				Volume->Clearance = Clearance;
+				Volume->AdditionalClearances = AdditionalClearances;
+				Volume->SetTileBounds(TileBounds);
+				Volume->Generate();
+
+				if (Volume->GetBlob().SaveFile(FSVONTileFile::GetTilePath(Directory, Coord)))
+				{
+					Baked.Add(Coord);
+					TotalBytes += Volume->NumBytes;
+				}
+				else
+				{
+#if WITH_EDITOR
+					UE_LOG(UESVON, Error, TEXT("Failed to write SVON tile %d %d %d"), X, Y, Z);
+#endif
+				}
+
+				Volume->Destroy();
+			}
+		}
+	}
+
+	FSVONTileFile::SaveIndex(Directory, Baked);
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Baked Tiles : %d of %d"), Baked.Num(), NumTiles.X * NumTiles.Y * NumTiles.Z);
+	UE_LOG(UESVON, Display, TEXT("Total Tile Size (bytes): %llu"), static_cast<uint64>(TotalBytes));
+#endif
+}
@@ -0,0 +1,8 @@
+#include "SVONVersion.h"
+
+#include "Serialization/CustomVersion.h"
+
+const FGuid FSVONCustomVersion::GUID(0x6A1E3C52, 0x4F0B4D27, 0x9C58A1E4, 0x3B7D2F90);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterSVONCustomVersion(FSVONCustomVersion::GUID, FSVONCustomVersion::LatestVersion, TEXT("SVONVer"));
@@ -1,16 +1,64 @@
 #include "SVONVolumeActor.h"
 
+#include "SVONDataCompression.h"
+#include "SVONModifierVolume.h"
+#include "SVONStats.h"
+#include "SVONVolumeRegistry.h"
+
+#include "EngineUtils.h"
 #include "Engine/CollisionProfile.h"
 #include "Components/BrushComponent.h"
 #include "Components/LineBatchComponent.h"
 #include "DrawDebugHelpers.h"
 #include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include <chrono>
 
 using namespace std::chrono;
 
+namespace
+{
+	// Data ids are handed out across every volume, loads may come in off the game thread
+	FThreadSafeCounter NextDataId;
+
+	double ToKB(SIZE_T Bytes)
+	{
+		return static_cast<double>(Bytes) / 1024.0;
+	}
+
+	// STAT_SVONVolumeMemory only has the total over every volume, this is where it goes
+	void DumpMemory(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World)
+			return;
+
+		SIZE_T Total = 0;
+		auto NumVolumes = 0;
+		for (TActorIterator<ASVONVolumeActor> It(World); It; ++It)
+		{
+			const auto Memory = It->GetMemory();
+			Ar.Logf(TEXT("%s : %.1f KB, blob %.1f KB (nodes %.1f, leaves %.1f, connectivity %.1f, distance field %.1f), link index %.1f KB, %d flow fields %.1f KB, path cache %.1f KB"),
+				*It->GetName(), ToKB(Memory.GetTotal()), ToKB(Memory.Blob), ToKB(Memory.Nodes), ToKB(Memory.Leaves), ToKB(Memory.Connectivity), ToKB(Memory.DistanceField),
+				ToKB(Memory.LinkIndex), Memory.NumFlowFields, ToKB(Memory.FlowFields), ToKB(Memory.PathCache));
+
+			Total += Memory.GetTotal();
+			NumVolumes++;
+		}
+
+		Ar.Logf(TEXT("%d volumes, %.1f KB"), NumVolumes, ToKB(Total));
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpMemoryCommand(
+		TEXT("svon.DumpMemory"),
+		TEXT("Logs the memory each volume holds, by what it's for, and the total over every volume"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&DumpMemory));
+}
+
 ASVONVolumeActor::ASVONVolumeActor()
-	: DebugLocation(FVector::ZeroVector)
+	: DebugLocation(FVector::ZeroVector),
+	DataId(NextDataId.Increment())
 {
 	GetBrushComponent()->Mobility = EComponentMobility::Static;
 
@@ -20,22 +68,29 @@ ASVONVolumeActor::ASVONVolumeActor()
 
 	auto Bounds = GetComponentsBoundingBox(true);
 	Bounds.GetCenterAndExtents(Origin, Extent);
+
+	UpdateLayerGeometry();
 }
 
 #if WITH_EDITOR
 void ASVONVolumeActor::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 { 
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// VoxelPower or the brush may have changed
+	SetupVolume();
 }
 
 void ASVONVolumeActor::PostEditUndo()
 {
 	Super::PostEditUndo();
+
+	SetupVolume();
 }
 
 void ASVONVolumeActor::OnPostShapeChanged()
 {
-
+	SetupVolume();
 }
 #endif // WITH_EDITOR
 
@@ -44,6 +99,8 @@ void ASVONVolumeActor::OnPostShapeChanged()
 /************************************************************************/
 bool ASVONVolumeActor::Generate()
 {
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONGenerate);
+
 #if WITH_EDITOR
 	GetWorld()->PersistentLineBatcher->SetComponentTickEnabled(false);
 
@@ -54,27 +111,52 @@ bool ASVONVolumeActor::Generate()
 		DebugLocation = GetWorld()->ViewLocationsRenderedLastFrame[0];
 
 	FlushPersistentDebugLines(GetWorld());
+#endif
 
 	SetupVolume();
-#endif
 
 #if WITH_EDITOR
 	// Setup timing
 	auto StartTime = duration_cast<milliseconds>(system_clock::now().time_since_epoch());
 #endif
 
-	// Clear data (for now)
+	// Any cached path or flow field may now be invalid
+	PathCache.Invalidate();
+	FlowFields.Empty();
+	DataId = NextDataId.Increment();
+
+	// Clear data (for now). The derived data points into the blob, so it goes first
 	BlockedIndices.Empty();
-	Data.Layers.Empty();
+	Data.Reset();
+	Connectivity.Reset();
+	DistanceField.Reset();
+	Blob.Reset();
+	LinkIndex.Reset();
 
 	NumLayers = VoxelPower + 1;
 
+	// Level 0 is Clearance, then any larger radii in ascending order
+	Data.ClearanceRadii.Empty();
+	Data.ClearanceRadii.Add(Clearance);
+	auto SortedClearances = AdditionalClearances;
+	SortedClearances.Sort();
+	for (const auto Radius : SortedClearances)
+	{
+		if (Radius > Data.ClearanceRadii.Last())
+			Data.ClearanceRadii.Add(Radius);
+	}
+
+	Data.ClearanceLeafNodes.Empty();
+	Data.ClearanceLeafNodes.SetNum(Data.ClearanceRadii.Num() - 1);
+
+	Data.AreaFlags.Empty();
+	GatherAreaModifiers();
+
 	// Rasterize at LayerIndex 1
 	FirstPassRasterize();
 
-	// Allocate the Leaf Node data
-	Data.LeafNodes.Empty();
-	Data.LeafNodes.AddDefaulted(BlockedIndices[0].Num() * 8 * 0.25f);
+	// Allocate the Leaf Node data. Leaves are added as their nodes are rasterized
+	Data.LeafNodes.Empty(BlockedIndices[0].Num() * 8 * 0.25f);
 
 	// Add layers
 	for (auto i = 0; i < NumLayers; i++)
@@ -88,6 +170,21 @@ bool ASVONVolumeActor::Generate()
 	for (auto i = NumLayers - 2; i >= 0; i--)
 		BuildNeighborLinks(i);
 
+	// Nothing blocked or tagged anywhere, which is common for tiles of open sky. A single free root covers the whole volume
+	if (BlockedIndices[0].Num() == 0 && NumLayers > 0)
+	{
+		auto& Root = Data.Layers[NumLayers - 1][Data.Layers[NumLayers - 1].Emplace()];
+		Root.Code = 0;
+	}
+
+	for (auto& ClearanceLeafNodes : Data.ClearanceLeafNodes)
+		ClearanceLeafNodes.SetNum(Data.LeafNodes.Num());
+
+	// Queries only ever read the flattened copy, the same as for baked data
+	Blob.Build(Data);
+
+	UpdateDerivedData();
+
 #if WITH_EDITOR
 	auto BuildTime = (duration_cast<milliseconds>(system_clock::now().time_since_epoch()) - StartTime).count();
 
@@ -95,32 +192,138 @@ bool ASVONVolumeActor::Generate()
 	for (auto i = 0; i < NumLayers; i++)
 		TotalNodeCount += Data.Layers[i].Num();
 
+	int32 NumBlockedLeaves = 0;
+	for (const auto& Node : Data.Layers[0])
+	{
+		if (Node.IsLeafCompletelyBlocked())
+			NumBlockedLeaves++;
+	}
+
 	auto TotalBytes = sizeof(FSVONNode) * TotalNodeCount;
-	TotalBytes += sizeof(FSVONLeafNode) * Data.LeafNodes.Num();
+	TotalBytes += sizeof(FSVONLeafNode) * Data.LeafNodes.Num() * GetNumClearanceLevels();
 
 	UE_LOG(UESVON, Display, TEXT("Generation Time : %d"), BuildTime);
 	UE_LOG(UESVON, Display, TEXT("Total Layers-Nodes : %d-%d"), NumLayers, TotalNodeCount);
 	UE_LOG(UESVON, Display, TEXT("Total Leaf Nodes : %d"), Data.LeafNodes.Num());
+	UE_LOG(UESVON, Display, TEXT("Completely Blocked Leaf Nodes : %d"), NumBlockedLeaves);
+	UE_LOG(UESVON, Display, TEXT("Clearance Levels : %d"), GetNumClearanceLevels());
+	UE_LOG(UESVON, Display, TEXT("Area Modifiers : %d"), AreaModifiers.Num());
 	UE_LOG(UESVON, Display, TEXT("Total Size (bytes): %d"), TotalBytes);
+	UE_LOG(UESVON, Display, TEXT("Flattened Size (bytes): %d"), static_cast<int32>(Blob.GetSize()));
 #endif
 
-	NumBytes = Data.GetSize();
+	AreaModifiers.Empty();
+	Data.Reset();
+
+	NumBytes = Blob.GetSize();
 
 	return true;
 }
 
 void ASVONVolumeActor::SetupVolume()
 {
-	FBox Bounds = GetComponentsBoundingBox(true);
+	FBox Bounds = HasTileBounds() ? TileBounds : GetComponentsBoundingBox(true);
 	Bounds.GetCenterAndExtents(Origin, Extent);
+
+	UpdateLayerGeometry();
+
+	PathCache.SetCapacity(bEnablePathCache ? PathCacheSize : 0);
+}
+
+void ASVONVolumeActor::UpdateDerivedData()
+{
+	Connectivity.Reset();
+	DistanceField.Reset();
+
+	// Both searches read the octree through our neighbor queries, so they run on the freshly built blob and are then baked into it
+	LinkIndex.Build(Blob);
+
+	FSVONDerivedData Derived;
+	if (bBuildConnectivity && !Blob.IsEmpty())
+		FSVONConnectivity::Build(*this, LinkIndex, Derived);
+
+	if (bBuildDistanceField && !Blob.IsEmpty())
+		FSVONDistanceField::Build(*this, LinkIndex, Derived);
+
+	Blob.SetDerivedData(Derived);
+
+	LoadDerivedData();
+}
+
+void ASVONVolumeActor::LoadDerivedData(FSVONLinkIndex* InLinkIndex)
+{
+	if (InLinkIndex)
+		LinkIndex = MoveTemp(*InLinkIndex);
+	else
+		LinkIndex.Build(Blob);
+
+	Connectivity.Reset();
+	if (bBuildConnectivity)
+		Connectivity.Load(Blob, LinkIndex);
+
+	DistanceField.Reset();
+	if (bBuildDistanceField)
+		DistanceField.Load(Blob, LinkIndex);
+
+	UpdateMemoryStat();
+}
+
+void ASVONVolumeActor::UpdateLayerGeometry()
+{
+	// Layer 0 nodes are 2 * Extent / 2^VoxelPower across, every layer above doubles that
+	const auto Power = FMath::Clamp(VoxelPower, 0, MaxLayers - 1);
+	const auto BaseVoxelSize = (Extent.X * 2.0f) / static_cast<float>(1 << Power);
+
+	for (auto i = 0; i < MaxLayers; i++)
+	{
+		auto& Geometry = LayerGeometry[i];
+		Geometry.VoxelSize = BaseVoxelSize * static_cast<float>(1 << i);
+		Geometry.HalfExtent = Geometry.VoxelSize * 0.5f;
+
+		// Layers above the root have no whole nodes
+		const auto SideShift = Power - i;
+		Geometry.NodesPerSide = SideShift >= 0 ? 1 << SideShift : 0;
+		Geometry.NodeCount = SideShift >= 0 ? static_cast<int32>(FMath::Min<int64>(1LL << (SideShift * 3), MAX_int32)) : 0;
+	}
+}
+
+void ASVONVolumeActor::GatherAreaModifiers()
+{
+	AreaModifiers.Empty();
+
+	const auto Bounds = GetBounds();
+	for (TActorIterator<ASVONModifierVolume> It(GetWorld()); It; ++It)
+	{
+		const auto ModifierBounds = It->GetComponentsBoundingBox(true);
+		if (It->GetAreaFlags() != 0 && Bounds.Intersect(ModifierBounds))
+			AreaModifiers.Emplace(ModifierBounds, It->GetAreaFlags());
+	}
+}
+
+uint8 ASVONVolumeActor::GetAreaFlagsInBox(const FBox& Box) const
+{
+	uint8 Flags = 0;
+	for (const auto& Modifier : AreaModifiers)
+	{
+		const auto& Other = Modifier.Key;
+		if (Box.Min.X < Other.Max.X && Other.Min.X < Box.Max.X
+			&& Box.Min.Y < Other.Max.Y && Other.Min.Y < Box.Max.Y
+			&& Box.Min.Z < Other.Max.Z && Other.Min.Z < Box.Max.Z)
+			Flags |= Modifier.Value;
+	}
+
+	return Flags;
 }
 
 bool ASVONVolumeActor::FirstPassRasterize()
 {
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONFirstPass);
+
 	// Add the first LayerIndex of blocking
     BlockedIndices.Emplace();
 
 	auto NumNodes = GetNodesInLayer(1);
+	const auto BoxShape = FCollisionShape::MakeBox(FVector(GetLayerGeometry(1).HalfExtent + GetMaxClearance()));
 	for (auto i = 0; i < NumNodes; i++)
 	{
 		FVector Location;
@@ -130,12 +333,17 @@ bool ASVONVolumeActor::FirstPassRasterize()
 		Params.bFindInitialOverlaps = true;
 		Params.bTraceComplex = false;
 		Params.TraceTag = "SVONFirstPassRasterize";
-		if (GetWorld()->OverlapBlockingTestByChannel(Location, FQuat::Identity, CollisionChannel, FCollisionShape::MakeBox(FVector(GetVoxelSize(1) * 0.5f)), Params))
+		// Tagged space is subdivided like blocked space, so the tags land on layer 0 nodes
+		const auto NodeExtent = FVector(GetLayerGeometry(1).HalfExtent);
+		if (GetWorld()->OverlapBlockingTestByChannel(Location, FQuat::Identity, CollisionChannel, BoxShape, Params)
+			|| GetAreaFlagsInBox(FBox(Location - NodeExtent, Location + NodeExtent)) != 0)
 			BlockedIndices[0].Add(i);
 	}
 
+	// Every ancestor of a blocked node is blocked too, right up to the root. Stopping once a layer is down to one blocked node
+	// would leave the layers above it unset
 	int32 LayerIndex = 0;
-	while (BlockedIndices[LayerIndex].Num() > 1)
+	while (LayerIndex < NumLayers - 2)
 	{
 		// Add a new LayerIndex to structure
 		BlockedIndices.Emplace();
@@ -176,7 +384,7 @@ bool ASVONVolumeActor::GetLinkLocation(const FSVONLink& Link, FVector& OutLocati
 		morton3D_64_decode(Link.SubNodeIndex, X,Y,Z);
 
 		OutLocation += FVector(X * VoxelSize * 0.25f, Y * VoxelSize * 0.25f, Z * VoxelSize * 0.25f) - FVector(VoxelSize * 0.375);
-		const FSVONLeafNode& LeafNode = GetLeafNode(Node.FirstChild.NodeIndex);
+		const FSVONLeafNode& LeafNode = GetLeafNode(Node);
 		bool bIsBlocked = LeafNode.GetNode(Link.SubNodeIndex);
 
 		return !bIsBlocked;
@@ -185,7 +393,35 @@ bool ASVONVolumeActor::GetLinkLocation(const FSVONLink& Link, FVector& OutLocati
 	return true;
 }
 
-bool ASVONVolumeActor::GetIndexForCode(FLayerIndex LayerIndex, FMortonCode Code, FNodeIndex& OutIndex) const
+// Gets the centre of a link in half leaf voxel units from the volume's morton origin. Integer only, so no voxel sizes are needed
+void ASVONVolumeActor::GetLinkGridPosition(const FSVONLink& Link, FIntVector& OutPosition) const
+{
+	const FSVONNode& Node = GetLayer(Link.LayerIndex)[Link.NodeIndex];
+
+	uint_fast32_t X, Y, Z;
+	morton3D_64_decode(Node.Code, X, Y, Z);
+
+	// Leaf voxels are one grid unit across, so their centre is the odd half unit
+	if (Link.LayerIndex == 0 && Node.FirstChild.IsValid())
+	{
+		uint_fast32_t SX, SY, SZ;
+		morton3D_64_decode(Link.SubNodeIndex, SX, SY, SZ);
+
+		OutPosition.X = static_cast<int32>((((X << 2) + SX) << 1) + 1);
+		OutPosition.Y = static_cast<int32>((((Y << 2) + SY) << 1) + 1);
+		OutPosition.Z = static_cast<int32>((((Z << 2) + SZ) << 1) + 1);
+		return;
+	}
+
+	// A node on layer N is 4 << N leaf voxels across, so its centre is (2X + 1) << (N + 2) half units
+	const auto Shift = Link.LayerIndex + 2;
+	OutPosition.X = static_cast<int32>(((X << 1) + 1) << Shift);
+	OutPosition.Y = static_cast<int32>(((Y << 1) + 1) << Shift);
+	OutPosition.Z = static_cast<int32>(((Z << 1) + 1) << Shift);
+}
+
+// Only used while generating, so it searches the layers being built rather than the flattened ones
+bool ASVONVolumeActor::GetIndexForCode(FLayerIndex LayerIndex, FMortonCode Code, FNodeIndex& OutIndex)
 {
 	const TArray<FSVONNode>& Layer = GetLayer(LayerIndex);
 
@@ -209,16 +445,35 @@ const FSVONNode& ASVONVolumeActor::GetNode(const FSVONLink& Link) const
 		return GetLayer(NumLayers - 1)[0];
 }
 
-const FSVONLeafNode& ASVONVolumeActor::GetLeafNode(FNodeIndex Index) const
+const FSVONLeafNode& ASVONVolumeActor::GetLeafNode(const FSVONNode& Node, uint8 ClearanceLevel) const
+{
+	if (Node.IsLeafCompletelyBlocked())
+		return FSVONLeafNode::Blocked;
+
+	return Blob.GetLeafNodes(ClearanceLevel)[Node.FirstChild.NodeIndex];
+}
+
+int32 ASVONVolumeActor::GetClearanceLevel(float AgentRadius) const
 {
-	return Data.LeafNodes[Index];
+	const auto ClearanceRadii = Blob.GetClearanceRadii();
+	if (ClearanceRadii.Num() == 0)
+		return 0;
+
+	for (auto i = 0; i < ClearanceRadii.Num(); i++)
+	{
+		if (AgentRadius <= ClearanceRadii[i])
+			return i;
+	}
+
+	// Paths for a smaller radius would take the agent through gaps it doesn't fit
+	return INDEX_NONE;
 }
 
-void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors) const
+void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors, uint8 ClearanceLevel) const
 {
     FMortonCode LeafIndex = Link.SubNodeIndex;
     const FSVONNode& Node = GetNode(Link);
-	const FSVONLeafNode& Leaf = GetLeafNode(Node.FirstChild.NodeIndex);
+	const FSVONLeafNode& Leaf = GetLeafNode(Node, ClearanceLevel);
 
 	// Get our starting co-ordinates
 	uint_fast32_t X = 0, Y = 0, Z = 0;
@@ -226,10 +481,10 @@ void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>
 
 	for (auto i = 0; i < 6; i++)
 	{
-		// Need to switch to signed ints
-		auto SX = X + FSVONStatics::Directions[i].X;
-		auto SY = Y + FSVONStatics::Directions[i].Y;
-		auto SZ = Z + FSVONStatics::Directions[i].Z;
+		// Signed, so stepping off the low side of the leaf goes negative rather than wrapping
+		int32 SX = static_cast<int32>(X) + FSVONStatics::Directions[i].X;
+		int32 SY = static_cast<int32>(Y) + FSVONStatics::Directions[i].Y;
+		int32 SZ = static_cast<int32>(Z) + FSVONStatics::Directions[i].Z;
 
 		// If the Neighbor is in Bounds of this Leaf Node
 		if (SX >= 0 && SX < 4 && SY >= 0 && SY < 4 && SZ >= 0 && SZ < 4)
@@ -247,6 +502,11 @@ void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>
 		else // the neighbors is out of Bounds, we need to find our Neighbor
 		{
 			const FSVONLink& NeighborLink = Node.Neighbors[i];
+
+			// Nothing on this side, we're at the edge of the volume or next to a fully blocked leaf
+			if (!NeighborLink.IsValid())
+				continue;
+
 			const FSVONNode& NeighborNode = GetNode(NeighborLink);
 
 			// If the Neighbor LayerIndex 0 has no Leaf nodes, just return it
@@ -256,7 +516,7 @@ void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>
 				continue;
 			}
 
-			const FSVONLeafNode& LeafNode = GetLeafNode(NeighborNode.FirstChild.NodeIndex);
+			const FSVONLeafNode& LeafNode = GetLeafNode(NeighborNode, ClearanceLevel);
 			if (LeafNode.IsCompletelyBlocked())
 			{
 				// The Leaf Node is completely blocked, we don't return it
@@ -281,13 +541,13 @@ void ASVONVolumeActor::GetLeafNeighbors(const FSVONLink& Link, TArray<FSVONLink>
 
 				// Only return the Neighbor if it isn't blocked!
 				if (!LeafNode.GetNode(SubNodeCode))
-					OutNeighbors.Emplace(0, NeighborNode.FirstChild.NodeIndex, SubNodeCode);
+					OutNeighbors.Emplace(0, NeighborLink.NodeIndex, SubNodeCode);
 			}
 		}
 	}
 }
 
-void ASVONVolumeActor::GetNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors) const
+void ASVONVolumeActor::GetNeighbors(const FSVONLink& Link, TArray<FSVONLink>& OutNeighbors, uint8 ClearanceLevel) const
 {
 	const FSVONNode& Node = GetNode(Link);
 	for (auto i = 0; i < 6; i++)
@@ -339,14 +599,12 @@ void ASVONVolumeActor::GetNeighbors(const FSVONLink& Link, TArray<FSVONLink>& Ou
 			}
 			else
 			{
+				// Leaf voxel links are to their layer 0 node, not to where its leaf happens to be stored
+				const auto& LeafNode = GetLeafNode(CurrentNode, ClearanceLevel);
 				for (const auto& LeafIdx : FSVONStatics::DirectionalLeafChildOffsets[i])
 				{
-					auto LeafLink = Neighbor.FirstChild;
-					const auto& LeafNode = GetLeafNode(LeafLink.NodeIndex);
-					LeafLink.SubNodeIndex = LeafIdx;
-
 					if (!LeafNode.GetNode(LeafIdx))
-						OutNeighbors.Emplace(LeafLink);
+						OutNeighbors.Emplace(0, CurrentLink.NodeIndex, LeafIdx);
 				}
 			}
 		}
@@ -359,31 +617,249 @@ void ASVONVolumeActor::Serialize(FArchive& Ar)
 
 	if (GenerationStrategy == ESVOGenerationStrategy::SGS_UseBaked)
 	{
-		Ar << Data;
+		Ar.UsingCustomVersion(FSVONCustomVersion::GUID);
+
+		// One bulk read, the views point straight into it. Older levels still go through the arrays once and are flattened
+		if (Ar.CustomVer(FSVONCustomVersion::GUID) >= FSVONCustomVersion::CompressedData)
+		{
+			// Only packages are worth the time to compress, not transactions or duplicates
+			TArray<uint8> CompressedBytes;
+			auto bIsCompressed = Ar.IsSaving() && Ar.IsPersistent() && bCompressBakedData && !Blob.IsEmpty() && CompressBlob(CompressedBytes);
+			Ar << bIsCompressed;
+
+			if (bIsCompressed)
+			{
+				Ar << CompressedBytes;
 
-		NumLayers = Data.Layers.Num();
-		NumBytes = Data.GetSize();
+				if (Ar.IsLoading())
+					DecompressBlob(CompressedBytes);
+			}
+			else
+				Ar << Blob;
+		}
+		else if (Ar.CustomVer(FSVONCustomVersion::GUID) >= FSVONCustomVersion::FlatData)
+			Ar << Blob;
+		else
+		{
+			Ar << Data;
+
+			if (Ar.IsLoading())
+			{
+				Blob.Build(Data);
+				Data.Reset();
+			}
+		}
+
+		NumLayers = Blob.GetNumLayers();
+		NumBytes = Blob.GetSize();
+
+		if (Ar.IsLoading())
+		{
+			PathCache.Invalidate();
+			FlowFields.Empty();
+			DataId = NextDataId.Increment();
+			LoadDerivedData();
+		}
 	}
 }
 
-float ASVONVolumeActor::GetVoxelSize(FLayerIndex Layer) const
+bool ASVONVolumeActor::CompressBlob(TArray<uint8>& OutBytes) const
 {
-	return (Extent.X / FMath::Pow(2, VoxelPower)) * (FMath::Pow(2.0f, Layer + 1));
+	FSVONDataCompression::Compress(Blob, OutBytes);
+
+#if WITH_EDITOR
+	const auto CompressedStart = FPlatformTime::Seconds();
+#endif
+
+	// Decompress once as a check, which doubles as a benchmark against loading the raw blob
+	FSVONDataBlob Decompressed;
+	if (!FSVONDataCompression::Decompress(OutBytes, Decompressed) || !FSVONDataCompression::AreEqual(Blob, Decompressed))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Warning, TEXT("Compressed SVON data didn't match the original, saving it raw"));
+#endif
+		return false;
+	}
+
+#if WITH_EDITOR
+	const auto CompressedTime = FPlatformTime::Seconds() - CompressedStart;
+
+	TArray<uint8> RawBytes;
+	FMemoryWriter Writer(RawBytes, true);
+	Writer << const_cast<FSVONDataBlob&>(Blob);
+
+	const auto RawStart = FPlatformTime::Seconds();
+	FMemoryReader Reader(RawBytes, true);
+	FSVONDataBlob Raw;
+	Reader << Raw;
+	const auto RawTime = FPlatformTime::Seconds() - RawStart;
+
+	UE_LOG(UESVON, Display, TEXT("Baked data raw : %d bytes, loads in %.2fms"), RawBytes.Num(), RawTime * 1000.0);
+	UE_LOG(UESVON, Display, TEXT("Baked data compressed : %d bytes, loads in %.2fms"), OutBytes.Num(), CompressedTime * 1000.0);
+#endif
+
+	return true;
 }
 
-bool ASVONVolumeActor::IsReadyForNavigation()
+void ASVONVolumeActor::DecompressBlob(const TArray<uint8>& Bytes)
 {
-	return bIsReadyForNavigation;
+#if WITH_EDITOR
+	const auto StartTime = FPlatformTime::Seconds();
+#endif
+
+	if (!FSVONDataCompression::Decompress(Bytes, Blob))
+	{
+#if WITH_EDITOR
+		UE_LOG(UESVON, Warning, TEXT("Compressed SVON data is corrupt, the volume needs rebuilding"));
+#endif
+		return;
+	}
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Decompressed %d bytes of baked data in %.2fms"), static_cast<int32>(Blob.GetSize()), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+#endif
+}
+
+bool ASVONVolumeActor::ContainsPoint(const FVector& Location) const
+{
+	if (HasTileBounds())
+		return TileBounds.IsInsideOrOn(Location);
+
+	return EncompassesPoint(Location);
+}
+
+void ASVONVolumeActor::SetTileBounds(const FBox& Bounds)
+{
+	TileBounds = Bounds;
+	SetupVolume();
+}
+
+void ASVONVolumeActor::SetBlob(FSVONDataBlob&& InBlob, FSVONLinkIndex* InLinkIndex)
+{
+	PathCache.Invalidate();
+	FlowFields.Empty();
+	Connectivity.Reset();
+	DistanceField.Reset();
+	DataId = NextDataId.Increment();
+
+	Blob = MoveTemp(InBlob);
+
+	// Layer geometry follows VoxelPower, which the data was baked with
+	NumLayers = Blob.GetNumLayers();
+	NumBytes = Blob.GetSize();
+	VoxelPower = FMath::Max(NumLayers - 1, 0);
+
+	UpdateLayerGeometry();
+	LoadDerivedData(InLinkIndex);
+}
+
+FSVONPathCache& ASVONVolumeActor::GetPathCache() const
+{
+	PathCache.SetCapacity(bEnablePathCache ? PathCacheSize : 0);
+	return PathCache;
+}
+
+SIZE_T ASVONVolumeActor::GetAllocatedSize() const
+{
+	return GetDataSize() + PathCache.GetAllocatedSize();
+}
+
+FSVONVolumeMemory ASVONVolumeActor::GetMemory() const
+{
+	FSVONVolumeMemory Memory;
+	Memory.Blob = Blob.GetSize();
+
+	for (auto i = 0; i < Blob.GetNumLayers(); i++)
+		Memory.Nodes += Blob.GetLayer(i).Num() * sizeof(FSVONNode);
+
+	for (auto i = 0; i < Blob.GetNumClearanceLevels(); i++)
+		Memory.Leaves += Blob.GetLeafNodes(i).Num() * sizeof(FSVONLeafNode);
+
+	Memory.Connectivity = (Blob.GetNodeComponents().Num() + Blob.GetLeafVoxelComponents().Num()) * sizeof(int32);
+	Memory.DistanceField = Blob.GetNodeDistances().Num() + Blob.GetLeafVoxelDistances().Num();
+
+	Memory.LinkIndex = LinkIndex.GetAllocatedSize();
+	Memory.FlowFields = FlowFields.GetAllocatedSize();
+	for (const auto& Pair : FlowFields)
+	{
+		if (Pair.Value.IsValid())
+		{
+			Memory.FlowFields += Pair.Value->GetAllocatedSize();
+			Memory.NumFlowFields++;
+		}
+	}
+
+	Memory.PathCache = PathCache.GetAllocatedSize();
+
+	return Memory;
+}
+
+SIZE_T ASVONVolumeActor::GetDataSize() const
+{
+	auto Result = Blob.GetSize() + LinkIndex.GetAllocatedSize() + FlowFields.GetAllocatedSize();
+	for (const auto& Pair : FlowFields)
+	{
+		if (Pair.Value.IsValid())
+			Result += Pair.Value->GetAllocatedSize();
+	}
+
+	return Result;
+}
+
+void ASVONVolumeActor::UpdateMemoryStat()
+{
+	const auto NewBytes = GetDataSize();
+	if (NewBytes > ReportedBytes)
+	{
+		INC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, NewBytes - ReportedBytes);
+	}
+	else
+	{
+		DEC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, ReportedBytes - NewBytes);
+	}
+
+	ReportedBytes = NewBytes;
 }
 
-int32 ASVONVolumeActor::GetNodesInLayer(FLayerIndex Layer)
+TSharedPtr<FSVONFlowField> ASVONVolumeActor::GetFlowField(const FSVONLink& Goal, uint8 ClearanceLevel, const FSVONAreaFilter& AreaFilter)
 {
-	return FMath::Pow(FMath::Pow(2, (VoxelPower - (Layer))), 3);
+	const auto Key = MakeTuple(Goal, ClearanceLevel, AreaFilter.GetHash());
+
+	auto& FlowField = FlowFields.FindOrAdd(Key);
+	if (!FlowField.IsValid())
+	{
+		FlowField = MakeShareable(new FSVONFlowField(*this, Goal, ClearanceLevel, AreaFilter));
+
+		// Fields hold a few bytes per link, so keep only a handful
+		while (FlowFields.Num() > FMath::Max(FlowFieldCacheSize, 1))
+		{
+			auto OldestKey = Key;
+			auto OldestUsed = MAX_uint64;
+			for (const auto& Pair : FlowFields)
+			{
+				if (Pair.Value.IsValid() && Pair.Value->LastUsed < OldestUsed && !(Pair.Key == Key))
+				{
+					OldestUsed = Pair.Value->LastUsed;
+					OldestKey = Pair.Key;
+				}
+			}
+
+			FlowFields.Remove(OldestKey);
+		}
+	}
+
+	auto Result = FlowFields.FindChecked(Key);
+	Result->LastUsed = ++FlowFieldClock;
+
+	// Fields grow as callers step them, so this also picks up the steps since the last call
+	UpdateMemoryStat();
+
+	return Result;
 }
 
-int32 ASVONVolumeActor::GetNodesPerSide(FLayerIndex Layer)
+bool ASVONVolumeActor::IsReadyForNavigation()
 {
-	return FMath::Pow(2, (VoxelPower - (Layer)));
+	return bIsReadyForNavigation;
 }
 
 void ASVONVolumeActor::BeginPlay()
@@ -391,14 +867,48 @@ void ASVONVolumeActor::BeginPlay()
 	if (!bIsReadyForNavigation && GenerationStrategy == ESVOGenerationStrategy::SGS_GenerateOnBeginPlay)
 		Generate();
 	else
+	{
 		SetupVolume();
 
+		// Baked data carries its own labels and distances, loaded along with it
+#if WITH_EDITOR
+		if (!Blob.IsEmpty() && ((bBuildConnectivity && !Connectivity.IsBuilt()) || (bBuildDistanceField && !DistanceField.IsBuilt())))
+			UE_LOG(UESVON, Warning, TEXT("%s was baked without its connectivity or distance field, generate it again to add them"), *GetName());
+#endif
+	}
+
 	bIsReadyForNavigation = true;
+
+	FSVONVolumeRegistry::Get(GetWorld()).Register(*this);
+}
+
+void ASVONVolumeActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Streaming out only drops our own portals, the other volumes are untouched
+	FSVONVolumeRegistry::Get(GetWorld()).Unregister(*this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASVONVolumeActor::BeginDestroy()
+{
+	DEC_MEMORY_STAT_BY(STAT_SVONVolumeMemory, ReportedBytes);
+	ReportedBytes = 0;
+
+	Super::BeginDestroy();
+}
+
+void ASVONVolumeActor::RemovePortalsTo(const ASVONVolumeActor* Neighbor)
+{
+	Portals.RemoveAll([Neighbor](const FSVONPortal& Portal) { return !Portal.Neighbor.IsValid() || Portal.Neighbor.Get() == Neighbor; });
 }
 
 void ASVONVolumeActor::PostRegisterAllComponents()
 {
 	Super::PostRegisterAllComponents();
+
+	// Bounds are only valid once the brush is registered
+	SetupVolume();
 }
 
 void ASVONVolumeActor::PostUnregisterAllComponents()
@@ -408,6 +918,8 @@ void ASVONVolumeActor::PostUnregisterAllComponents()
 
 void ASVONVolumeActor::BuildNeighborLinks(FLayerIndex LayerIndex)
 {
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONNeighborLinks);
+
 	auto& Layer = GetLayer(LayerIndex);
 	auto SearchLayerIndex = LayerIndex;
 
@@ -502,7 +1014,7 @@ bool ASVONVolumeActor::FindLinkInDirection(FLayerIndex LayerIndex, const FNodeIn
             if (LayerIndex == 0 && Node.HasChildren())
             {
                 // Set invalid link if the Leaf Node is completely blocked, no point linking to it
-                if (GetLeafNode(Node.FirstChild.NodeIndex).IsCompletelyBlocked())
+                if (Node.IsLeafCompletelyBlocked() || Data.LeafNodes[Node.FirstChild.NodeIndex].IsCompletelyBlocked())
                 {
                     OutLinkToUpdate.SetInvalid();
                     return true;
@@ -533,22 +1045,31 @@ bool ASVONVolumeActor::FindLinkInDirection(FLayerIndex LayerIndex, const FNodeIn
 	return false;
 }
 
-void ASVONVolumeActor::RasterizeLeafNode(FVector& Origin, FNodeIndex LeafIndex)
+// Fills one bitboard per clearance level, which must start out empty
+void ASVONVolumeActor::RasterizeLeafNode(const FVector& Origin, TArray<FSVONLeafNode>& OutLeaves)
 {
+	const float LeafVoxelSize = GetVoxelSize(0) * 0.25f;
+
 	for (auto i = 0; i < 64; i++)
 	{
 		uint_fast32_t X, Y, Z;
 		morton3D_64_decode(i, X, Y, Z);
-
-		float LeafVoxelSize = GetVoxelSize(0) * 0.25f;
 		FVector Location = Origin + FVector(X * LeafVoxelSize, Y * LeafVoxelSize, Z * LeafVoxelSize) + FVector(LeafVoxelSize * 0.5f);
 
-		if (LeafIndex >= Data.LeafNodes.Num() - 1)
-			Data.LeafNodes.AddDefaulted(1);
+		// Blocked at one radius means blocked at every larger one, so test from the largest down and stop at the first clear level
+		auto bIsBlocked = true;
+		for (auto Level = OutLeaves.Num() - 1; Level > 0 && bIsBlocked; Level--)
+		{
+			bIsBlocked = IsBlocked(Location, LeafVoxelSize * 0.5f, Data.ClearanceRadii[Level]);
+			if (!bIsBlocked)
+				break;
 
-		if(IsBlocked(Location, LeafVoxelSize * 0.5f))
+			OutLeaves[Level].SetNode(i);
+		}
+
+		if (bIsBlocked && IsBlocked(Location, LeafVoxelSize * 0.5f, Clearance))
 		{
-			Data.LeafNodes[LeafIndex].SetNode(i);
+			OutLeaves[0].SetNode(i);
 
 			if (bShowLeafVoxels && IsInDebugRange(Location))
 				DrawDebugBox(GetWorld(), Location, FVector(LeafVoxelSize * 0.5f), FQuat::Identity, FColor::Red, true, -1.f, 0, .0f);
@@ -561,9 +1082,9 @@ TArray<FSVONNode>& ASVONVolumeActor::GetLayer(FLayerIndex LayerIndex)
 	return Data.Layers[LayerIndex];
 }
 
-const TArray<FSVONNode>& ASVONVolumeActor::GetLayer(FLayerIndex LayerIndex) const
+TArrayView<const FSVONNode> ASVONVolumeActor::GetLayer(FLayerIndex LayerIndex) const
 {
-	return Data.Layers[LayerIndex];
+	return Blob.GetLayer(LayerIndex);
 }
 
 // Check for blocking...using this cached set for each LayerIndex for now for fast lookups
@@ -580,14 +1101,14 @@ bool ASVONVolumeActor::IsAnyMemberBlocked(FLayerIndex LayerIndex, FMortonCode Co
 	return false;
 }
 
-bool ASVONVolumeActor::IsBlocked(const FVector& Location, const float Size) const
+bool ASVONVolumeActor::IsBlocked(const FVector& Location, const float Size, const float AgentClearance) const
 {
 	FCollisionQueryParams Params;
 	Params.bFindInitialOverlaps = true;
 	Params.bTraceComplex = false;
 	Params.TraceTag = "SVONLeafRasterize";
 
-	return GetWorld()->OverlapBlockingTestByChannel(Location, FQuat::Identity, CollisionChannel, FCollisionShape::MakeBox(FVector(Size + Clearance)), Params);
+	return GetWorld()->OverlapBlockingTestByChannel(Location, FQuat::Identity, CollisionChannel, FCollisionShape::MakeBox(FVector(Size + AgentClearance)), Params);
 }
 
 bool ASVONVolumeActor::IsInDebugRange(const FVector& Location) const
@@ -602,10 +1123,15 @@ bool ASVONVolumeActor::SetNeighbor(const FLayerIndex LayerIndex, const FNodeInde
 
 void ASVONVolumeActor::RasterizeLayer(FLayerIndex LayerIndex)
 {
-    FNodeIndex LeafIndex = 0;
     // LayerIndex 0 Leaf nodes are special
     if (LayerIndex == 0)
     {
+        SVON_SCOPE_CYCLE_COUNTER(STAT_SVONRasterizeLeaves);
+
+        // One bitboard per clearance level, reused for every node
+        TArray<FSVONLeafNode> Leaves;
+        Leaves.SetNum(Data.ClearanceRadii.Num());
+
         // Run through all our coordinates
         auto NumNodes = GetNodesInLayer(LayerIndex);
         for (auto i = 0; i < NumNodes; i++)
@@ -625,12 +1151,15 @@ void ASVONVolumeActor::RasterizeLayer(FLayerIndex LayerIndex)
                 FVector NodeLocation;
                 GetNodeLocation(LayerIndex, Node.Code, NodeLocation);
 
+                const auto NodeExtent = FVector(GetLayerGeometry(LayerIndex).HalfExtent);
+                Data.AreaFlags.Add(GetAreaFlagsInBox(FBox(NodeLocation - NodeExtent, NodeLocation + NodeExtent)));
+
                 // Debug stuff
                 if (bShowMortonCodes && IsInDebugRange(NodeLocation))
                     DrawDebugString(GetWorld(), NodeLocation, FString::FromInt(Node.Code), nullptr, FSVONStatics::LayerColors[LayerIndex], -1, false);
 
                 if (bShowVoxels && IsInDebugRange(NodeLocation))
-                    DrawDebugBox(GetWorld(), NodeLocation, FVector(GetVoxelSize(LayerIndex) * 0.5f), FQuat::Identity, FSVONStatics::LayerColors[LayerIndex], true, -1.f, 0, .0f);
+                    DrawDebugBox(GetWorld(), NodeLocation, FVector(GetLayerGeometry(LayerIndex).HalfExtent), FQuat::Identity, FSVONStatics::LayerColors[LayerIndex], true, -1.f, 0, .0f);
 
                 // Now check if we have any blocking, and search Leaf nodes
                 FVector Location;
@@ -641,28 +1170,47 @@ void ASVONVolumeActor::RasterizeLayer(FLayerIndex LayerIndex)
                 Params.bTraceComplex = false;
                 Params.TraceTag = "SVONRasterize";
 
-                if (IsBlocked(Location, GetVoxelSize(0) * 0.5f))
+                for (auto& Leaf : Leaves)
+                    Leaf.VoxelGrid = 0;
+
+                const auto bHasLeaf = IsBlocked(Location, GetLayerGeometry(0).HalfExtent, GetMaxClearance());
+                if (bHasLeaf)
                 {
                     // Rasterize my Leaf nodes
-                    FVector LeafOrigin = NodeLocation - (FVector(GetVoxelSize(LayerIndex) * 0.5f));
-                    RasterizeLeafNode(LeafOrigin, LeafIndex);
-                    Node.FirstChild.LayerIndex = 0;
-                    Node.FirstChild.NodeIndex = LeafIndex;
-                    Node.FirstChild.SubNodeIndex = 0;
-                    LeafIndex++;
+                    FVector LeafOrigin = NodeLocation - (FVector(GetLayerGeometry(LayerIndex).HalfExtent));
+                    RasterizeLeafNode(LeafOrigin, Leaves);
                 }
-                else
+
+                if (bElideUniformLeaves && Leaves[0].IsCompletelyBlocked())
+                {
+                    // Blocked for the smallest radius is blocked for every radius, so all of these share one leaf
+                    Node.FirstChild = FSVONLink(0, 0, FSVONNode::BlockedLeafFlag);
+                }
+                else if (bElideUniformLeaves && Leaves.Last().IsEmpty())
                 {
-                    Data.LeafNodes.AddDefaulted(1);
-                    LeafIndex++;
+                    // Likewise clear for the largest radius is clear for every radius, which is just a free node
                     Node.FirstChild.SetInvalid();
                 }
+                else
+                {
+                    // Without elision every node keeps a leaf at its own index, empty if it had nothing to rasterize
+                    const auto LeafIndex = Data.LeafNodes.Add(Leaves[0]);
+                    for (auto Level = 1; Level < Leaves.Num(); Level++)
+                        Data.ClearanceLeafNodes[Level - 1].Add(Leaves[Level]);
+
+                    if (bHasLeaf)
+                        Node.FirstChild = FSVONLink(0, LeafIndex, 0);
+                    else
+                        Node.FirstChild.SetInvalid();
+                }
             }
         }
     }
     // Deal with the other layers
     else if (GetLayer(LayerIndex - 1).Num() > 1)
     {
+        SVON_SCOPE_CYCLE_COUNTER(STAT_SVONRasterizeLayer);
+
         int32 NodeCounter = 0;
         int32 NumNodes = GetNodesInLayer(LayerIndex);
         for (auto i = 0; i < NumNodes; i++)
@@ -709,7 +1257,7 @@ void ASVONVolumeActor::RasterizeLayer(FLayerIndex LayerIndex)
 
                     // Debug stuff
                     if (bShowVoxels && IsInDebugRange(NodeLocation))
-                        DrawDebugBox(GetWorld(), NodeLocation, FVector(GetVoxelSize(LayerIndex) * 0.5f), FQuat::Identity, FSVONStatics::LayerColors[LayerIndex], true, -1.f, 0, .0f);
+                        DrawDebugBox(GetWorld(), NodeLocation, FVector(GetLayerGeometry(LayerIndex).HalfExtent), FQuat::Identity, FSVONStatics::LayerColors[LayerIndex], true, -1.f, 0, .0f);
 
                     if (bShowMortonCodes && IsInDebugRange(NodeLocation))
                         DrawDebugString(GetWorld(), NodeLocation, FString::FromInt(Node.Code), nullptr, FSVONStatics::LayerColors[LayerIndex], -1, false);
@@ -0,0 +1,175 @@
+#include "SVONVolumeRegistry.h"
+
+#include "SVONVolumeActor.h"
+#include "SVONMediator.h"
+#include "SVONLink.h"
+
+uint32 FSVONVolumeRegistry::NextPortalId = 1;
+TMap<const UWorld*, FSVONVolumeRegistry> FSVONVolumeRegistry::Registries;
+
+namespace
+{
+	// Caps the samples for a pair of volumes, the spacing doubles until the shared region fits
+	const int32 MaxPortalSamples = 4096;
+
+	// Portals kept per connected region pair along each axis of the shared region. A face between two volumes gets up to 16
+	const int32 PortalCellsPerAxis = 4;
+
+	FVector ClampToBox(const FVector& Location, const FBox& Box)
+	{
+		return FVector(
+			FMath::Clamp(Location.X, Box.Min.X, Box.Max.X),
+			FMath::Clamp(Location.Y, Box.Min.Y, Box.Max.Y),
+			FMath::Clamp(Location.Z, Box.Min.Z, Box.Max.Z));
+	}
+}
+
+FSVONVolumeRegistry& FSVONVolumeRegistry::Get(const UWorld* World)
+{
+	return Registries.FindOrAdd(World);
+}
+
+void FSVONVolumeRegistry::Register(ASVONVolumeActor& Volume)
+{
+	// Volumes destroyed without unregistering, say with their world, leave stale entries behind
+	Volumes.RemoveAll([](const TWeakObjectPtr<ASVONVolumeActor>& Other) { return !Other.IsValid(); });
+
+	// Registering again, after a rebuild, replaces the old portals
+	Unregister(Volume);
+
+	auto NumPortals = 0;
+	if (Volume.bConnectToAdjacentVolumes)
+	{
+		for (const auto& Other : Volumes)
+		{
+			if (Other->bConnectToAdjacentVolumes)
+				BuildPortals(Volume, *Other);
+		}
+
+		NumPortals = Volume.GetPortals().Num();
+	}
+
+	Volumes.Emplace(&Volume);
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Registered volume %s, %d portals to %d other volumes"), *Volume.GetName(), NumPortals, Volumes.Num() - 1);
+#endif
+}
+
+void FSVONVolumeRegistry::Unregister(ASVONVolumeActor& Volume)
+{
+	Volumes.Remove(TWeakObjectPtr<ASVONVolumeActor>(&Volume));
+
+	for (const auto& Other : Volumes)
+	{
+		if (Other.IsValid())
+			Other->RemovePortalsTo(&Volume);
+	}
+
+	Volume.ClearPortals();
+}
+
+ASVONVolumeActor* FSVONVolumeRegistry::FindVolume(const FVector& Location) const
+{
+	for (const auto& Volume : Volumes)
+	{
+		if (Volume.IsValid() && Volume->ContainsPoint(Location))
+			return Volume.Get();
+	}
+
+	return nullptr;
+}
+
+void FSVONVolumeRegistry::BuildPortals(ASVONVolumeActor& A, ASVONVolumeActor& B)
+{
+	if (A.GetNumLayers() == 0 || B.GetNumLayers() == 0)
+		return;
+
+	const auto BoundsA = A.GetBounds();
+	const auto BoundsB = B.GetBounds();
+
+	// Half a leaf voxel of the finer volume, so volumes whose faces just touch still share a thin slab
+	const auto Margin = FMath::Min(A.GetVoxelSize(0), B.GetVoxelSize(0)) * 0.125f;
+
+	const FBox Shared(BoundsA.Min.ComponentMax(BoundsB.Min) - FVector(Margin), BoundsA.Max.ComponentMin(BoundsB.Max) + FVector(Margin));
+	if (Shared.Min.X > Shared.Max.X || Shared.Min.Y > Shared.Max.Y || Shared.Min.Z > Shared.Max.Z)
+		return;
+
+	// One sample per layer 0 node of the coarser volume, unless either asks for something else
+	auto Spacing = FMath::Max(A.PortalSpacing, B.PortalSpacing);
+	if (Spacing <= 0.0f)
+		Spacing = FMath::Max(A.GetVoxelSize(0), B.GetVoxelSize(0));
+
+	const auto SharedSize = Shared.GetSize();
+	FIntVector Counts;
+	do
+	{
+		Counts.X = FMath::Max(FMath::FloorToInt(SharedSize.X / Spacing), 1);
+		Counts.Y = FMath::Max(FMath::FloorToInt(SharedSize.Y / Spacing), 1);
+		Counts.Z = FMath::Max(FMath::FloorToInt(SharedSize.Z / Spacing), 1);
+		Spacing *= 2.0f;
+	} while (static_cast<int64>(Counts.X) * Counts.Y * Counts.Z > MaxPortalSamples);
+
+	const FVector Step(SharedSize.X / Counts.X, SharedSize.Y / Counts.Y, SharedSize.Z / Counts.Z);
+
+	// Samples are pulled just inside each volume, so the lookups don't land on the boundary
+	const FBox InnerA(BoundsA.Min + FVector(Margin), BoundsA.Max - FVector(Margin));
+	const FBox InnerB(BoundsB.Min + FVector(Margin), BoundsB.Max - FVector(Margin));
+
+	// Samples only add a choice to the route planner where they join different regions, or the same regions somewhere else
+	// along the boundary. Keep the one nearest the middle of each cell of each region pair, so portals per pair stay bounded
+	// however fine the sampling
+	const auto CellSize = FMath::Max(SharedSize.GetMax() / PortalCellsPerAxis, KINDA_SMALL_NUMBER);
+
+	struct FCandidate
+	{
+		FVector LocationA;
+		FVector LocationB;
+		float DistanceToCell;
+	};
+
+	TMap<TTuple<int32, int32, FIntVector>, FCandidate> Clusters;
+
+	const auto& ConnectivityA = A.GetConnectivity();
+	const auto& ConnectivityB = B.GetConnectivity();
+
+	for (auto X = 0; X < Counts.X; X++)
+	{
+		for (auto Y = 0; Y < Counts.Y; Y++)
+		{
+			for (auto Z = 0; Z < Counts.Z; Z++)
+			{
+				const auto Sample = Shared.Min + (FVector(X, Y, Z) + FVector(0.5f)) * Step;
+				const auto LocationA = ClampToBox(Sample, InnerA);
+				const auto LocationB = ClampToBox(Sample, InnerB);
+
+				FSVONLink LinkA, LinkB;
+				if (!FSVONMediator::GetLinkFromLocation(LocationA, A, LinkA) || !FSVONMediator::GetLinkFromLocation(LocationB, B, LinkB))
+					continue;
+
+				const auto Local = (Sample - Shared.Min) / CellSize;
+				const FIntVector Cell(
+					FMath::Min(FMath::FloorToInt(Local.X), PortalCellsPerAxis - 1),
+					FMath::Min(FMath::FloorToInt(Local.Y), PortalCellsPerAxis - 1),
+					FMath::Min(FMath::FloorToInt(Local.Z), PortalCellsPerAxis - 1));
+
+				const auto DistanceToCell = FVector::DistSquared(Sample, Shared.Min + (FVector(Cell) + FVector(0.5f)) * CellSize);
+
+				// Without connectivity every link reads as InvalidComponent, which just clusters by cell
+				const auto Key = MakeTuple(ConnectivityA.GetComponent(LinkA), ConnectivityB.GetComponent(LinkB), Cell);
+				auto Candidate = Clusters.Find(Key);
+				if (!Candidate)
+					Clusters.Add(Key, FCandidate{ LocationA, LocationB, DistanceToCell });
+				else if (DistanceToCell < Candidate->DistanceToCell)
+					*Candidate = FCandidate{ LocationA, LocationB, DistanceToCell };
+			}
+		}
+	}
+
+	for (const auto& Pair : Clusters)
+	{
+		const auto Id = NextPortalId++;
+		A.AddPortal(FSVONPortal(Id, &B, Pair.Value.LocationA, Pair.Value.LocationB));
+		B.AddPortal(FSVONPortal(Id, &A, Pair.Value.LocationB, Pair.Value.LocationA));
+	}
+}
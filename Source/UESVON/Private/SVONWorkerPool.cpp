@@ -0,0 +1,72 @@
+#include "SVONWorkerPool.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/QueuedThreadPool.h"
+
+FQueuedThreadPool* FSVONWorkerPool::Pool = nullptr;
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarSVONWorkerThreads(
+		TEXT("svon.Workers.NumThreads"),
+		2,
+		TEXT("Threads dedicated to SVON path searches, read when the first search is queued. 0 shares the engine's thread pool instead."));
+
+	TAutoConsoleVariable<int32> CVarSVONWorkerPriority(
+		TEXT("svon.Workers.Priority"),
+		1,
+		TEXT("Priority of the SVON path search threads. 0 normal, 1 below normal, 2 lowest, 3 above normal."));
+
+	// Searches keep their open and closed sets on the heap, the stack only sees the call chain
+	const uint32 WorkerStackSize = 128 * 1024;
+
+	EThreadPriority GetWorkerPriority()
+	{
+		switch (CVarSVONWorkerPriority.GetValueOnGameThread())
+		{
+		case 0:
+			return TPri_Normal;
+		case 2:
+			return TPri_Lowest;
+		case 3:
+			return TPri_AboveNormal;
+		default:
+			return TPri_BelowNormal;
+		}
+	}
+}
+
+FQueuedThreadPool* FSVONWorkerPool::Get()
+{
+	check(IsInGameThread());
+
+	if (Pool)
+		return Pool;
+
+	const auto NumThreads = CVarSVONWorkerThreads.GetValueOnGameThread();
+	if (NumThreads <= 0 || !FPlatformProcess::SupportsMultithreading())
+		return GThreadPool;
+
+	Pool = FQueuedThreadPool::Allocate();
+	if (!Pool->Create(NumThreads, WorkerStackSize, GetWorkerPriority()))
+	{
+		delete Pool;
+		Pool = nullptr;
+
+		return GThreadPool;
+	}
+
+	return Pool;
+}
+
+void FSVONWorkerPool::Shutdown()
+{
+	if (!Pool)
+		return;
+
+	// Searches are non-abandonable, so anything still queued runs here before the threads go
+	Pool->Destroy();
+	delete Pool;
+	Pool = nullptr;
+}
@@ -1,10 +1,58 @@
 #include "UESVON.h"
 
+#include "SVONStats.h"
+#include "SVONWorkerPool.h"
+
 #if WITH_EDITOR
 DEFINE_LOG_CATEGORY(UESVON);
 DEFINE_LOG_CATEGORY(VUESVON);
 #endif
 
+DEFINE_STAT(STAT_SVONGenerate);
+DEFINE_STAT(STAT_SVONFirstPass);
+DEFINE_STAT(STAT_SVONRasterizeLeaves);
+DEFINE_STAT(STAT_SVONRasterizeLayer);
+DEFINE_STAT(STAT_SVONNeighborLinks);
+DEFINE_STAT(STAT_SVONFindPath);
+DEFINE_STAT(STAT_SVONMediatorLookup);
+DEFINE_STAT(STAT_SVONNumSearches);
+DEFINE_STAT(STAT_SVONNumRepairs);
+DEFINE_STAT(STAT_SVONNodesExpanded);
+DEFINE_STAT(STAT_SVONOpenSetPeak);
+DEFINE_STAT(STAT_SVONAsyncQueueWait);
+DEFINE_STAT(STAT_SVONPathCacheHits);
+DEFINE_STAT(STAT_SVONPathCacheMisses);
+DEFINE_STAT(STAT_SVONNumVolumeBlobs);
+DEFINE_STAT(STAT_SVONVolumeMemory);
+
+#if SVON_TRACE_ENABLED && CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(SVONChannel);
+#endif
+
+void SVONReportOpenSetPeak(int32 OpenSetPeak)
+{
+#if STATS
+	// Frame number in the high half, that frame's peak in the low half. Counter stats clear every frame, so the peak does too
+	static volatile int64 FramePeak = 0;
+
+	const auto Frame = static_cast<int64>(GFrameCounter & MAX_uint32) << 32;
+	const auto Peak = static_cast<int64>(FMath::Max(OpenSetPeak, 0));
+
+	auto Current = FramePeak;
+	while ((Current & ~static_cast<int64>(MAX_uint32)) != Frame || (Current & MAX_uint32) < Peak)
+	{
+		const auto Previous = FPlatformAtomics::InterlockedCompareExchange(&FramePeak, Frame | Peak, Current);
+		if (Previous == Current)
+		{
+			SET_DWORD_STAT(STAT_SVONOpenSetPeak, OpenSetPeak);
+			return;
+		}
+
+		Current = Previous;
+	}
+#endif
+}
+
 #define LOCTEXT_NAMESPACE "FUESVONModule"
 
 void FUESVONModule::StartupModule()
@@ -16,6 +64,7 @@ void FUESVONModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FSVONWorkerPool::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -110,6 +110,9 @@ protected:
 	void RequestPath();
 	void RequestPathAsync();
 
+	/* Goal tracking with a component that keeps its search, so each new path repairs the last one */
+	bool ShouldRepairPath() const;
+
 	void RequestMove();
 
 	void HandleAsyncPathTaskComplete();
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ThreadSafeBool.h"
+
+#include "SVONNavigationPath.h"
+#include "SVONPathFinder.h"
+
+class ASVONVolumeActor;
+
+/* Where one query's path sits in FSVONPathBatch::Points, start first. No points if it failed */
+struct FSVONPathSpan
+{
+	int32 FirstPoint;
+	int32 NumPoints;
+	bool bSucceeded;
+
+	FSVONPathSpan()
+		: FirstPoint(0),
+		NumPoints(0),
+		bSucceeded(false) {}
+};
+
+/*
+ * Many start/target pairs solved in one job. Every path goes into the one Points array, so a batch of short hops costs
+ * a handful of allocations rather than a shared path object each.
+ */
+struct UESVON_API FSVONPathBatch
+{
+	TArray<FVector> StartLocations;
+	TArray<FVector> TargetLocations;
+
+	/* How far to look for a navigable link when a start or target is blocked. Components set their own when queueing */
+	float NearestLinkSearchRadius;
+
+	/* One per query, in the order they were added */
+	TArray<FSVONPathSpan> Spans;
+	TArray<FSVONPathPoint> Points;
+
+	FThreadSafeBool bIsComplete;
+
+	FSVONPathBatch()
+		: NearestLinkSearchRadius(0.0f) {}
+
+	/* Returns the query's index */
+	int32 Add(const FVector& StartLocation, const FVector& TargetLocation);
+
+	int32 Num() const { return StartLocations.Num(); }
+
+	/* Only valid once the batch is complete */
+	TArrayView<const FSVONPathPoint> GetPath(int32 QueryIndex) const;
+
+	/* Drops the queries and results, keeping the memory for the next batch */
+	void Reset();
+};
+
+typedef TSharedPtr<FSVONPathBatch, ESPMode::ThreadSafe> FSVONPathBatchPtr;
+
+/* Solves a batch with one path finder, so every query after the first reuses its warmed up containers */
+class UESVON_API FSVONBatchPathFinder
+{
+public:
+	FSVONBatchPathFinder(UWorld* World, const ASVONVolumeActor& Volume, FSVONPathFinderSettings& Settings)
+		: Volume(Volume),
+		Settings(Settings),
+		PathFinder(World, Volume, Settings) { }
+
+	/*
+	 * Fills the batch's spans and points. Queries are searched in morton order of their start, so consecutive searches
+	 * touch nearby nodes, but results are stored in the order the queries were added.
+	 */
+	void Solve(FSVONPathBatch& Batch);
+
+	/* See FSVONPathFinder::SwapScratch */
+	void SwapScratch(FSVONSearchScratch& Scratch) { PathFinder.SwapScratch(Scratch); }
+
+private:
+	const ASVONVolumeActor& Volume;
+	FSVONPathFinderSettings& Settings;
+	FSVONPathFinder PathFinder;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Async/AsyncWork.h"
+#include "SVONBatchPathFinder.h"
+#include "SVONVolumeActor.h"
+
+class FSVONBatchPathTask 
+    : public FNonAbandonableTask
+{
+	friend class FAutoDeleteAsyncTask<FSVONBatchPathTask>;
+
+public:
+	FSVONBatchPathTask(ASVONVolumeActor& Volume, const FSVONPathFinderSettings& Settings, UWorld* World, FSVONPathBatchPtr Batch)
+		: Volume(Volume),
+		Settings(Settings),
+		World(World),
+		Batch(Batch)
+	{
+		Volume.BeginAsyncSearch();
+	}
+
+	~FSVONBatchPathTask() { Volume.EndAsyncSearch(); }
+
+protected:
+	ASVONVolumeActor& Volume;
+	FSVONPathFinderSettings Settings;
+	UWorld* World;
+
+	FSVONPathBatchPtr Batch;
+
+	void DoWork();
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FSVONBatchPathTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+};
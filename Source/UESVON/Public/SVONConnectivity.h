@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONLink.h"
+
+class ASVONVolumeActor;
+class FSVONDataBlob;
+struct FSVONDerivedData;
+struct FSVONLinkIndex;
+
+/* Connected component labels over the free space of a volume, so unreachable pairs can be rejected without a search. Built
+   once when the volume is generated and baked into its blob, then read from there */
+class UESVON_API FSVONConnectivity
+{
+public:
+	static const int32 InvalidComponent = -1;
+
+	/* Labels every free node and leaf voxel, using the same neighbor queries as the path finder, into the derived data */
+	static void Build(const ASVONVolumeActor& Volume, const FSVONLinkIndex& Index, FSVONDerivedData& OutData);
+
+	/* Points at the labels baked into the blob, which along with the index has to outlive us. Stays unbuilt if the blob
+	   has none, or they weren't built for this octree */
+	void Load(const FSVONDataBlob& Blob, const FSVONLinkIndex& InIndex);
+
+	void Reset();
+
+	bool IsBuilt() const { return NodeComponents.Num() > 0; }
+
+	int32 GetNumComponents() const { return NumComponents; }
+
+	/* Component of a navigable link, InvalidComponent if it's blocked, not navigable or unknown */
+	int32 GetComponent(const FSVONLink& Link) const;
+
+	/* True if the links may be connected. Links we have no labels for are assumed connected */
+	bool AreConnected(const FSVONLink& A, const FSVONLink& B) const;
+
+private:
+	const FSVONLinkIndex* Index = nullptr;
+
+	// Label per node, in index order. Nodes with children are InvalidComponent, except on layer 0 where a leaf whose free
+	// voxels all share a component stores it directly, and a split leaf stores -(Index + 2) into LeafVoxelComponents
+	TArrayView<const int32> NodeComponents;
+
+	// 64 labels per split leaf, in morton order
+	TArrayView<const int32> LeafVoxelComponents;
+
+	int32 NumComponents = 0;
+};
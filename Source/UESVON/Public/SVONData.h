@@ -4,6 +4,7 @@
 
 #include "SVONNode.h"
 #include "SVONLeafNode.h"
+#include "SVONVersion.h"
 
 struct FSVONData
 {
@@ -11,16 +12,31 @@ public:
 	TArray<TArray<FSVONNode>> Layers;
 	TArray<FSVONLeafNode> LeafNodes;
 
+	// Agent radius each clearance level was baked for, smallest first. Level 0 is LeafNodes
+	TArray<float> ClearanceRadii;
+
+	// Leaf bitboards for levels 1 and up, each parallel to LeafNodes
+	TArray<TArray<FSVONLeafNode>> ClearanceLeafNodes;
+
+	// ESVONAreaFlags bits per layer 0 node, parallel to Layers[0]. Their leaf voxels share them
+	TArray<uint8> AreaFlags;
+
 	void Reset()
 	{
 		Layers.Empty();
 		LeafNodes.Empty();
+		ClearanceRadii.Empty();
+		ClearanceLeafNodes.Empty();
+		AreaFlags.Empty();
 	}
 
 	int32 GetSize()
 	{
 		auto Result = 0;
 		Result += LeafNodes.Num() * sizeof(FSVONLeafNode);
+		for (auto i = 0; i < ClearanceLeafNodes.Num(); i++)
+			Result += ClearanceLeafNodes[i].Num() * sizeof(FSVONLeafNode);
+		Result += AreaFlags.Num() * sizeof(uint8);
 		for (auto i = 0; i < Layers.Num(); i++)
 			Result += Layers[i].Num() * sizeof(FSVONNode);
 		return Result;
@@ -29,7 +45,26 @@ public:
 
 FORCEINLINE FArchive& operator<<(FArchive& Ar, FSVONData& Data)
 {
+	Ar.UsingCustomVersion(FSVONCustomVersion::GUID);
+
 	Ar << Data.Layers;
 	Ar << Data.LeafNodes;
+
+	if (Ar.CustomVer(FSVONCustomVersion::GUID) >= FSVONCustomVersion::ClearanceLevels)
+	{
+		Ar << Data.ClearanceRadii;
+		Ar << Data.ClearanceLeafNodes;
+	}
+	else if (Ar.IsLoading())
+	{
+		Data.ClearanceRadii.Empty();
+		Data.ClearanceLeafNodes.Empty();
+	}
+
+	if (Ar.CustomVer(FSVONCustomVersion::GUID) >= FSVONCustomVersion::AreaFlags)
+		Ar << Data.AreaFlags;
+	else if (Ar.IsLoading())
+		Data.AreaFlags.Init(0, Data.Layers.Num() > 0 ? Data.Layers[0].Num() : 0);
+
 	return Ar;
 }
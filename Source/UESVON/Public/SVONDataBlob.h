@@ -0,0 +1,147 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "Templates/UniquePtr.h"
+
+#include "SVONData.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/* What's built from the octree rather than generated with it. Baked into the blob with the octree, so loading it never has to
+   run the searches again. Arrays that weren't built are left empty */
+struct UESVON_API FSVONDerivedData
+{
+	// See FSVONConnectivity
+	TArray<int32> NodeComponents;
+	TArray<int32> LeafVoxelComponents;
+	int32 NumComponents = 0;
+
+	// See FSVONDistanceField
+	TArray<uint8> NodeDistances;
+	TArray<uint8> LeafVoxelDistances;
+};
+
+/* Baked octree as one flat buffer. Every array of FSVONData, and of the data derived from it, is a section at an aligned
+   offset behind a small header, so the buffer is read from disk or mapped in a single call and used where it lies, with no
+   per-node deserialization. Nodes are stored in memory layout, the header records the layout it was written with and
+   buffers from another layout are rejected */
+class UESVON_API FSVONDataBlob
+{
+public:
+	static const int32 Alignment = 16;
+
+	FSVONDataBlob();
+	~FSVONDataBlob();
+
+	FSVONDataBlob(FSVONDataBlob&& Other);
+	FSVONDataBlob& operator=(FSVONDataBlob&& Other);
+
+	/* Flattens the arrays into a new buffer */
+	void Build(const FSVONData& Data);
+
+	/* A new zeroed buffer with sections of these sizes, for decoders to fill in place through the mutable views. The derived
+	   sizes are in the order of FSVONDerivedData's arrays, zero for none */
+	void Allocate(const TArray<int32>& LayerSizes, int32 NumLeafNodes, int32 NumClearanceLevels, int32 NumClearanceRadii, int32 NumAreaFlags, const TArray<int32>& DerivedSizes = TArray<int32>());
+
+	/* Copies the octree into a new buffer with the derived data alongside it, replacing any there was */
+	void SetDerivedData(const FSVONDerivedData& Derived);
+
+	/* Maps the file where the platform supports it, otherwise reads it in one go. False, and empty, if it isn't a valid blob */
+	bool LoadFile(const FString& Path);
+	bool SaveFile(const FString& Path) const;
+
+	void Reset();
+	bool IsEmpty() const { return GetNumLayers() == 0; }
+
+	int32 GetNumLayers() const;
+	TArrayView<const FSVONNode> GetLayer(int32 Layer) const;
+
+	/* At least 1, level 0 is the leaf bitboards the octree was built with */
+	int32 GetNumClearanceLevels() const;
+	TArrayView<const FSVONLeafNode> GetLeafNodes(int32 ClearanceLevel = 0) const;
+	TArrayView<const float> GetClearanceRadii() const;
+	TArrayView<const uint8> GetAreaFlags() const;
+
+	TArrayView<const int32> GetNodeComponents() const;
+	TArrayView<const int32> GetLeafVoxelComponents() const;
+	int32 GetNumComponents() const;
+	TArrayView<const uint8> GetNodeDistances() const;
+	TArrayView<const uint8> GetLeafVoxelDistances() const;
+
+	/* Only for buffers we own, never a mapped file */
+	TArrayView<FSVONNode> GetMutableLayer(int32 Layer);
+	TArrayView<FSVONLeafNode> GetMutableLeafNodes(int32 ClearanceLevel);
+	TArrayView<float> GetMutableClearanceRadii();
+	TArrayView<uint8> GetMutableAreaFlags();
+	TArrayView<int32> GetMutableNodeComponents();
+	TArrayView<int32> GetMutableLeafVoxelComponents();
+	void SetNumComponents(int32 NumComponents);
+	TArrayView<uint8> GetMutableNodeDistances();
+	TArrayView<uint8> GetMutableLeafVoxelDistances();
+
+	/* Bytes of the whole buffer, mapped or not */
+	SIZE_T GetSize() const { return static_cast<SIZE_T>(Size); }
+
+	friend UESVON_API FArchive& operator<<(FArchive& Ar, FSVONDataBlob& Blob);
+
+private:
+	struct FSection
+	{
+		uint64 Offset;
+		uint64 Count;
+	};
+
+	// Sections follow the header in this order: radii, area flags, layers, the leaves of each clearance level, then the
+	// derived data in the order of FSVONDerivedData's arrays
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 ByteOrder;
+		uint16 NodeSize;
+		uint16 LeafSize;
+		uint32 NumLayers;
+		uint32 NumClearanceLevels;
+		uint32 NumComponents;
+		uint32 Reserved;
+		uint64 Size;
+	};
+
+	static const uint32 BlobMagic = 0x42564F53;
+	static const uint32 BlobVersion = 2;
+
+	TArray<uint8, TAlignedHeapAllocator<Alignment>> Bytes;
+
+	// Set instead of Bytes when the buffer is a mapped file. The region is released before the handle
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	const uint8* Base;
+	int64 Size;
+
+	const FHeader* GetHeader() const { return reinterpret_cast<const FHeader*>(Base); }
+	const FSection& GetSection(int32 Index) const;
+
+	/* Index of one of the derived data sections, which come after every leaf section */
+	int32 GetDerivedSection(int32 Derived) const;
+
+	template <typename T>
+	TArrayView<const T> GetSectionView(int32 Index) const
+	{
+		const auto& Section = GetSection(Index);
+		return TArrayView<const T>(reinterpret_cast<const T*>(Base + Section.Offset), static_cast<int32>(Section.Count));
+	}
+
+	template <typename T>
+	TArrayView<T> GetMutableSectionView(int32 Index)
+	{
+		check(Base == Bytes.GetData());
+		const auto& Section = GetSection(Index);
+		return TArrayView<T>(reinterpret_cast<T*>(Bytes.GetData() + Section.Offset), static_cast<int32>(Section.Count));
+	}
+
+	/* Points Base at the buffer and checks the header and every section fit inside it. Resets on failure */
+	bool Validate(const uint8* InBase, int64 InSize);
+};
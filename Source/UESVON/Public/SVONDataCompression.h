@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FSVONDataBlob;
+
+/*
+ * Compact encoding of a baked blob for map packages. Each layer and each clearance level's leaves is its own stream, so they
+ * decompress in parallel straight into a freshly allocated blob.
+ *
+ *	Layers store each field as its own plane. Morton codes are deltas from the previous node, parent and child links are
+ *	deltas from the previous node's, neighbor links are offsets from the node's own index. All of them are varints.
+ *	Leaves are run length encoded, as most leaf words are empty or entirely blocked.
+ *	Connectivity labels and distances are stored as they are.
+ *
+ * Every stream is then compressed with the engine's general purpose codec, biased for speed.
+ */
+class UESVON_API FSVONDataCompression
+{
+public:
+	static void Compress(const FSVONDataBlob& Blob, TArray<uint8>& OutBytes);
+
+	/* False, with the blob empty, if the bytes are truncated or aren't ours */
+	static bool Decompress(const TArray<uint8>& Bytes, FSVONDataBlob& OutBlob);
+
+	/* Field by field, so struct padding never makes equal data compare unequal */
+	static bool AreEqual(const FSVONDataBlob& A, const FSVONDataBlob& B);
+};
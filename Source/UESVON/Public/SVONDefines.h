@@ -28,6 +28,69 @@ enum class EDirection : uint8
 
 #define LEAF_LAYER_INDEX 14;
 
+/* Tags stamped into a volume by modifier volumes. Values are bit indices into a layer 0 node's area flags */
+UENUM(BlueprintType, meta = (Bitflags))
+enum class ESVONAreaFlags : uint8
+{
+	SAF_Restricted	UMETA(DisplayName = "Restricted"),
+	SAF_Expensive	UMETA(DisplayName = "Expensive"),
+	SAF_NoFly		UMETA(DisplayName = "No-Fly")
+};
+
+/* Which tagged areas a query stays out of, and what moving through the others costs. Plain data, so it can go to path finding threads */
+struct UESVON_API FSVONAreaFilter
+{
+	static const int32 NumAreas = 3;
+
+	uint8 ExcludedAreas;
+	float CostMultipliers[NumAreas];
+
+	/* Keeps out of restricted and no-fly areas, and prefers to go around expensive ones */
+	FSVONAreaFilter()
+		: ExcludedAreas(GetFlag(ESVONAreaFlags::SAF_Restricted) | GetFlag(ESVONAreaFlags::SAF_NoFly))
+	{
+		for (auto i = 0; i < NumAreas; i++)
+			CostMultipliers[i] = 1.0f;
+
+		CostMultipliers[static_cast<uint8>(ESVONAreaFlags::SAF_Expensive)] = 3.0f;
+	}
+
+	static uint8 GetFlag(ESVONAreaFlags Area) { return 1 << static_cast<uint8>(Area); }
+
+	FORCEINLINE bool IsExcluded(uint8 AreaFlags) const { return (AreaFlags & ExcludedAreas) != 0; }
+
+	/* Combined multiplier for every combination of flags, so the search pays one lookup per step. Never below 1, costs only go up */
+	void GetCostTable(float OutTable[1 << NumAreas]) const
+	{
+		for (auto Flags = 0; Flags < (1 << NumAreas); Flags++)
+		{
+			OutTable[Flags] = 1.0f;
+			for (auto i = 0; i < NumAreas; i++)
+			{
+				if (Flags & (1 << i))
+					OutTable[Flags] *= FMath::Max(CostMultipliers[i], 1.0f);
+			}
+		}
+	}
+
+	uint32 GetHash() const
+	{
+		auto Hash = GetTypeHash(ExcludedAreas);
+		for (auto i = 0; i < NumAreas; i++)
+			Hash = HashCombine(Hash, GetTypeHash(CostMultipliers[i]));
+		return Hash;
+	}
+};
+
+/* Sizes and counts for one layer of a volume, so hot paths don't need to recompute powers of two */
+struct UESVON_API FSVONLayerGeometry
+{
+	float VoxelSize = 0.0f;
+	float HalfExtent = 0.0f;
+	int32 NodesPerSide = 0;
+	int32 NodeCount = 0;
+};
+
 class UESVON_API FSVONStatics
 {
 public:
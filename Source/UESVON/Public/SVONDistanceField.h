@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONLink.h"
+
+class ASVONVolumeActor;
+class FSVONDataBlob;
+struct FSVONDerivedData;
+struct FSVONLinkIndex;
+
+/* Approximate distance from every free node and leaf voxel to the nearest obstacle, in leaf voxel units. Quantized to a byte
+   per node and a nibble per leaf voxel, so it costs 32 bytes per leaf on top of the 8 byte bitboard. Built once when the
+   volume is generated and baked into its blob, then read from there */
+class UESVON_API FSVONDistanceField
+{
+public:
+	static const uint8 MaxNodeDistance = 255;
+	static const uint8 MaxLeafVoxelDistance = 15;
+
+	/* Multi-source Dijkstra from every free voxel touching an obstacle, over the same neighbor links the path finder uses */
+	static void Build(const ASVONVolumeActor& Volume, const FSVONLinkIndex& Index, FSVONDerivedData& OutData);
+
+	/* Points at the distances baked into the blob, which along with the index has to outlive us. Stays unbuilt if the blob
+	   has none, or they weren't built for this octree */
+	void Load(const FSVONDataBlob& Blob, const FSVONLinkIndex& InIndex);
+
+	void Reset();
+
+	bool IsBuilt() const { return NodeDistances.Num() > 0; }
+
+	/* Saturates at MaxNodeDistance for nodes and MaxLeafVoxelDistance for leaf voxels. Unknown links are as far away as we can store */
+	uint8 GetDistance(const FSVONLink& Link) const;
+
+private:
+	const FSVONLinkIndex* Index = nullptr;
+
+	TArrayView<const uint8> NodeDistances;
+
+	// Two leaf voxels per byte, low nibble first
+	TArrayView<const uint8> LeafVoxelDistances;
+};
@@ -4,9 +4,9 @@
 #include "SVONLink.h"
 #include "SVONTypes.h"
 #include "SVONPathFinder.h"
+#include "SVONVolumeActor.h"
 #include "ThreadSafeBool.h"
 
-class ASVONVolumeActor;
 struct FSVONPathFinderSettings;
 
 class FSVONFindPathTask 
@@ -28,7 +28,13 @@ public:
 			TargetLocation(TargetLocation),
 			Path(Path),
 			CompleteFlag(CompleteFlag),
-			DebugOpenPoints(DebugOpenPoints) { }
+			DebugOpenPoints(DebugOpenPoints),
+			QueuedCycles(FPlatformTime::Cycles())
+	{
+		Volume.BeginAsyncSearch();
+	}
+
+	~FSVONFindPathTask() { Volume.EndAsyncSearch(); }
 
 protected:
 	ASVONVolumeActor& Volume;
@@ -44,6 +50,9 @@ protected:
 	FThreadSafeBool& CompleteFlag;
 	TArray<FVector>& DebugOpenPoints;
 
+	/* When the task was queued, so DoWork can tell how long it waited for a thread */
+	uint32 QueuedCycles;
+
 	void DoWork();
 
 	// This next section of Code needs to be here.  Not important as to why.
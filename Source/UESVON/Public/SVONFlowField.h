@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONDefines.h"
+#include "SVONLink.h"
+#include "SVONLinkIndex.h"
+
+class ASVONVolumeActor;
+
+/* Distance to a single goal for every free node and leaf voxel, with the next hop towards it. Built outward from the goal with
+   Dijkstra, a slice at a time, so agents near the goal can use it before the far side of the volume is done. Neighbor links
+   aren't always symmetric, so the first slices gather every link's neighbors into a reverse adjacency, and the search walks
+   that. Steps honour the area filter the same way the path finder does. Not thread safe */
+class UESVON_API FSVONFlowField
+{
+public:
+	FSVONFlowField(const ASVONVolumeActor& Volume, const FSVONLink& Goal, uint8 ClearanceLevel = 0, const FSVONAreaFilter& AreaFilter = FSVONAreaFilter());
+
+	const FSVONLink& GetGoal() const { return Goal; }
+
+	/* Settles up to MaxExpansions more links, nearest the goal first. Returns true once everything reachable is settled */
+	bool Step(int32 MaxExpansions);
+
+	/* Steps until the link is settled or the budget runs out, zero is unlimited. Returns true if the link is settled */
+	bool BuildUntil(const FSVONLink& Link, int32 MaxExpansions);
+
+	bool IsComplete() const { return bHasReverseLinks && Frontier.Num() == 0; }
+	int32 GetNumLinks() const { return Index.Num(); }
+	bool IsSettled(const FSVONLink& Link) const { return Index.IsKnownLink(Link) && Settled[Index.GetIndex(Link)]; }
+
+	/* Path cost to the goal, MAX_flt until the link is settled */
+	float GetDistance(const FSVONLink& Link) const { return IsSettled(Link) ? Distances[Index.GetIndex(Link)] : MAX_flt; }
+
+	/* The neighbor to move to from a settled link. The goal is its own next hop */
+	bool GetNextHop(const FSVONLink& Link, FSVONLink& OutNextHop) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	/* Stamp from the owning volume, for evicting the least recently used field */
+	uint64 LastUsed;
+
+private:
+	struct FFrontierEntry
+	{
+		float Distance;
+		FSVONLink Link;
+	};
+
+	const ASVONVolumeActor& Volume;
+	FSVONLink Goal;
+	uint8 ClearanceLevel;
+
+	FSVONAreaFilter AreaFilter;
+	float AreaCostScale[1 << FSVONAreaFilter::NumAreas];
+
+	// The volume's, fields are dropped whenever its octree changes
+	const FSVONLinkIndex& Index;
+
+	// Per link index, the links that have it as a neighbor are ReverseSources[ReverseOffsets[i]] up to ReverseOffsets[i + 1]
+	TArray<int32> ReverseOffsets;
+	TArray<int32> ReverseSources;
+	bool bHasReverseLinks;
+
+	// Forward steps gathered so far as target and source index pairs, sorted into the reverse adjacency once every link is in
+	TArray<TPair<int32, int32>> Edges;
+	int32 NextEdgeSource;
+
+	TArray<float> Distances;
+	TArray<FSVONLink> NextHops;
+	TBitArray<> Settled;
+
+	// Min heap on distance. Links can be in here more than once, stale entries are skipped when popped
+	TArray<FFrontierEntry> Frontier;
+
+	float GridUnitSize;
+	TArray<FSVONLink> Neighbors;
+
+	/* Gathers the neighbors of up to MaxLinks more links, building the reverse adjacency after the last. Returns the number gathered */
+	int32 GatherEdges(int32 MaxLinks);
+
+	/* True for links a path can step through, nodes without children and free leaf voxels */
+	bool IsNavigable(const FSVONLink& Link) const;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include "SVONLink.h"
+#include "SVONNavigationPath.h"
+#include "SVONPathFinder.h"
+
+class ASVONVolumeActor;
+
+/*
+ * Keeps its search between queries and picks it up again when the goal moves, for agents chasing a target. It's Lifelong
+ * Planning A* rooted at the start link, with D* Lite's key offset so a goal move doesn't mean re-sorting the open list.
+ * Links only change when the volume is regenerated, which invalidates the path cache and starts the search over, so costs
+ * from the root never go up and a repair only settles the links the new goal needs that the old one didn't.
+ *
+ * Paths are optimal for the settings' costs, the weight estimate doesn't apply. Unit cost searches have no heuristic,
+ * as a step's cost doesn't depend on its length. The search also starts over when the start is no longer on the last path.
+ * Queries fail once the volume is destroyed. Not thread safe, each agent keeps its own.
+ */
+class UESVON_API FSVONIncrementalPathFinder
+{
+public:
+	FSVONIncrementalPathFinder(UWorld* World, const ASVONVolumeActor& Volume, const FSVONPathFinderSettings& InSettings);
+
+	/* Same as FSVONPathFinder::FindPath, reusing the last search when it can */
+	int32 FindPath(const FSVONLink& Start, const FSVONLink& Target, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
+
+	/* Drops the search, the next query starts from scratch */
+	void Reset();
+
+	/* True if this was made for the volume, the data it holds now and the settings, otherwise the caller needs a new one */
+	bool IsFor(const ASVONVolumeActor& InVolume, const FSVONPathFinderSettings& InSettings) const;
+
+private:
+	struct FLinkState
+	{
+		/* Settled cost from the root, and the best cost found so far. The link is open while they differ */
+		float G;
+		float Rhs;
+
+		/* The key the link was last queued with, heap entries that don't match it are stale */
+		float Key1;
+		float Key2;
+		bool bOpen;
+
+		/* Where the best cost came from */
+		FSVONLink Parent;
+
+		FLinkState()
+			: G(FLT_MAX),
+			Rhs(FLT_MAX),
+			Key1(FLT_MAX),
+			Key2(FLT_MAX),
+			bOpen(false) {}
+	};
+
+	struct FOpenEntry
+	{
+		float Key1;
+		float Key2;
+		FSVONLink Link;
+
+		/* Lower key first, ties to the lower cost */
+		bool operator<(const FOpenEntry& Other) const { return Key1 < Other.Key1 || (Key1 == Other.Key1 && Key2 < Other.Key2); }
+	};
+
+	/* Owns the settings, so they outlive the component call that made us */
+	FSVONPathFinderSettings Settings;
+
+	/* Set up for each query, for its context, cost policies and path post processing */
+	FSVONPathFinder PathFinder;
+
+	/* Checked before every query, the volume may have been destroyed and another spawned at the same address since */
+	TWeakObjectPtr<const ASVONVolumeActor> Volume;
+	uint32 DataId;
+	uint32 SettingsHash;
+
+	TMap<FSVONLink, FLinkState> States;
+	TArray<FOpenEntry> OpenHeap;
+	int32 NumOpen;
+
+	FSVONLink Root;
+	FSVONLink Goal;
+	bool bHasSearch;
+
+	/* Path cache generation the search was started in, a newer one means the links may have changed */
+	uint32 Generation;
+
+	/* D* Lite's km, the heuristic distance the goal has moved in total. Keeps older keys lower bounds of new ones */
+	float KeyOffset;
+
+	/* Scales the heuristic so no step costs less than it estimates, whatever layer it's onto */
+	float HeuristicScale;
+
+	/* The last path found, root first */
+	TArray<FSVONLink> PathLinks;
+
+	TArray<FSVONLink> Neighbors;
+
+	/* Only once FindPath has checked Volume is still alive, it's read through the path finder's reference */
+	const ASVONVolumeActor& GetVolume() const { return PathFinder.Volume; }
+
+	/* Roots the search at the start, with nothing settled */
+	void StartSearch(const FSVONLink& InStart, const FSVONLink& InGoal);
+
+	/* Moves the goal, adding how far it went to the key offset */
+	void MoveGoal(const FSVONLink& InGoal);
+
+	/* Settles links in key order until the goal's cost is known, or nothing's left open. Returns the number settled */
+	template <typename TCostPolicy>
+	int32 ComputeShortestPath(const TCostPolicy& CostPolicy);
+
+	/* Cost of the step onto To, FLT_MAX if the area filter forbids it */
+	template <typename TCostPolicy>
+	float GetStepCost(const TCostPolicy& CostPolicy, const FSVONLink& From, const FIntVector& FromPosition, const FSVONLink& To) const;
+
+	float GetHeuristic(const FSVONLink& Link) const;
+
+	void CalculateKey(const FSVONLink& Link, const FLinkState& State, float& OutKey1, float& OutKey2) const;
+
+	/* Queues the link with its current key if it's inconsistent, otherwise takes it off the open list */
+	void UpdateOpen(const FSVONLink& Link, FLinkState& State);
+
+	/* Drops stale entries once they outnumber the live ones */
+	void CompactOpenHeap();
+
+	/* Follows parents back from the goal into PathLinks. False if the goal isn't settled */
+	bool ExtractPath();
+};
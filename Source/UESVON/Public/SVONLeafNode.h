@@ -7,6 +7,9 @@ struct UESVON_API FSVONLeafNode
 public:
 	uint_fast64_t VoxelGrid = 0;
 
+	/* Stands in for every leaf whose node is flagged as completely blocked */
+	static const FSVONLeafNode Blocked;
+
 	inline bool GetNodeAt(uint_fast32_t X, uint_fast32_t Y, uint_fast32_t Z) const
 	{
 		uint_fast64_t index = 0;
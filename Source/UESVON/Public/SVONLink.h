@@ -42,7 +42,7 @@ public:
 
 	static FSVONLink GetInvalidLink() { return FSVONLink(InvalidLayerIndex, 0, 0); }
 
-	FString ToString() { return FString::Printf(TEXT("%i:%i:%i"), LayerIndex, NodeIndex, SubNodeIndex);	}
+	FString ToString() const { return FString::Printf(TEXT("%i:%i:%i"), LayerIndex, NodeIndex, SubNodeIndex);	}
 };
 
 FORCEINLINE uint32 GetTypeHash(const FSVONLink& Value)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONLink.h"
+
+class FSVONDataBlob;
+
+/* Dense numbering of every node and every leaf voxel in a volume, so per-link data can live in flat arrays. Each volume keeps
+   one for its octree, shared by everything that stores data per link */
+struct UESVON_API FSVONLinkIndex
+{
+public:
+	/* Only reads the octree, so it can be built on any thread */
+	void Build(const FSVONDataBlob& Blob);
+
+	void Reset();
+
+	int32 Num() const { return NumElements; }
+
+	/* Nodes come first, so this is also the index of the first leaf voxel */
+	int32 GetNumNodes() const { return VoxelOffset; }
+
+	/* True if the link refers to a node that exists in the volume this was built from */
+	bool IsKnownLink(const FSVONLink& Link) const
+	{
+		return Link.IsValid() && Link.LayerIndex < LayerSizes.Num() && static_cast<int32>(Link.NodeIndex) < LayerSizes[Link.LayerIndex];
+	}
+
+	/* Layer 0 nodes with a leaf are numbered per voxel, everything else per node. The link must be known */
+	int32 GetIndex(const FSVONLink& Link) const
+	{
+		if (Link.LayerIndex == 0 && LeafSlots[Link.NodeIndex] != INDEX_NONE)
+			return VoxelOffset + LeafSlots[Link.NodeIndex] * 64 + Link.SubNodeIndex;
+
+		return LayerOffsets[Link.LayerIndex] + static_cast<int32>(Link.NodeIndex);
+	}
+
+	/* Index of a node itself, ignoring any leaf voxels */
+	int32 GetNodeIndex(uint8 LayerIndex, int32 NodeIndex) const { return LayerOffsets[LayerIndex] + NodeIndex; }
+
+	/* The link an index was given to, the inverse of GetIndex. The index must be below Num */
+	FSVONLink GetLink(int32 Index) const;
+
+	SIZE_T GetAllocatedSize() const { return LayerOffsets.GetAllocatedSize() + LayerSizes.GetAllocatedSize() + LeafSlots.GetAllocatedSize() + LeafNodes.GetAllocatedSize(); }
+
+private:
+	TArray<int32> LayerOffsets;
+	TArray<int32> LayerSizes;
+
+	// Per layer 0 node, its slot among the nodes that have leaves, or INDEX_NONE
+	TArray<int32> LeafSlots;
+
+	// Per slot, the layer 0 node it belongs to
+	TArray<int32> LeafNodes;
+
+	int32 VoxelOffset = 0;
+	int32 NumElements = 0;
+};
@@ -6,6 +6,14 @@ struct FSVONLink;
 class UESVON_API FSVONMediator
 {
 public:
-	static bool GetLinkFromLocation(const FVector& Location, const ASVONVolumeActor& Volume, FSVONLink& oLink);
+	static bool GetLinkFromLocation(const FVector& Location, const ASVONVolumeActor& Volume, FSVONLink& oLink, uint8 ClearanceLevel = 0);
 	static void GetVolumeXYZ(const FVector& Location, const ASVONVolumeActor& Volume, const int Layer, FIntVector& OutLocation);
+
+	/* Best-first search down the octree for the closest free node or leaf voxel to the location, within the radius. OutLocation is
+	   the closest point to the location inside it. A RequiredComponent other than INDEX_NONE limits the search to that connected region */
+	static bool FindNearestNavigableLink(const FVector& Location, const ASVONVolumeActor& Volume, float Radius, FSVONLink& OutLink, FVector& OutLocation, uint8 ClearanceLevel = 0, int32 RequiredComponent = INDEX_NONE);
+
+	/* Marches the segment through the octree, one free node at a time. Returns false if any point on it is blocked, in one of the
+	   excluded areas or outside the volume */
+	static bool IsLineClear(const FVector& Start, const FVector& End, const ASVONVolumeActor& Volume, uint8 ClearanceLevel = 0, uint8 ExcludedAreas = 0);
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONTypes.h"
+#include "SVONLink.h"
+#include "SVONPathFinder.h"
+
+class ASVONVolumeActor;
+
+/* Paths between volumes joined by portals. A coarse A* over the portals picks which volumes to pass through and where, using
+   straight line costs between portals in the same connected region. Each leg is then found with FSVONPathFinder in its own volume,
+   and the legs are stitched together. A leg that fails is struck from the coarse graph and the route is planned again */
+class UESVON_API FSVONMultiVolumePathFinder
+{
+public:
+	FSVONMultiVolumePathFinder(UWorld* World, const FSVONPathFinderSettings& Settings, float AgentRadius)
+		: World(World),
+		Settings(Settings),
+		AgentRadius(AgentRadius) {}
+
+	/* Fills the path from start to target. Game thread only, the volumes may stream out between frames */
+	bool FindPath(ASVONVolumeActor& StartVolume, const FVector& StartLocation, ASVONVolumeActor& TargetVolume, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
+
+	/* Routes planned before giving up, each failed leg costs one */
+	int32 MaxRoutes = 8;
+
+	/* How far to look for somewhere navigable when the start or target is inside blocked space, zero fails instead */
+	float NearestLinkSearchRadius = 0.0f;
+
+private:
+	struct FRouteNode
+	{
+		const ASVONVolumeActor* Volume;
+		FVector Location;
+		FSVONLink Link;
+
+		// The other side of the portal, INDEX_NONE for the start and target
+		int32 Partner;
+	};
+
+	UWorld* World;
+	FSVONPathFinderSettings Settings;
+	float AgentRadius;
+
+	TArray<FRouteNode> Nodes;
+	TMap<const ASVONVolumeActor*, TArray<int32>> VolumeNodes;
+
+	// Same-volume legs the fine search couldn't find, ordered low index first
+	TSet<TPair<int32, int32>> FailedLegs;
+
+	/* Gathers the portals of every volume reachable from the start, and looks up their links */
+	void BuildRouteGraph(ASVONVolumeActor& StartVolume, const FVector& StartLocation, ASVONVolumeActor& TargetVolume, const FVector& TargetLocation);
+
+	/* A* from node 0 to node 1. Returns the route in order, empty if there isn't one */
+	bool FindRoute(TArray<int32>& OutRoute) const;
+
+	/* Fine search for one same-volume leg, appending its points to the path */
+	bool FindLeg(const FRouteNode& From, const FRouteNode& To, TArray<FSVONPathPoint>& OutPoints);
+};
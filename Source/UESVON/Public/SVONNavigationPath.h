@@ -9,6 +9,14 @@ enum class ESVONPathCostType : uint8
 	SPCT_Euclidean  UMETA(DisplayName = "Euclidean")
 };
 
+UENUM(BlueprintType)
+enum class ESVONPathSmoothingType : uint8
+{
+	SPST_None        UMETA(DisplayName = "None"),
+	SPST_Chaikin     UMETA(DisplayName = "Chaikin"),
+	SPST_CatmullRom  UMETA(DisplayName = "Catmull-Rom")
+};
+
 struct FNavigationPath;
 class ASVONVolumeActor;
 
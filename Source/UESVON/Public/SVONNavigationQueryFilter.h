@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavFilters/NavigationQueryFilter.h"
+
+#include "SVONDefines.h"
+
+#include "SVONNavigationQueryFilter.generated.h"
+
+/* Navigation filter for SVON moves. Set it as the controller's default filter, or on the move request, to pick which areas
+   stamped by ASVONModifierVolumes a path avoids. Any other filter class gets the FSVONAreaFilter defaults */
+UCLASS()
+class UESVON_API USVONNavigationQueryFilter
+	: public UNavigationQueryFilter
+{
+	GENERATED_BODY()
+
+public:
+	USVONNavigationQueryFilter(const FObjectInitializer& ObjectInitializer);
+
+	// Areas paths never enter
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "SVON", meta = (Bitmask, BitmaskEnum = "ESVONAreaFlags"))
+	int32 ExcludedAreas;
+
+	// Cost multipliers for moving through areas that aren't excluded. Overlapping areas multiply
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "SVON", meta = (ClampMin = "1"))
+	float RestrictedCost;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "SVON", meta = (ClampMin = "1"))
+	float ExpensiveCost;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "SVON", meta = (ClampMin = "1"))
+	float NoFlyCost;
+
+	void GetAreaFilter(FSVONAreaFilter& OutFilter) const;
+
+	/* The area filter for a move request's filter class, the defaults unless it's one of ours */
+	static void GetAreaFilter(TSubclassOf<UNavigationQueryFilter> FilterClass, FSVONAreaFilter& OutFilter);
+};
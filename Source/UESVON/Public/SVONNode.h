@@ -15,11 +15,15 @@ public:
 
 	FSVONLink Neighbors[6];
 
+	/* Set in FirstChild's sub node bits, which a leaf link never uses, when every voxel of the leaf is blocked. No leaf is stored for it */
+	static const uint8 BlockedLeafFlag = 1;
+
 	FSVONNode() 
         : Parent(FSVONLink::GetInvalidLink()),
         FirstChild(FSVONLink::GetInvalidLink()) { }
 
 	FORCEINLINE bool HasChildren() const { return FirstChild.IsValid(); }
+	FORCEINLINE bool IsLeafCompletelyBlocked() const { return FirstChild.IsValid() && (FirstChild.SubNodeIndex & BlockedLeafFlag) != 0; }
 };
 
 FORCEINLINE FArchive& operator<<(FArchive& Ar, FSVONNode& Node)
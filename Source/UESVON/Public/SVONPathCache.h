@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+#include "SVONLink.h"
+#include "SVONNavigationPath.h"
+
+struct UESVON_API FSVONPathCacheKey
+{
+public:
+	FSVONLink Start;
+	FSVONLink Goal;
+	uint32 SettingsHash;
+
+	FSVONPathCacheKey()
+		: SettingsHash(0) {}
+
+	FSVONPathCacheKey(const FSVONLink& Start, const FSVONLink& Goal, uint32 SettingsHash)
+		: Start(Start),
+		Goal(Goal),
+		SettingsHash(SettingsHash) {}
+
+	bool operator==(const FSVONPathCacheKey& Other) const { return Start == Other.Start && Goal == Other.Goal && SettingsHash == Other.SettingsHash; }
+};
+
+FORCEINLINE uint32 GetTypeHash(const FSVONPathCacheKey& Key)
+{
+	return HashCombine(HashCombine(GetTypeHash(Key.Start), GetTypeHash(Key.Goal)), Key.SettingsHash);
+}
+
+struct UESVON_API FSVONPathCacheStats
+{
+public:
+	int32 Hits = 0;
+	int32 Misses = 0;
+	int32 NumEntries = 0;
+	int32 Capacity = 0;
+	SIZE_T MemoryBytes = 0;
+
+	float GetHitRate() const { return Hits + Misses > 0 ? static_cast<float>(Hits) / static_cast<float>(Hits + Misses) : 0.0f; }
+};
+
+/* Least recently used cache of raw (un-post-processed) path points, keyed by start/goal link and path finder settings. Thread safe */
+class UESVON_API FSVONPathCache
+{
+public:
+	FSVONPathCache()
+		: Capacity(0),
+		Clock(0),
+		Generation(0),
+		Hits(0),
+		Misses(0),
+		PointBytes(0),
+		NumBytes(0) {}
+
+	~FSVONPathCache();
+
+	/* Zero disables the cache. Shrinking evicts the least recently used entries */
+	void SetCapacity(int32 InCapacity);
+
+	bool IsEnabled() const { return Capacity > 0; }
+
+	/* The generation is bumped on every invalidation, searches started before that can't add their result */
+	uint32 GetGeneration() const { return Generation; }
+
+	/* Copies the cached points out and marks the entry as used */
+	bool Find(const FSVONPathCacheKey& Key, TArray<FSVONPathPoint>& OutPoints);
+
+	void Add(const FSVONPathCacheKey& Key, const TArray<FSVONPathPoint>& Points, uint32 SearchGeneration);
+
+	/* Drops every entry */
+	void Invalidate();
+
+	/* Drops the entries whose path passes through the box */
+	void Invalidate(const FBox& Box);
+
+	FSVONPathCacheStats GetStats() const;
+
+	/* Entries and their points, also counted towards the volume memory stat */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FEntry
+	{
+		TArray<FSVONPathPoint> Points;
+		FBox Bounds;
+		uint64 LastUsed;
+	};
+
+	TMap<FSVONPathCacheKey, FEntry> Entries;
+	int32 Capacity;
+	uint64 Clock;
+	uint32 Generation;
+
+	int32 Hits;
+	int32 Misses;
+
+	SIZE_T PointBytes;
+	SIZE_T NumBytes;
+
+	mutable FCriticalSection Lock;
+
+	void EvictToCapacity();
+	void RemoveEntry(const FSVONPathCacheKey& Key);
+
+	/* Recounts NumBytes after entries change and moves the memory stat by the difference */
+	void UpdateAllocatedSize();
+};
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Misc/ScopeExit.h"
 
 #include "SVONTypes.h"
 #include "SVONNavigationPath.h"
 #include "SVONLink.h"
+#include "SVONPathPolicies.h"
+#include "SVONQueryTelemetry.h"
+#include "SVONStats.h"
 
 struct FSVONNavigationPath;
 class ASVONVolumeActor;
+class FSVONFlowField;
 
 struct FSVONPathFinderSettings
 {
@@ -17,7 +22,13 @@ struct FSVONPathFinderSettings
 	float WeightEstimate;
 	float NodeSizeCompensation;
 	int SmoothingIterations;
+	bool bUseStringPulling;
+	ESVONPathSmoothingType SmoothingType;
 	ESVONPathCostType PathCostType;
+	uint8 ClearanceLevel;
+	float ObstacleAvoidanceWeight;
+	float ObstacleAvoidanceDistance;
+	FSVONAreaFilter AreaFilter;
 	TArray<FVector> DebugPoints;
 
 	FSVONPathFinderSettings()
@@ -27,7 +38,61 @@ struct FSVONPathFinderSettings
 		WeightEstimate(1.0f),
 		NodeSizeCompensation(1.0f),
 		SmoothingIterations(0.f),
-		PathCostType(ESVONPathCostType::SPCT_Euclidean) {}
+		bUseStringPulling(false),
+		SmoothingType(ESVONPathSmoothingType::SPST_None),
+		PathCostType(ESVONPathCostType::SPCT_Euclidean),
+		ClearanceLevel(0),
+		ObstacleAvoidanceWeight(0.0f),
+		ObstacleAvoidanceDistance(0.0f) {}
+
+	/* Hash of everything that changes the resulting path, used to key the path cache */
+	uint32 GetResultHash() const
+	{
+		auto Hash = GetTypeHash(static_cast<uint8>(bUseUnitCost) | (static_cast<uint8>(bUseStringPulling) << 1));
+		Hash = HashCombine(Hash, GetTypeHash(UnitCost));
+		Hash = HashCombine(Hash, GetTypeHash(WeightEstimate));
+		Hash = HashCombine(Hash, GetTypeHash(NodeSizeCompensation));
+		Hash = HashCombine(Hash, GetTypeHash(SmoothingIterations));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(SmoothingType)));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(PathCostType)));
+		Hash = HashCombine(Hash, GetTypeHash(ClearanceLevel));
+		Hash = HashCombine(Hash, GetTypeHash(ObstacleAvoidanceWeight));
+		Hash = HashCombine(Hash, GetTypeHash(ObstacleAvoidanceDistance));
+		Hash = HashCombine(Hash, AreaFilter.GetHash());
+		return Hash;
+	}
+};
+
+/* Result of a multi goal search, the index into the goals passed in and the path cost to reach it */
+struct FSVONGoalCost
+{
+	int32 GoalIndex;
+	float Cost;
+
+	FSVONGoalCost()
+		: GoalIndex(INDEX_NONE),
+		Cost(0.0f) {}
+
+	FSVONGoalCost(int32 GoalIndex, float Cost)
+		: GoalIndex(GoalIndex),
+		Cost(Cost) {}
+};
+
+/* The containers a search fills. A worker keeps one between searches, so they're only allocated once per thread */
+struct FSVONSearchScratch
+{
+	TArray<FSVONLink> OpenSet;
+	TSet<FSVONLink> ClosedSet;
+	TMap<FSVONLink, FSVONLink> CameFrom;
+	TMap<FSVONLink, float> GScore;
+	TMap<FSVONLink, float> FScore;
+
+	TArray<FSVONLink> Neighbors;
+	TArray<FSVONLink> Candidates;
+	TArray<FIntVector> CandidatePositions;
+	TArray<float> CandidateHeuristics;
+
+	TArray<FSVONPathPoint> PostProcessScratch;
 };
 
 class UESVON_API FSVONPathFinder
@@ -36,17 +101,44 @@ public:
 	FSVONPathFinder(UWorld* World, const ASVONVolumeActor& Volume, FSVONPathFinderSettings& Settings)
 		: World(World),
 		Volume(Volume),
-		Settings(Settings) { };
+		Settings(Settings),
+		QueueWaitMilliseconds(-1.0f) { };
 
 	~FSVONPathFinder() { };
 
-	/* Performs an A* search from start to target navlink */
+	/* Performs an A* search from start to target navlink, with the built-in policies picked by the settings */
 	int32 FindPath(const FSVONLink& Start, const FSVONLink& Target, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
 
+	/* Performs an A* search with custom cost and heuristic policies, see SVONPathPolicies.h. Results aren't cached, the settings don't describe them */
+	template <typename TCostPolicy, typename THeuristicPolicy>
+	int32 FindPath(const FSVONLink& Start, const FSVONLink& Target, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath, const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy);
+
+	/* Fills the path from the volume's path cache, if it holds this start/target pair. Returns false on a miss */
+	bool FindCachedPath(const FSVONLink& Start, const FSVONLink& Target, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
+
+	/* One Dijkstra expansion from the start, stopping once MaxResults goals are reached (all of them if MaxResults <= 0).
+	   Results are nearest first, goals that can't be reached are left out. Returns the number of results */
+	int32 FindGoalCosts(const FSVONLink& Start, const TArray<FSVONLink>& Goals, int32 MaxResults, TArray<FSVONGoalCost>& OutResults);
+
+	/* Builds the path to a goal reached by the last FindGoalCosts, without searching again */
+	bool BuildPathToGoal(const FSVONLink& Goal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
+
+	/* Builds the path by following a flow field's next hops from the start, no search. Fails if the start isn't settled yet */
+	bool FindPathInFlowField(const FSVONFlowField& FlowField, const FSVONLink& Start, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
+
+	/* Trades containers with the scratch, before searching to reuse its allocations and after to keep ours */
+	void SwapScratch(FSVONSearchScratch& Scratch);
+
+	/* How long the searches to come waited for a thread, kept with them when query telemetry is on */
+	void SetQueueWait(float Milliseconds) { QueueWaitMilliseconds = Milliseconds; }
+
 	//FORCEINLINE const FSVONNavigationPath& GetPath() const { return Path; }
 	//const FNavigationPath& GetNavPath();  
 
 private:
+	/* Runs its own search, but sets up and finishes paths through ours */
+	friend class FSVONIncrementalPathFinder;
+
 	TArray<FSVONLink> OpenSet;
 	TSet<FSVONLink> ClosedSet;
 
@@ -59,20 +151,241 @@ private:
 	FSVONLink Current;
 	FSVONLink Goal;
 
+	/* Path cache generation when this search started, results from before an invalidation aren't cached */
+	uint32 CacheGeneration;
+
+	/* Link centre in half leaf voxel units, see ASVONVolumeActor::GetLinkGridPosition */
+	FIntVector CurrentPosition;
+
+	/* Goal position and per-layer constants, fixed for the duration of a search */
+	FSVONSearchContext Context;
+
+	/* Whether the last search can go in the path cache */
+	bool bCacheResult;
+
+	/* Per-expansion scratch, kept between iterations to avoid reallocating */
+	TArray<FSVONLink> Neighbors;
+	TArray<FSVONLink> Candidates;
+	TArray<FIntVector> CandidatePositions;
+	TArray<float> CandidateHeuristics;
+
+	/* Handed to the path post processor for each path it finishes */
+	TArray<FSVONPathPoint> PostProcessScratch;
+
 	UWorld* World;
 	const ASVONVolumeActor& Volume;
 	FSVONPathFinderSettings& Settings;
 
-	/* A* heuristic calculation */
-	float HeuristicScore(const FSVONLink& Start, const FSVONLink& Target);
+	float QueueWaitMilliseconds;
 
-	/* Distance between two links */
-	float GetCost(const FSVONLink& Start, const FSVONLink& Target);
+	/* A* from start to goal, FindPath without touching bCacheResult */
+	template <typename TCostPolicy, typename THeuristicPolicy>
+	int32 SearchPath(const FSVONLink& InStart, const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath, const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy);
 
-	void ProcessLink(const FSVONLink& Neighbor);
+	/* Dijkstra from the current search's start, settling pending goals in order of cost */
+	template <typename TCostPolicy>
+	void SearchGoalCosts(const TCostPolicy& CostPolicy, TMultiMap<FSVONLink, int32>& PendingGoals, int32 MaxResults, TArray<FSVONGoalCost>& OutResults);
+
+	/* Adds the search that just finished to the query telemetry */
+	void RecordQuery(bool bSucceeded, int32 NumIterations, double StartTime) const;
+
+	/* Clears the scratch state and seeds the open set with the start, at zero score */
+	void ResetSearch(const FSVONLink& InStart, const FSVONLink& InGoal);
+
+	/* Moves the open link with the lowest score to the closed set, and makes it current */
+	void PopLowestScore();
+
+	/* Scores and opens the neighbors of the current link. With FSVONZeroHeuristic this is a Dijkstra step */
+	template <typename TCostPolicy, typename THeuristicPolicy>
+	void ExpandCurrent(const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy);
+
+	/* Caches the goal position and per-layer constants for a new search */
+	void SetupSearch(const FSVONLink& InStart, const FSVONLink& InGoal);
+
+	/* True if the settings ask for obstacle avoidance and the volume has a distance field for it */
+	bool ShouldAvoidObstacles() const { return Context.ObstacleRange > 0.0f; }
+
+	/* Calls Func with the built-in cost policy the settings ask for. The only runtime branch on the settings in a search */
+	template <typename TFunc>
+	auto DispatchCostPolicy(TFunc&& Func) -> decltype(Func(FSVONDistanceCost()));
+
+	/* Evaluates the heuristic for a whole neighbor set in one straight-line loop */
+	template <typename THeuristicPolicy>
+	void HeuristicScores(const THeuristicPolicy& HeuristicPolicy, const TArray<FIntVector>& Positions, TArray<float>& OutScores) const;
+
+	template <typename TCostPolicy>
+	void ProcessLink(const TCostPolicy& CostPolicy, const FSVONLink& Neighbor, const FIntVector& NeighborPosition, float Heuristic);
 
 	/* Constructs the path by navigating back through our CameFrom map */
 	void BuildPath(const TMap<FSVONLink, FSVONLink>& InCameFrom, FSVONLink Current, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
 
-	/*void Smooth_Chaikin(TArray<FVector>& somePoints, int aNumIterations);*/
+	/* Adds the centre of a link, and the layer the path point reports for it */
+	void AddPathPoint(const FSVONLink& Link, TArray<FSVONPathPoint>& Points) const;
+
+	/* Pins the raw points to the exact start and target, post-processes them, and appends them to the path */
+	void FinishPath(TArray<FSVONPathPoint>& Points, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath);
 };
+
+template <typename TCostPolicy, typename THeuristicPolicy>
+int32 FSVONPathFinder::FindPath(const FSVONLink& InStart, const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath, const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy)
+{
+	bCacheResult = false;
+	return SearchPath(InStart, InGoal, StartLocation, TargetLocation, OutPath, CostPolicy, HeuristicPolicy);
+}
+
+template <typename TCostPolicy, typename THeuristicPolicy>
+int32 FSVONPathFinder::SearchPath(const FSVONLink& InStart, const FSVONLink& InGoal, const FVector& StartLocation, const FVector& TargetLocation, FSVONNavPathSharedPtr* OutPath, const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy)
+{
+	SVON_SCOPE_CYCLE_COUNTER(STAT_SVONFindPath);
+	INC_DWORD_STAT(STAT_SVONNumSearches);
+
+	const auto bRecordQuery = FSVONQueryTelemetry::IsEnabled();
+	const auto StartTime = bRecordQuery ? FPlatformTime::Seconds() : 0.0;
+
+	ResetSearch(InStart, InGoal);
+
+	FIntVector StartPosition;
+	Volume.GetLinkGridPosition(InStart, StartPosition);
+	FScore.Add(InStart, HeuristicPolicy.GetHeuristic(Context, StartPosition)); // Distance to target
+
+	int NumIterations = 0;
+#if STATS
+	int32 OpenSetPeak = 0;
+	ON_SCOPE_EXIT
+	{
+		INC_DWORD_STAT_BY(STAT_SVONNodesExpanded, NumIterations);
+		SVONReportOpenSetPeak(OpenSetPeak);
+	};
+#endif
+
+	while (OpenSet.Num() > 0)
+	{
+#if STATS
+		OpenSetPeak = FMath::Max(OpenSetPeak, OpenSet.Num());
+#endif
+		PopLowestScore();
+
+		if (Current == InGoal)
+		{
+			if (bRecordQuery)
+				RecordQuery(true, NumIterations, StartTime);
+
+			BuildPath(CameFrom, Current, StartLocation, TargetLocation, OutPath);
+#if WITH_EDITOR
+			UE_LOG(UESVON, Display, TEXT("Pathfinding complete, iterations : %i"), NumIterations);
+#endif
+			return 1;
+		}
+
+		ExpandCurrent(CostPolicy, HeuristicPolicy);
+
+		NumIterations++;
+	}
+
+	if (bRecordQuery)
+		RecordQuery(false, NumIterations, StartTime);
+
+#if WITH_EDITOR
+	UE_LOG(UESVON, Display, TEXT("Pathfinding failed, iterations : %i"), NumIterations);
+#endif
+
+	return 0;
+}
+
+template <typename TCostPolicy, typename THeuristicPolicy>
+void FSVONPathFinder::ExpandCurrent(const TCostPolicy& CostPolicy, const THeuristicPolicy& HeuristicPolicy)
+{
+	const FSVONNode& CurrentNode = Volume.GetNode(Current);
+	Volume.GetLinkGridPosition(Current, CurrentPosition);
+
+	Neighbors.Reset();
+	if (Current.LayerIndex == 0 && CurrentNode.FirstChild.IsValid())
+		Volume.GetLeafNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+	else
+		Volume.GetNeighbors(Current, Neighbors, Settings.ClearanceLevel);
+
+	// Links inside an excluded area can still be left, so an agent that starts in one isn't stuck there. Paths just never enter one
+	const auto ExcludedAreas = (Volume.GetAreaFlags(Current) & Context.ExcludedAreas) == 0 ? Context.ExcludedAreas : 0;
+
+	// Gather the neighbors we may still visit, then score them all at once
+	Candidates.Reset();
+	CandidatePositions.Reset();
+	for (const FSVONLink& Neighbor : Neighbors)
+	{
+		if (!Neighbor.IsValid() || ClosedSet.Contains(Neighbor))
+			continue;
+
+		if (ExcludedAreas != 0 && (Volume.GetAreaFlags(Neighbor) & ExcludedAreas) != 0)
+			continue;
+
+		FIntVector Position;
+		Volume.GetLinkGridPosition(Neighbor, Position);
+
+		Candidates.Add(Neighbor);
+		CandidatePositions.Add(Position);
+	}
+
+	HeuristicScores(HeuristicPolicy, CandidatePositions, CandidateHeuristics);
+
+	for (auto i = 0; i < Candidates.Num(); i++)
+		ProcessLink(CostPolicy, Candidates[i], CandidatePositions[i], CandidateHeuristics[i]);
+}
+
+template <typename TFunc>
+auto FSVONPathFinder::DispatchCostPolicy(TFunc&& Func) -> decltype(Func(FSVONDistanceCost()))
+{
+	if (Settings.bUseUnitCost)
+	{
+		if (ShouldAvoidObstacles())
+			return Func(TSVONObstacleAvoidingCost<FSVONUnitCost>());
+
+		return Func(FSVONUnitCost());
+	}
+
+	if (ShouldAvoidObstacles())
+		return Func(TSVONObstacleAvoidingCost<FSVONDistanceCost>());
+
+	return Func(FSVONDistanceCost());
+}
+
+template <typename THeuristicPolicy>
+void FSVONPathFinder::HeuristicScores(const THeuristicPolicy& HeuristicPolicy, const TArray<FIntVector>& Positions, TArray<float>& OutScores) const
+{
+	const auto Num = Positions.Num();
+	OutScores.SetNumUninitialized(Num, false);
+
+	const auto* RESTRICT InPositions = Positions.GetData();
+	auto* RESTRICT Scores = OutScores.GetData();
+
+	// The policy inlines, so the loop body is straight-line and the compiler can vectorize it
+	for (auto i = 0; i < Num; i++)
+		Scores[i] = HeuristicPolicy.GetHeuristic(Context, InPositions[i]);
+}
+
+template <typename TCostPolicy>
+void FSVONPathFinder::ProcessLink(const TCostPolicy& CostPolicy, const FSVONLink& Neighbor, const FIntVector& NeighborPosition, float Heuristic)
+{
+	if (!OpenSet.Contains(Neighbor))
+	{
+		OpenSet.Add(Neighbor);
+		if (Settings.bDebugOpenNodes)
+		{
+			FVector Location;
+			Volume.GetLinkLocation(Neighbor, Location);
+			Settings.DebugPoints.Add(Location);
+		}
+	}
+
+	float GScore = FLT_MAX;
+	if (this->GScore.Contains(Current))
+		GScore = this->GScore[Current] + CostPolicy.GetCost(Context, CurrentPosition, NeighborPosition, Neighbor) * Context.AreaCostScale[Volume.GetAreaFlags(Neighbor)];
+	else
+		this->GScore.Add(Current, FLT_MAX);
+
+	if (GScore >= (this->GScore.Contains(Neighbor) ? this->GScore[Neighbor] : FLT_MAX))
+		return;
+
+	CameFrom.Add(Neighbor, Current);
+	this->GScore.Add(Neighbor, GScore);
+	this->FScore.Add(Neighbor, this->GScore[Neighbor] + (Settings.WeightEstimate * Heuristic));
+}
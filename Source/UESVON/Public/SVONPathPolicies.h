@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONLink.h"
+#include "SVONVolumeActor.h"
+
+/* Constants for one search, fixed when it starts and handed to the cost and heuristic policies */
+struct FSVONSearchContext
+{
+	const ASVONVolumeActor* Volume = nullptr;
+
+	/* Link centres are in half leaf voxel units, see ASVONVolumeActor::GetLinkGridPosition */
+	FIntVector GoalPosition = FIntVector::ZeroValue;
+	uint8 GoalLayer = 0;
+
+	/* World size of one grid unit, and the node size compensation for each layer */
+	float GridUnitSize = 1.0f;
+	float LayerCostScale[16];
+
+	float UnitCost = 1.0f;
+
+	/* Obstacle avoidance range in leaf voxels, zero when the distance field isn't used */
+	float ObstacleAvoidanceWeight = 0.0f;
+	float ObstacleRange = 0.0f;
+	float InverseObstacleRange = 0.0f;
+
+	/* From the query's area filter. Excluded links are never opened, the rest have every step onto them scaled by their flags' entry */
+	uint8 ExcludedAreas = 0;
+	float AreaCostScale[1 << FSVONAreaFilter::NumAreas];
+};
+
+/*
+ * Cost policies price a step between neighboring links, heuristic policies estimate the rest of the way to the goal.
+ * They're plain structs the path finder is templated on, so a game's own policies (danger maps, altitude preferences)
+ * inline into the search just like these. Costs must never go below the heuristic's estimate for A* to stay optimal.
+ *
+ *	float GetCost(const FSVONSearchContext& Context, const FIntVector& From, const FIntVector& To, const FSVONLink& Target) const;
+ *	float GetHeuristic(const FSVONSearchContext& Context, const FIntVector& Position) const;
+ */
+
+/* Straight line distance between the link centres */
+struct FSVONDistanceCost
+{
+	FORCEINLINE float GetCost(const FSVONSearchContext& Context, const FIntVector& From, const FIntVector& To, const FSVONLink& Target) const
+	{
+		return FVector(To - From).Size() * Context.GridUnitSize * Context.LayerCostScale[Target.LayerIndex];
+	}
+};
+
+/* The same cost for every step, however big the nodes */
+struct FSVONUnitCost
+{
+	FORCEINLINE float GetCost(const FSVONSearchContext& Context, const FIntVector& From, const FIntVector& To, const FSVONLink& Target) const
+	{
+		return Context.UnitCost * Context.LayerCostScale[Target.LayerIndex];
+	}
+};
+
+/* Scales another cost up near obstacles, using the volume's distance field. Only ever adds cost, so the heuristic stays admissible */
+template <typename TBaseCost>
+struct TSVONObstacleAvoidingCost
+{
+	TBaseCost BaseCost;
+
+	FORCEINLINE float GetCost(const FSVONSearchContext& Context, const FIntVector& From, const FIntVector& To, const FSVONLink& Target) const
+	{
+		auto Cost = BaseCost.GetCost(Context, From, To, Target);
+
+		const auto Distance = static_cast<float>(Context.Volume->GetDistanceField().GetDistance(Target));
+		if (Distance < Context.ObstacleRange)
+			Cost *= 1.0f + Context.ObstacleAvoidanceWeight * (1.0f - Distance * Context.InverseObstacleRange);
+
+		return Cost;
+	}
+};
+
+struct FSVONEuclideanHeuristic
+{
+	FORCEINLINE float GetHeuristic(const FSVONSearchContext& Context, const FIntVector& Position) const
+	{
+		const auto DX = static_cast<float>(Position.X - Context.GoalPosition.X);
+		const auto DY = static_cast<float>(Position.Y - Context.GoalPosition.Y);
+		const auto DZ = static_cast<float>(Position.Z - Context.GoalPosition.Z);
+
+		// Compensation is always for the goal's layer
+		return FMath::Sqrt(DX * DX + DY * DY + DZ * DZ) * Context.GridUnitSize * Context.LayerCostScale[Context.GoalLayer];
+	}
+};
+
+struct FSVONManhattanHeuristic
+{
+	FORCEINLINE float GetHeuristic(const FSVONSearchContext& Context, const FIntVector& Position) const
+	{
+		const auto Delta = Position - Context.GoalPosition;
+		return static_cast<float>(FMath::Abs(Delta.X) + FMath::Abs(Delta.Y) + FMath::Abs(Delta.Z)) * Context.GridUnitSize * Context.LayerCostScale[Context.GoalLayer];
+	}
+};
+
+/* No estimate at all, which makes the search Dijkstra */
+struct FSVONZeroHeuristic
+{
+	FORCEINLINE float GetHeuristic(const FSVONSearchContext& Context, const FIntVector& Position) const
+	{
+		return 0.0f;
+	}
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SVONNavigationPath.h"
+
+class ASVONVolumeActor;
+struct FSVONPathFinderSettings;
+
+/* Reduces and smooths raw A* output. Visibility is tested against the voxel data, no physics traces */
+class UESVON_API FSVONPathPostProcessor
+{
+public:
+	/* Chaikin doubles the points every pass, so more than this is never worth the memory */
+	static const int32 MaxSmoothingIterations = 4;
+
+	/* The scratch is the caller's, so one kept between paths is only allocated once */
+	FSVONPathPostProcessor(const ASVONVolumeActor& Volume, const FSVONPathFinderSettings& Settings, TArray<FSVONPathPoint>& Scratch)
+		: Volume(Volume),
+		Settings(Settings),
+		Scratch(Scratch) { };
+
+	/* Runs string pulling, then the configured smoothing pass, over the points in place */
+	void Process(TArray<FSVONPathPoint>& InOutPoints);
+
+private:
+	const ASVONVolumeActor& Volume;
+	const FSVONPathFinderSettings& Settings;
+
+	/* Ping-pong buffer, sized up front for the largest output of each pass */
+	TArray<FSVONPathPoint>& Scratch;
+
+	/* Removes every waypoint that can be skipped with a clear line from the last kept one */
+	void StringPull(TArray<FSVONPathPoint>& InOutPoints);
+
+	/* Corner cutting, each corner is only cut if the new edge is clear */
+	void SmoothChaikin(TArray<FSVONPathPoint>& InOutPoints, int32 NumIterations);
+
+	/* Uniform Catmull-Rom through the waypoints, spans that would clip geometry stay straight */
+	void SmoothCatmullRom(TArray<FSVONPathPoint>& InOutPoints, int32 NumSubdivisions);
+};
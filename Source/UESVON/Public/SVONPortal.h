@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class ASVONVolumeActor;
+
+/* A place where paths can pass into an adjacent or overlapping volume. Both volumes hold one side of it, under the same Id.
+   Links are looked up from the locations when they're used, so they're valid for any clearance level and survive a rebuild */
+struct UESVON_API FSVONPortal
+{
+	uint32 Id;
+
+	TWeakObjectPtr<ASVONVolumeActor> Neighbor;
+
+	// Free space inside the owning volume, and the matching point inside the neighbor
+	FVector Location;
+	FVector NeighborLocation;
+
+	FSVONPortal()
+		: Id(0),
+		Location(FVector::ZeroVector),
+		NeighborLocation(FVector::ZeroVector) {}
+
+	FSVONPortal(uint32 Id, ASVONVolumeActor* Neighbor, const FVector& Location, const FVector& NeighborLocation)
+		: Id(Id),
+		Neighbor(Neighbor),
+		Location(Location),
+		NeighborLocation(NeighborLocation) {}
+};
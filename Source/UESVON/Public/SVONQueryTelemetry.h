@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+#include "SVONLink.h"
+
+/* One path search, as kept by FSVONQueryTelemetry */
+struct UESVON_API FSVONQueryRecord
+{
+	FSVONLink Start;
+	FSVONLink Goal;
+
+	/* Passes of the search loop, one per link taken off the open set */
+	int32 NumIterations;
+
+	/* Links that were given a score, open or closed, by the end of the search */
+	int32 NumNodesReached;
+
+	float SearchMilliseconds;
+
+	/* How long the query sat in the async queue, negative if it ran on the calling thread */
+	float QueueWaitMilliseconds;
+
+	bool bSucceeded;
+
+	/* Along the link centres, before post processing */
+	float PathLength;
+
+	/* FPlatformTime::Seconds when the search finished */
+	double Timestamp;
+
+	uint32 ThreadId;
+
+	FSVONQueryRecord()
+		: NumIterations(0),
+		NumNodesReached(0),
+		SearchMilliseconds(0.0f),
+		QueueWaitMilliseconds(-1.0f),
+		bSucceeded(false),
+		PathLength(0.0f),
+		Timestamp(0.0),
+		ThreadId(0) { }
+};
+
+/*
+ * The last few thousand path searches, for finding the rare slow one. Off unless svon.Telemetry is set, and dumped with
+ * svon.DumpQueries. Searches on any thread record without locking: each claims the next slot in the ring and stamps it
+ * with a sequence number, odd while it's being written, so a reader can skip a slot that changed under it.
+ */
+class UESVON_API FSVONQueryTelemetry
+{
+public:
+	static const int32 Capacity = 4096;
+
+	/* The ring is allocated on first use, so searches only call this once IsEnabled says so */
+	static FSVONQueryTelemetry& Get();
+
+	/* Null until something has been recorded, for readers that mustn't allocate the ring just by looking */
+	static const FSVONQueryTelemetry* Find();
+
+	static bool IsEnabled();
+
+	/* Overwrites the oldest record once the ring is full. Dropped if another thread is still writing that slot */
+	void Record(const FSVONQueryRecord& Record);
+
+	/* Copies out every record that isn't mid-write, oldest first */
+	void GetRecords(TArray<FSVONQueryRecord>& OutRecords) const;
+
+	/* Records written since startup, including ones that have since been overwritten */
+	int64 GetNumRecorded() const { return NextSlot.GetValue(); }
+
+	int32 GetNumDropped() const { return NumDropped.GetValue(); }
+
+	/* Percentiles of every record to one file, the NumWorst slowest searches to another. Returns false if either can't be written */
+	bool WriteCSV(const FString& BasePath, int32 NumWorst, FOutputDevice& Ar) const;
+
+private:
+	struct FSlot
+	{
+		volatile int32 Sequence;
+		FSVONQueryRecord Record;
+	};
+
+	TArray<FSlot> Slots;
+	FThreadSafeCounter64 NextSlot;
+	FThreadSafeCounter NumDropped;
+
+	FSVONQueryTelemetry();
+};
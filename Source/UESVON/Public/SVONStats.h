@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+/*
+ * Everything under "stat SVON". With STATS off the counters compile to nothing, and the trace scopes are only there on
+ * engines with Unreal Insights, where they're also compiled out unless the CPU profiler trace is.
+ */
+DECLARE_STATS_GROUP(TEXT("SVON"), STATGROUP_SVON, STATCAT_Advanced);
+
+// Generation
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate"), STAT_SVONGenerate, STATGROUP_SVON, UESVON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate : First Pass"), STAT_SVONFirstPass, STATGROUP_SVON, UESVON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate : Rasterize Leaves"), STAT_SVONRasterizeLeaves, STATGROUP_SVON, UESVON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate : Rasterize Layer"), STAT_SVONRasterizeLayer, STATGROUP_SVON, UESVON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate : Neighbor Links"), STAT_SVONNeighborLinks, STATGROUP_SVON, UESVON_API);
+
+// Queries
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path"), STAT_SVONFindPath, STATGROUP_SVON, UESVON_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mediator Lookup"), STAT_SVONMediatorLookup, STATGROUP_SVON, UESVON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Paths Searched"), STAT_SVONNumSearches, STATGROUP_SVON, UESVON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Paths Repaired"), STAT_SVONNumRepairs, STATGROUP_SVON, UESVON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_SVONNodesExpanded, STATGROUP_SVON, UESVON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Open Set Peak"), STAT_SVONOpenSetPeak, STATGROUP_SVON, UESVON_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Async Queue Wait (ms)"), STAT_SVONAsyncQueueWait, STATGROUP_SVON, UESVON_API);
+
+// Path cache, lookups on volumes with the cache enabled
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Hits"), STAT_SVONPathCacheHits, STATGROUP_SVON, UESVON_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Misses"), STAT_SVONPathCacheMisses, STATGROUP_SVON, UESVON_API);
+
+// Memory
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Volumes With Data"), STAT_SVONNumVolumeBlobs, STATGROUP_SVON, UESVON_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Volume Data"), STAT_SVONVolumeMemory, STATGROUP_SVON, UESVON_API);
+
+/* Raises the open set peak to this search's if it's the largest of the frame. Searches finish on several threads at once,
+   so the frame's peak is kept with a compare and swap rather than the last search to finish overwriting it */
+UESVON_API void SVONReportOpenSetPeak(int32 OpenSetPeak);
+
+#define SVON_TRACE_ENABLED (ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 26)
+
+#if SVON_TRACE_ENABLED
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+
+#if SVON_TRACE_ENABLED && CPUPROFILERTRACE_ENABLED
+/* Lets Insights record just the navigation scopes, with -trace=svon */
+UE_TRACE_CHANNEL_EXTERN(SVONChannel, UESVON_API);
+
+#define SVON_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, SVONChannel)
+#else
+#define SVON_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Where a tiled volume's baked tiles live on disk. Each tile is an FSVONDataBlob file, so it's mapped or read without going
+   through the package the tiles were baked from and is safe to load off the game thread */
+class UESVON_API FSVONTileFile
+{
+public:
+	/* Coordinates of every tile written by the last bake, in the directory's index */
+	static bool SaveIndex(const FString& Directory, const TArray<FIntVector>& Tiles);
+	static bool LoadIndex(const FString& Directory, TArray<FIntVector>& OutTiles);
+
+	static FString GetTilePath(const FString& Directory, const FIntVector& Tile);
+
+private:
+	static const uint32 IndexMagic = 0x49564F53;
+};
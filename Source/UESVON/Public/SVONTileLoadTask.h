@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Async/AsyncWork.h"
+#include "SVONDataBlob.h"
+#include "SVONLinkIndex.h"
+#include "ThreadSafeBool.h"
+
+/* Result of reading one tile, shared between the task and the tiled volume so either can let go of it first. Tiles are
+   baked with their connectivity and distance field, so all that's left to build is the link index, which is done here too */
+struct FSVONTileLoad
+{
+	FString Path;
+	FSVONDataBlob Blob;
+	FSVONLinkIndex LinkIndex;
+	bool bSucceeded = false;
+
+	FThreadSafeBool bIsComplete;
+};
+
+typedef TSharedPtr<FSVONTileLoad, ESPMode::ThreadSafe> FSVONTileLoadPtr;
+
+class FSVONTileLoadTask 
+    : public FNonAbandonableTask
+{
+	friend class FAutoDeleteAsyncTask<FSVONTileLoadTask>;
+
+public:
+	FSVONTileLoadTask(FSVONTileLoadPtr Load)
+		: Load(Load) { }
+
+protected:
+	FSVONTileLoadPtr Load;
+
+	void DoWork();
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FSVONTileLoadTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/* Version of the baked navigation data, bump it whenever FSVONData's serialized layout changes */
+struct UESVON_API FSVONCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made
+		BeforeCustomVersionWasAdded = 0,
+
+		// Leaf bitboards for additional clearance levels
+		ClearanceLevels,
+
+		// Area flags per layer 0 node, stamped by modifier volumes
+		AreaFlags,
+
+		// Baked volumes store FSVONDataBlob instead of FSVONData
+		FlatData,
+
+		// Baked volumes can store the blob compressed
+		CompressedData,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+
+private:
+	FSVONCustomVersion() {}
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class ASVONVolumeActor;
+class UWorld;
+
+/* The volumes currently loaded in a world. Volumes add themselves once they're ready to navigate and remove themselves when their
+   level streams out, building or dropping the portals to their neighbors as they go. Game thread only */
+class UESVON_API FSVONVolumeRegistry
+{
+public:
+	static FSVONVolumeRegistry& Get(const UWorld* World);
+
+	/* Connects the volume to every registered volume it touches or overlaps */
+	void Register(ASVONVolumeActor& Volume);
+
+	/* Removes the volume, and every portal leading into it */
+	void Unregister(ASVONVolumeActor& Volume);
+
+	/* A registered volume containing the location, nullptr if none do */
+	ASVONVolumeActor* FindVolume(const FVector& Location) const;
+
+	int32 Num() const { return Volumes.Num(); }
+
+private:
+	TArray<TWeakObjectPtr<ASVONVolumeActor>> Volumes;
+
+	/* Samples the shared boundary or overlap of the volumes, and adds a portal to both for each pair of connected regions
+	   the samples join, one per cell of the shared region */
+	static void BuildPortals(ASVONVolumeActor& A, ASVONVolumeActor& B);
+
+	// Portal ids are unique across every world, so both sides of a portal can find each other
+	static uint32 NextPortalId;
+
+	static TMap<const UWorld*, FSVONVolumeRegistry> Registries;
+};
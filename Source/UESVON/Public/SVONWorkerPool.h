@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSingleton.h"
+
+#include "SVONPathFinder.h"
+
+class FQueuedThreadPool;
+
+/* One per thread that runs searches, so searches after the first on a thread don't allocate their containers again */
+struct FSVONWorkerContext
+	: public TThreadSingleton<FSVONWorkerContext>
+{
+	FSVONSearchScratch Scratch;
+};
+
+/*
+ * Threads that only run SVON path searches, so they don't queue behind streaming and other engine work on GThreadPool.
+ * Sized from svon.Workers.NumThreads and svon.Workers.Priority when first used, set them in DefaultEngine.ini under
+ * [ConsoleVariables] to have them apply. With zero threads, or on a platform without threads, searches go to GThreadPool.
+ */
+class UESVON_API FSVONWorkerPool
+{
+public:
+	/* Game thread only */
+	static FQueuedThreadPool* Get();
+
+	/* Finishes any queued searches and stops the threads. Called by the module on shutdown */
+	static void Shutdown();
+
+private:
+	static FQueuedThreadPool* Pool;
+};